@@ -2,9 +2,10 @@
 #include <string>
 #include <memory>
 #include "connect_flags.h"
+#include "error.h"
+#include "config.h"
 
 namespace neo4j {
-    class config;
     class connection;
     class client {
     public:
@@ -16,6 +17,16 @@ namespace neo4j {
         static std::shared_ptr<connection> connect(const std::string& uri, connect_flags flags = connect_flags::none);
         static std::shared_ptr<connection> connect(const std::string& uri, const config& conf, connect_flags flags = connect_flags::none);
         static std::shared_ptr<connection> connect(const std::string& hostname, uint16_t port, const config& conf, bool insecure = false);
+        // Share one frozen config between many connections instead of copying it for each
+        static std::shared_ptr<connection> connect(const std::string& uri, shared_config conf, connect_flags flags = connect_flags::none);
+        static std::shared_ptr<connection> connect(const std::string& hostname, uint16_t port, shared_config conf, bool insecure = false);
+
+        // Like connect, but connection failures are returned instead of thrown.
+        static expected<std::shared_ptr<connection>> connect_nothrow(const std::string& uri, connect_flags flags = connect_flags::none);
+        static expected<std::shared_ptr<connection>> connect_nothrow(const std::string& uri, const config& conf, connect_flags flags = connect_flags::none);
+        static expected<std::shared_ptr<connection>> connect_nothrow(const std::string& hostname, uint16_t port, const config& conf, bool insecure = false);
+        static expected<std::shared_ptr<connection>> connect_nothrow(const std::string& uri, shared_config conf, connect_flags flags = connect_flags::none);
+        static expected<std::shared_ptr<connection>> connect_nothrow(const std::string& hostname, uint16_t port, shared_config conf, bool insecure = false);
     };
 }
 #ifndef NEO4JPP_IMPL_FILE
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include "value.h"
+#include "value_ref.h"
+#include "string_ref.h"
+
+namespace neo4j {
+    // Cypher equivalence, as used by DISTINCT and grouping: values compare
+    // structurally, 1 equals 1.0, nodes and relationships by identity, map
+    // entries regardless of their order. Unlike = in Cypher, null equals null.
+    bool equals(const value_ref& a, const value_ref& b) noexcept;
+    // Cypher ORDER BY order: maps, nodes, relationships, lists, paths, bytes,
+    // strings, booleans, numbers (NaN last), null. Returns <0, 0 or >0.
+    int compare(const value_ref& a, const value_ref& b) noexcept;
+    // Consistent with equals
+    size_t hash_value(const value_ref& v) noexcept;
+
+    // Hash of raw string data, e.g. for containers keyed by string_ref
+    struct string_ref_hash {
+        size_t operator()(string_ref str) const noexcept;
+    };
+
+    inline bool equals(const value& a, const value& b) noexcept { return equals(a.ref(), b.ref()); }
+    inline int compare(const value& a, const value& b) noexcept { return compare(a.ref(), b.ref()); }
+    inline size_t hash_value(const value& v) noexcept { return hash_value(v.ref()); }
+
+    inline bool operator==(const value_ref& a, const value_ref& b) noexcept { return equals(a, b); }
+    inline bool operator!=(const value_ref& a, const value_ref& b) noexcept { return !equals(a, b); }
+    inline bool operator<(const value_ref& a, const value_ref& b) noexcept { return compare(a, b) < 0; }
+    inline bool operator==(const value& a, const value& b) noexcept { return equals(a, b); }
+    inline bool operator!=(const value& a, const value& b) noexcept { return !equals(a, b); }
+    inline bool operator<(const value& a, const value& b) noexcept { return compare(a, b) < 0; }
+}
+
+namespace std {
+    template<>
+    struct hash<neo4j::value> {
+        size_t operator()(const neo4j::value& v) const noexcept { return neo4j::hash_value(v); }
+    };
+    template<>
+    struct hash<neo4j::value_ref> {
+        size_t operator()(const neo4j::value_ref& v) const noexcept { return neo4j::hash_value(v); }
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/compare.h"
+#endif
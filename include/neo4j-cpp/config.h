@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <memory>
+#include "memory.h"
 
 struct neo4j_config;
 struct neo4j_memory_allocator;
@@ -10,11 +12,17 @@ struct neo4j_connection_factory;
 struct neo4j_logger_provider;
 
 namespace neo4j {
+    class config;
+    // Immutable config referenced by connections instead of copied, see config::freeze()
+    using shared_config = std::shared_ptr<const config>;
+
     class config {
         struct neo4j_config* cfg;
         bool custom_client_id;
         std::function<std::string()> password_cb;
         std::function<int(const char*, const char*, int)> unverified_cb;
+        bool memory_accounting = false;
+        memory_limits mem_limits;
 
         void copy_from(const config& other);
 
@@ -25,10 +33,16 @@ namespace neo4j {
         config& operator=(const config& other);
         ~config();
 
+        // Immutable copy that connections, pools and executors share. Reading
+        // it from several threads is safe as long as the callbacks are.
+        shared_config freeze() const;
+
         std::string get_client_id() const;
         std::string get_known_hosts_file() const;
         unsigned int get_max_pipelined_requests() const;
         struct neo4j_memory_allocator* get_memory_allocator() const;
+        bool get_memory_accounting() const;
+        const memory_limits& get_memory_limits() const;
         const struct neo4j_plan_table_colors* get_plan_table_colorization() const;
         size_t get_rcvbuf_size() const;
         bool get_render_ascii() const;
@@ -49,11 +63,20 @@ namespace neo4j {
         std::string get_username() const;
 
         void set_client_id(const std::string& id);
+        // Factories should wrap interruptible_tcp_factory() if statement
+        // deadlines are to abort a blocked read.
         void set_connection_factory(struct neo4j_connection_factory* factory);
+        // Connect through interruptible_tcp_factory(), so an expired statement
+        // deadline aborts a read blocked on a stalled server instead of waiting
+        // for it. The aborted connection has to be replaced. Off by default.
+        void set_interruptible_io(bool enable);
         void set_known_hosts_file(const std::string& file);
         void set_log_provider(struct neo4j_logger_provider* provider);
         void set_max_pipelined_requests(unsigned int n);
         void set_memory_allocator(struct neo4j_memory_allocator* allocator);
+        // Track memory per connection and stream, limits imply accounting
+        void set_memory_accounting(bool enable);
+        void set_memory_limits(const memory_limits& limits);
         void set_password(const std::string& password);
         void set_plan_table_colors(const struct neo4j_plan_table_colors* colors);
         void set_rcvbuf_size(size_t size);
@@ -1,21 +1,81 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <system_error>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <vector>
 #include "connect_flags.h"
+#include "error.h"
+#include "memory.h"
+#include "config.h"
 
 struct neo4j_connection;
+struct neo4j_config;
 
 namespace neo4j {
-    class config;
     class result_stream;
+    struct statement_plan;
+    class slow_query_log;
+    class value;
+    class parameters;
+    struct static_query;
+    class transport_interrupt;
     class connection : public std::enable_shared_from_this<connection> {
         struct neo4j_connection* con;
-        std::unique_ptr<config> cfg;
+        shared_config cfg;
+        // As given by the caller, cfg may be a per connection copy of it
+        shared_config origin;
+        // How the connection was made, empty uri for host and port
+        std::string uri;
+        connect_flags flags = connect_flags::none;
+        bool insecure = false;
+        // Set if the config enables memory accounting, outlives con
+        std::unique_ptr<memory_account> account;
+        std::shared_ptr<slow_query_log> slow_log;
+        // Serializes sending statements and resets
+        std::mutex ctl;
+        // Socket handle if the transport is interruptible_tcp_factory()
+        std::shared_ptr<transport_interrupt> transport;
+        // Set by an expired deadline, the reset follows on the owning thread
+        std::atomic<bool> interrupted{false};
+        // Set once an interrupt aborted socket io, see is_aborted()
+        std::atomic<bool> aborted{false};
+        // Statements sent so far, numbers the streams. Guarded by ctl.
+        uint64_t sent = 0;
+        // Streams whose deadline timer may still fire, in the order they were
+        // sent. Guarded by ctl.
+        std::vector<result_stream*> deadlines;
         friend class result_stream;
+
+        struct neo4j_config* native_config() const;
+        // Reset from the owning thread, failing the current statement
+        void interrupt() noexcept;
+        // Safe from any thread: aborts blocked socket io and flags the reset
+        void interrupt_async() noexcept;
+        // Perform a reset flagged by interrupt_async(), owning thread only
+        void settle() noexcept;
+        void settle_locked() noexcept;
+        bool needs_settle() const noexcept;
+        void clear_interrupt_locked() noexcept;
+        void setup_memory_accounting();
+
+        static uint_fast32_t native_flags(connect_flags flags) noexcept;
     public:
         connection(const std::string& uri, connect_flags flags = connect_flags::none);
         connection(const std::string& uri, const config& conf, connect_flags flags = connect_flags::none);
         connection(const std::string& hostname, uint16_t port, const config& conf, bool insecure = false);
+        // References conf instead of copying it, nullptr uses the defaults
+        connection(const std::string& uri, shared_config conf, connect_flags flags = connect_flags::none);
+        connection(const std::string& hostname, uint16_t port, shared_config conf, bool insecure = false);
+        // Non throwing variants, ec is set if the connection could not be
+        // established and the object must not be used.
+        connection(const std::string& uri, connect_flags flags, std::error_code& ec);
+        connection(const std::string& uri, const config& conf, connect_flags flags, std::error_code& ec);
+        connection(const std::string& hostname, uint16_t port, const config& conf, bool insecure, std::error_code& ec);
+        connection(const std::string& uri, shared_config conf, connect_flags flags, std::error_code& ec);
+        connection(const std::string& hostname, uint16_t port, shared_config conf, bool insecure, std::error_code& ec);
         ~connection();
 
         connection(const connection&) = delete;
@@ -27,11 +87,60 @@ namespace neo4j {
         bool is_secure() const;
         bool is_credentials_expired() const;
         std::string get_server_id() const;
+        // The config the connection was made with, nullptr for the defaults
+        const shared_config& get_config() const noexcept { return origin; }
+        // New connection to the same server, made the same way: uri including
+        // its credentials, flags and config.
+        std::shared_ptr<connection> reconnect() const;
+
+        // True once a statement deadline aborted a blocked socket read or
+        // write. libneo4j may have failed the session mid message, so the
+        // connection should be replaced; pools do that on their own.
+        bool is_aborted() const noexcept { return aborted; }
+
+        // Zero if memory accounting is not enabled in the config
+        memory_usage get_memory_usage() const noexcept;
+        bool has_memory_accounting() const noexcept { return account != nullptr; }
 
         void reset();
+        void reset(std::error_code& ec) noexcept;
+
+        // Streams started after this call report to the given log, pass nullptr to disable.
+        void set_slow_query_log(std::shared_ptr<slow_query_log> log) { slow_log = std::move(log); }
+        const std::shared_ptr<slow_query_log>& get_slow_query_log() const noexcept { return slow_log; }
 
         std::shared_ptr<result_stream> send(const std::string& query);
         std::shared_ptr<result_stream> run(const std::string& query);
+        // Statements exceeding the timeout are cancelled by the shared watchdog;
+        // fetching then fails with timeout_error. A blocked socket read is only
+        // aborted with config::set_interruptible_io.
+        std::shared_ptr<result_stream> send(const std::string& query, std::chrono::milliseconds timeout);
+        std::shared_ptr<result_stream> run(const std::string& query, std::chrono::milliseconds timeout);
+        // Params is a map whose entries are bound to $name in the query
+        std::shared_ptr<result_stream> send(const std::string& query, const value& params);
+        std::shared_ptr<result_stream> run(const std::string& query, const value& params);
+        std::shared_ptr<result_stream> send(const std::string& query, const value& params, std::chrono::milliseconds timeout);
+        std::shared_ptr<result_stream> run(const std::string& query, const value& params, std::chrono::milliseconds timeout);
+        // Data referenced by params must outlive the returned stream
+        std::shared_ptr<result_stream> send(const std::string& query, const parameters& params);
+        std::shared_ptr<result_stream> run(const std::string& query, const parameters& params);
+        std::shared_ptr<result_stream> send(const std::string& query, const parameters& params, std::chrono::milliseconds timeout);
+        std::shared_ptr<result_stream> run(const std::string& query, const parameters& params, std::chrono::milliseconds timeout);
+        // The text is used as is, without copying it into the stream
+        std::shared_ptr<result_stream> send(static_query query, const value& params,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+        std::shared_ptr<result_stream> run(static_query query, const value& params,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+        expected<std::shared_ptr<result_stream>> send_nothrow(const std::string& query);
+        expected<std::shared_ptr<result_stream>> run_nothrow(const std::string& query);
+        expected<std::shared_ptr<result_stream>> send_nothrow(const std::string& query, const value& params);
+        expected<std::shared_ptr<result_stream>> run_nothrow(const std::string& query, const value& params);
+
+        // Run the query prefixed with PROFILE, discard its records and return the
+        // executed plan. Use costliest_operators() to find the hot spots.
+        struct statement_plan profile(const std::string& query);
+        // Plan the query with EXPLAIN without executing it.
+        struct statement_plan explain(const std::string& query);
     };
 }
 #ifndef NEO4JPP_IMPL_FILE
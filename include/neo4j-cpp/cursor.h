@@ -0,0 +1,51 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <system_error>
+#include "result.h"
+#include "value.h"
+#include "value_ref.h"
+
+namespace neo4j {
+    class result_stream;
+
+    // Streams a result with at most window records buffered. The current row
+    // is only handed out as value_ref and is recycled by the next call to
+    // next(), so memory stays flat no matter how many rows are read. Use the
+    // copy_* functions for values that must outlive the row.
+    class result_cursor {
+        std::shared_ptr<result_stream> stream;
+        neo4j::result current;
+        unsigned int window;
+        unsigned int ahead = 0;
+        unsigned int fields;
+        unsigned long long rows = 0;
+        bool exhausted = false;
+
+        void read_ahead() noexcept;
+    public:
+        explicit result_cursor(std::shared_ptr<result_stream> stream, unsigned int window = 64);
+
+        result_cursor(const result_cursor&) = delete;
+        result_cursor& operator=(const result_cursor&) = delete;
+
+        // Advance to the next row, false once the stream is done
+        bool next();
+        bool next(std::error_code& ec) noexcept;
+
+        bool valid() const noexcept { return current.valid(); }
+        unsigned int nfields() const noexcept { return fields; }
+        unsigned int get_window() const noexcept { return window; }
+        // Number of rows returned by next() so far
+        unsigned long long position() const noexcept { return rows; }
+        const std::shared_ptr<result_stream>& get_stream() const noexcept { return stream; }
+
+        // Valid until the next call to next()
+        value_ref field(unsigned int idx) const;
+        value copy_field(unsigned int idx) const;
+        std::vector<value> copy_row() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/cursor.h"
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <system_error>
+#include "exception.h"
+
+namespace neo4j {
+    struct failure_details {
+        std::string code;
+        std::string message;
+        std::string description;
+        unsigned int line;
+        unsigned int column;
+        unsigned int offset;
+        std::string context;
+        unsigned int context_offset;
+    };
+
+    // Category of libneo4j-client error numbers (errno values and NEO4J_* codes).
+    const std::error_category& client_category() noexcept;
+    inline std::error_code make_client_error(int err) noexcept { return std::error_code(err, client_category()); }
+
+    // Error returned by the non throwing api. Statement failures additionally
+    // carry the failure details reported by the server.
+    class error {
+        std::error_code ec;
+        std::shared_ptr<const struct failure_details> details;
+    public:
+        error() noexcept = default;
+        error(std::error_code c) noexcept : ec(c) {}
+        error(std::error_code c, struct failure_details d)
+            : ec(c), details(std::make_shared<const struct failure_details>(std::move(d)))
+        {}
+
+        const std::error_code& code() const noexcept { return ec; }
+        bool has_failure_details() const noexcept { return details != nullptr; }
+        const struct failure_details& failure_details() const;
+        std::string message() const;
+
+        explicit operator bool() const noexcept { return static_cast<bool>(ec); }
+        bool operator !() const noexcept { return !ec; }
+
+        [[noreturn]] void raise() const;
+    };
+
+    template<typename T>
+    class expected {
+        T val;
+        error err;
+    public:
+        expected(T v) : val(std::move(v)) {}
+        expected(error e) : val(), err(std::move(e)) {}
+        expected(std::error_code ec) : val(), err(ec) {}
+
+        bool has_value() const noexcept { return !err; }
+        explicit operator bool() const noexcept { return has_value(); }
+        bool operator !() const noexcept { return !has_value(); }
+
+        const error& get_error() const noexcept { return err; }
+
+        T& value() & { if(err) err.raise(); return val; }
+        const T& value() const & { if(err) err.raise(); return val; }
+        T&& value() && { if(err) err.raise(); return std::move(val); }
+        T value_or(T def) const { return has_value() ? val : std::move(def); }
+
+        T& operator*() noexcept { return val; }
+        const T& operator*() const noexcept { return val; }
+        T* operator->() noexcept { return &val; }
+        const T* operator->() const noexcept { return &val; }
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/error.h"
+#endif
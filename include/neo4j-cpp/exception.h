@@ -5,4 +5,14 @@ namespace neo4j {
     class exception : public std::runtime_error {
         using std::runtime_error::runtime_error;
     };
+
+    // Thrown if a statement exceeded its deadline.
+    class timeout_error : public exception {
+        using exception::exception;
+    };
+
+    // Thrown if a stream exceeded its memory limit.
+    class memory_limit_error : public exception {
+        using exception::exception;
+    };
 }
\ No newline at end of file
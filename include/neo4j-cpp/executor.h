@@ -0,0 +1,148 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <utility>
+#include <functional>
+#include "connect_flags.h"
+#include "exception.h"
+#include "config.h"
+
+namespace neo4j {
+    class connection;
+
+    struct executor_options {
+        // 0 uses one worker per hardware thread
+        size_t workers = 0;
+        size_t connections_per_worker = 1;
+        // Pin worker i to CPU i modulo the CPU count (Linux only)
+        bool pin_threads = false;
+        // Idle workers run tasks queued for busy ones on their own connections
+        bool steal = true;
+    };
+
+    struct executor_stats {
+        size_t worker;
+        unsigned long long executed;
+        unsigned long long stolen;
+        size_t queued;
+    };
+
+    // Queue node, the completion function runs (con != nullptr) or abandons
+    // the task and frees it.
+    struct executor_task {
+        std::atomic<executor_task*> next{nullptr};
+        void (*complete)(executor_task* self, connection* con) = nullptr;
+    };
+
+    // Lock-free multi producer queue (Vyukov). Consumers are serialized by
+    // a try-lock so idle workers can steal without blocking the owner.
+    class executor_queue {
+        std::atomic<executor_task*> head;
+        executor_task* tail;
+        executor_task stub;
+        std::atomic_flag consuming = ATOMIC_FLAG_INIT;
+        std::atomic<size_t> count{0};
+
+        executor_task* pop_locked() noexcept;
+    public:
+        executor_queue() noexcept;
+        executor_queue(const executor_queue&) = delete;
+        executor_queue& operator=(const executor_queue&) = delete;
+
+        void push(executor_task* task) noexcept;
+        // Null if empty or another consumer is active
+        executor_task* try_pop() noexcept;
+        // Sequentially consistent with push(), the executor relies on this to
+        // park and wake workers without losing a task
+        size_t size() const noexcept { return count.load(); }
+    };
+
+    // Runs tasks on connections owned by worker threads. Each worker opens
+    // its own connections, so a connection is only ever used by one thread
+    // and tasks need no locking. Tasks for the same shard run in order on the
+    // same worker unless an idle worker steals them. Tasks must not be
+    // submitted while the executor is being destroyed.
+    class sharded_executor {
+        struct worker;
+        std::vector<std::unique_ptr<worker>> workers;
+        std::atomic<size_t> next_worker{0};
+        std::atomic<bool> stopping{false};
+        // Parked workers, a submitter only looks for a thief to wake if set
+        std::atomic<size_t> sleepers{0};
+        executor_options opts;
+
+        void start(const std::string& uri, const shared_config& conf, connect_flags flags);
+        void run_worker(worker& w, const std::string& uri, const shared_config& conf, connect_flags flags, std::promise<void>& ready);
+        bool run_one(worker& w);
+        worker* find_victim(const worker& w) const noexcept;
+        void enqueue(size_t shard, executor_task* task);
+        static void wake(worker& w);
+        // Wake one parked worker, if any, to steal from a busy one
+        void wake_thief();
+
+        template<typename R>
+        struct job : executor_task {
+            std::function<R(connection&)> fn;
+            std::promise<R> promise;
+        };
+        template<typename R>
+        static void invoke(std::promise<R>& p, std::function<R(connection&)>& fn, connection& con) { p.set_value(fn(con)); }
+        static void invoke(std::promise<void>& p, std::function<void(connection&)>& fn, connection& con) {
+            fn(con);
+            p.set_value();
+        }
+        template<typename R>
+        static void complete_job(executor_task* self, connection* con) {
+            std::unique_ptr<job<R>> j(static_cast<job<R>*>(self));
+            if(con == nullptr) {
+                j->promise.set_exception(std::make_exception_ptr(exception("executor stopped")));
+                return;
+            }
+            try {
+                invoke(j->promise, j->fn, *con);
+            } catch(...) {
+                j->promise.set_exception(std::current_exception());
+            }
+        }
+    public:
+        sharded_executor(const std::string& uri, const executor_options& opts = executor_options(), connect_flags flags = connect_flags::none);
+        sharded_executor(const std::string& uri, const config& conf, const executor_options& opts = executor_options(), connect_flags flags = connect_flags::none);
+        sharded_executor(const std::string& uri, shared_config conf, const executor_options& opts = executor_options(), connect_flags flags = connect_flags::none);
+        // Runs the queued tasks, then joins the workers
+        ~sharded_executor();
+
+        sharded_executor(const sharded_executor&) = delete;
+        sharded_executor& operator=(const sharded_executor&) = delete;
+
+        // Tasks with the same shard go to the same worker
+        template<typename Fn>
+        auto submit(size_t shard, Fn&& fn) -> std::future<decltype(fn(std::declval<connection&>()))> {
+            using R = decltype(fn(std::declval<connection&>()));
+            std::unique_ptr<job<R>> j(new job<R>());
+            j->fn = std::forward<Fn>(fn);
+            j->complete = &complete_job<R>;
+            auto res = j->promise.get_future();
+            enqueue(shard, j.get());
+            j.release();
+            return res;
+        }
+        // Distributes tasks round robin
+        template<typename Fn>
+        auto submit(Fn&& fn) -> std::future<decltype(fn(std::declval<connection&>()))> {
+            return submit(next_worker.fetch_add(1, std::memory_order_relaxed), std::forward<Fn>(fn));
+        }
+
+        size_t nworkers() const noexcept { return workers.size(); }
+        std::vector<executor_stats> stats() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/executor.h"
+#endif
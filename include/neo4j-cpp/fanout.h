@@ -0,0 +1,131 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include "value.h"
+
+namespace neo4j {
+    class connection_pool;
+
+    enum class merge_order {
+        // Rows are returned as soon as any shard produced them
+        unordered,
+        // Shards are sorted by the key column, rows are merged k-way
+        ordered
+    };
+
+    struct fanout_options {
+        merge_order order = merge_order::unordered;
+        // Key column for ordered merges, rows of every shard must be sorted by it
+        unsigned int key_column = 0;
+        bool descending = false;
+        // Shards run at once, 0 uses the pool size. Ordered merges run all shards at once.
+        size_t parallelism = 0;
+        // Rows buffered per shard before its worker waits for the consumer
+        size_t shard_buffer = 1024;
+    };
+
+    struct fanout_record {
+        size_t shard = 0;
+        std::vector<value> fields;
+        bool valid = false;
+
+        explicit operator bool() const noexcept { return valid; }
+        bool operator !() const noexcept { return !valid; }
+    };
+
+    enum class shard_state {
+        pending,
+        running,
+        done,
+        failed
+    };
+
+    struct shard_progress {
+        size_t shard;
+        shard_state state;
+        // Rows received from the server and handed to the consumer
+        unsigned long long rows_fetched;
+        unsigned long long rows_consumed;
+        // Time since the shard started, or its total time once done
+        std::chrono::steady_clock::duration elapsed;
+    };
+
+    // Merged rows of a fan-out. Workers run until every shard is done, the
+    // stream is destroyed or a shard failed.
+    class fanout_stream {
+        struct shard {
+            value params;
+            shard_state state = shard_state::pending;
+            std::deque<std::vector<value>> rows;
+            unsigned long long fetched = 0;
+            unsigned long long consumed = 0;
+            std::chrono::steady_clock::time_point started{};
+            std::chrono::steady_clock::time_point finished{};
+        };
+
+        std::shared_ptr<connection_pool> pool;
+        std::string query;
+        fanout_options opts;
+        std::vector<std::string> names;
+
+        mutable std::mutex mtx;
+        std::condition_variable row_ready;
+        std::condition_variable space_ready;
+        std::vector<shard> shards;
+        size_t next_shard = 0;
+        size_t last_shard = 0;
+        bool cancelled = false;
+        std::exception_ptr failure;
+        std::vector<std::thread> workers;
+
+        void work();
+        void run_shard(size_t idx);
+        bool pick(size_t& idx);
+    public:
+        // Use fanout_executor::run
+        fanout_stream(std::shared_ptr<connection_pool> pool, const std::string& query, std::vector<value> partitions, const fanout_options& opts);
+        ~fanout_stream();
+
+        fanout_stream(const fanout_stream&) = delete;
+        fanout_stream& operator=(const fanout_stream&) = delete;
+
+        // Waits for the next row, an invalid record marks the end. Rethrows
+        // the failure of a shard and stops the others.
+        fanout_record fetch_next();
+        // Field names, known once the first shard started
+        std::vector<std::string> fieldnames() const;
+
+        size_t nshards() const noexcept { return shards.size(); }
+        std::vector<shard_progress> progress() const;
+        // Running shards taking longer than factor times the median duration of
+        // the finished ones.
+        std::vector<size_t> stragglers(double factor = 2.0) const;
+        // Stop all shards, fetch_next returns no further rows
+        void cancel();
+    };
+
+    // Runs one parameterized query per partition concurrently on connections
+    // of a pool and merges the rows.
+    class fanout_executor {
+        std::shared_ptr<connection_pool> pool;
+        fanout_options opts;
+    public:
+        explicit fanout_executor(std::shared_ptr<connection_pool> pool, const fanout_options& opts = fanout_options());
+
+        // Each partition is a parameter map for one run of the query, e.g.
+        // {lo: 0, hi: 100000} for "MATCH (n) WHERE id(n) >= $lo AND id(n) < $hi RETURN n".
+        std::shared_ptr<fanout_stream> run(const std::string& query, std::vector<value> partitions) const;
+        std::shared_ptr<fanout_stream> run(const std::string& query, std::vector<value> partitions, const fanout_options& opts) const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/fanout.h"
+#endif
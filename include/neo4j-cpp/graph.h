@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "value.h"
+#include "intern.h"
+
+namespace neo4j {
+    class value_ref;
+    class result_stream;
+
+    // Compact adjacency of a subgraph. Nodes and relationships are numbered
+    // densely; the outgoing relationships of node n are the entries
+    // [offsets[n], offsets[n + 1]) of targets, types and relationship_ids.
+    struct csr_graph {
+        std::vector<long long> node_ids;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> types;
+        std::vector<long long> relationship_ids;
+        // Relationship type names indexed by the entries of types
+        std::vector<std::string> type_names;
+        // Only filled if requested: incoming relationships of node n are the
+        // positions in_edges[in_offsets[n]] .. in_edges[in_offsets[n + 1] - 1] of the arrays above
+        std::vector<uint32_t> in_offsets;
+        std::vector<uint32_t> in_edges;
+        // Requested property columns, indexed by node or relationship position, null if unset
+        std::map<std::string, std::vector<value>> node_properties;
+        std::map<std::string, std::vector<value>> relationship_properties;
+        std::unordered_map<long long, uint32_t> node_index;
+
+        size_t node_count() const noexcept { return node_ids.size(); }
+        size_t relationship_count() const noexcept { return targets.size(); }
+        uint32_t out_degree(uint32_t node) const noexcept { return offsets[node + 1] - offsets[node]; }
+        // Position of the node with the given identity
+        bool find_node(long long id, uint32_t& idx) const noexcept;
+        // Index into type_names, type_names.size() if unknown
+        uint32_t find_type(const std::string& name) const noexcept;
+    };
+
+    struct graph_builder_options {
+        // Properties copied into csr_graph columns
+        std::vector<std::string> node_properties;
+        std::vector<std::string> relationship_properties;
+        // Also build the incoming adjacency
+        bool incoming = false;
+    };
+
+    // Collects nodes and relationships from result rows, deduplicated by
+    // identity, and builds a csr_graph. Paths and (nested) lists of graph
+    // entities are taken apart, other values are ignored.
+    class graph_builder {
+        struct edge {
+            uint32_t source;
+            uint32_t target;
+            uint32_t type;
+        };
+
+        graph_builder_options opts;
+        std::vector<long long> node_ids;
+        std::unordered_map<long long, uint32_t> node_index;
+        std::vector<edge> edges;
+        std::vector<long long> relationship_ids;
+        std::unordered_set<long long> relationship_seen;
+        intern_table types;
+        std::vector<std::vector<value>> node_columns;
+        std::vector<std::vector<value>> relationship_columns;
+
+        void add_node(const value_ref& node);
+        void add_relationship(const value_ref& rel, long long start, long long end);
+    public:
+        explicit graph_builder(const graph_builder_options& opts = graph_builder_options());
+
+        void add(const value_ref& val);
+        // Consumes all remaining rows of the stream, returns their number
+        size_t add(result_stream& stream);
+
+        uint32_t add_node(long long id);
+        // Returns false if the relationship was added before
+        bool add_relationship(long long id, long long start, long long end, string_ref type);
+
+        size_t node_count() const noexcept { return node_ids.size(); }
+        size_t relationship_count() const noexcept { return edges.size(); }
+
+        // Builds the graph and resets the builder
+        csr_graph build();
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/graph.h"
+#endif
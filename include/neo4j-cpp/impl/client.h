@@ -37,4 +37,54 @@ namespace neo4j {
     {
         return std::make_shared<connection>(hostname, port, conf, insecure);
     }
-}
\ No newline at end of file
+
+    std::shared_ptr<connection> client::connect(const std::string& uri, shared_config conf, connect_flags flags)
+    {
+        return std::make_shared<connection>(uri, std::move(conf), flags);
+    }
+
+    std::shared_ptr<connection> client::connect(const std::string& hostname, uint16_t port, shared_config conf, bool insecure)
+    {
+        return std::make_shared<connection>(hostname, port, std::move(conf), insecure);
+    }
+
+    expected<std::shared_ptr<connection>> client::connect_nothrow(const std::string& uri, connect_flags flags)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<connection>(uri, flags, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<connection>> client::connect_nothrow(const std::string& uri, const config& conf, connect_flags flags)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<connection>(uri, conf, flags, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<connection>> client::connect_nothrow(const std::string& hostname, uint16_t port, const config& conf, bool insecure)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<connection>(hostname, port, conf, insecure, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<connection>> client::connect_nothrow(const std::string& uri, shared_config conf, connect_flags flags)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<connection>(uri, std::move(conf), flags, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<connection>> client::connect_nothrow(const std::string& hostname, uint16_t port, shared_config conf, bool insecure)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<connection>(hostname, port, std::move(conf), insecure, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+}
@@ -0,0 +1,303 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "../compare.h"
+
+namespace neo4j {
+    static const uint64_t hash_k0 = 0xa0761d6478bd642fULL;
+    static const uint64_t hash_k1 = 0xe7037ed1a0b428dbULL;
+    static const uint64_t hash_k2 = 0x8ebc6af09c88c6e3ULL;
+
+    static inline uint64_t hash_rotl(uint64_t x, int r) noexcept
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static inline uint64_t hash_mix(uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static inline uint64_t hash_combine(uint64_t h, uint64_t v) noexcept
+    {
+        return hash_mix(h ^ (v + hash_k0 + (h << 6) + (h >> 2)));
+    }
+
+    // Reads the buffer a word at a time in two independent lanes, so the
+    // multiplications of both lanes overlap.
+    static uint64_t hash_bytes(const char* p, size_t n, uint64_t seed) noexcept
+    {
+        uint64_t a = seed ^ hash_k0;
+        uint64_t b = (seed + n) * hash_k1;
+        size_t len = n;
+        while(n >= 16) {
+            uint64_t w0, w1;
+            memcpy(&w0, p, 8);
+            memcpy(&w1, p + 8, 8);
+            a = hash_rotl((a ^ w0) * hash_k1, 31);
+            b = hash_rotl((b ^ w1) * hash_k2, 29);
+            p += 16;
+            n -= 16;
+        }
+        if(n >= 8) {
+            uint64_t w;
+            memcpy(&w, p, 8);
+            a = hash_rotl((a ^ w) * hash_k1, 31);
+            p += 8;
+            n -= 8;
+        }
+        uint64_t tail = 0;
+        memcpy(&tail, p, n);
+        b = (b ^ tail) * hash_k2;
+        return hash_mix(a ^ hash_rotl(b, 17) ^ len);
+    }
+
+    static inline bool compare_is_number(value_type t) noexcept
+    {
+        return t == value_type::type_int || t == value_type::type_float;
+    }
+
+    // Position of a type in the Cypher ordering, numbers share one rank
+    static int compare_rank(value_type t) noexcept
+    {
+        switch(t) {
+            case value_type::type_map: return 0;
+            case value_type::type_node: return 1;
+            case value_type::type_relationship: return 2;
+            case value_type::type_list: return 3;
+            case value_type::type_path: return 4;
+            case value_type::type_bytes: return 5;
+            case value_type::type_string: return 6;
+            case value_type::type_bool: return 7;
+            case value_type::type_int:
+            case value_type::type_float: return 8;
+            case value_type::type_identity: return 9;
+            case value_type::type_null: return 11;
+            default: return 10;
+        }
+    }
+
+    template<typename T>
+    static inline int compare_three_way(T a, T b) noexcept
+    {
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+
+    static int compare_int_float(long long i, double f) noexcept
+    {
+        if(std::isnan(f)) return -1;
+        // Beyond the long long range the double decides on its own
+        if(f >= 9223372036854775808.0) return -1;
+        if(f < -9223372036854775808.0) return 1;
+        auto trunc = static_cast<long long>(f);
+        if(i != trunc) return compare_three_way(i, trunc);
+        return compare_three_way(0.0, f - static_cast<double>(trunc));
+    }
+
+    static int compare_numbers(const struct neo4j_value& a, value_type ta, const struct neo4j_value& b, value_type tb) noexcept
+    {
+        if(ta == value_type::type_int && tb == value_type::type_int)
+            return compare_three_way(neo4j_int_value(a), neo4j_int_value(b));
+        if(ta == value_type::type_int) return compare_int_float(neo4j_int_value(a), neo4j_float_value(b));
+        if(tb == value_type::type_int) return -compare_int_float(neo4j_int_value(b), neo4j_float_value(a));
+        double x = neo4j_float_value(a), y = neo4j_float_value(b);
+        if(std::isnan(x) || std::isnan(y)) return static_cast<int>(std::isnan(x)) - static_cast<int>(std::isnan(y));
+        return compare_three_way(x, y);
+    }
+
+    static int compare_strings(string_ref a, string_ref b) noexcept
+    {
+        int res = a.compare(b);
+        return res < 0 ? -1 : (res > 0 ? 1 : 0);
+    }
+
+    static std::vector<unsigned int> compare_sorted_keys(const value_ref& map)
+    {
+        std::vector<unsigned int> res(map.map_size());
+        for(unsigned int i = 0; i < res.size(); i++) res[i] = i;
+        std::sort(res.begin(), res.end(), [&map](unsigned int x, unsigned int y) { return map.map_key(x) < map.map_key(y); });
+        return res;
+    }
+
+    size_t string_ref_hash::operator()(string_ref str) const noexcept
+    {
+        return hash_bytes(str.data(), str.size(), hash_k2);
+    }
+
+    bool equals(const value_ref& a, const value_ref& b) noexcept
+    {
+        auto ta = a.get_type(), tb = b.get_type();
+        if(compare_is_number(ta) && compare_is_number(tb)) {
+            auto va = a.get_value(), vb = b.get_value();
+            if(ta == value_type::type_float && tb == value_type::type_float) {
+                double x = neo4j_float_value(va), y = neo4j_float_value(vb);
+                return x == y || (std::isnan(x) && std::isnan(y));
+            }
+            return compare_numbers(va, ta, vb, tb) == 0;
+        }
+        if(ta != tb) return false;
+        switch(ta) {
+            case value_type::type_null: return true;
+            case value_type::type_bool: return a.to_bool() == b.to_bool();
+            case value_type::type_identity: return a.to_identity() == b.to_identity();
+            case value_type::type_string: return a.to_string_ref() == b.to_string_ref();
+            case value_type::type_bytes: return a.to_bytes_ref() == b.to_bytes_ref();
+            case value_type::type_node: return a.node_id() == b.node_id();
+            case value_type::type_relationship: return a.relationship_id() == b.relationship_id();
+            case value_type::type_list: {
+                auto n = a.list_size();
+                if(n != b.list_size()) return false;
+                for(unsigned int i = 0; i < n; i++) {
+                    if(!equals(a.list_entry(i), b.list_entry(i))) return false;
+                }
+                return true;
+            }
+            case value_type::type_map: {
+                auto n = a.map_size();
+                if(n != b.map_size()) return false;
+                auto vb = b.get_value();
+                for(unsigned int i = 0; i < n; i++) {
+                    auto key = a.map_key(i);
+                    auto other = neo4j_map_kget(vb, neo4j_ustring(key.data(), key.size()));
+                    // A missing key reads as null, tell it apart from a null entry
+                    if(neo4j_type(other) == NEO4J_NULL) {
+                        bool found = false;
+                        for(unsigned int j = 0; j < n && !found; j++) found = b.map_key(j) == key;
+                        if(!found) return false;
+                    }
+                    if(!equals(a.map_value(i), value_ref(b.get_result(), other))) return false;
+                }
+                return true;
+            }
+            case value_type::type_path: {
+                auto n = a.path_length();
+                if(n != b.path_length()) return false;
+                for(unsigned int i = 0; i <= n; i++) {
+                    if(a.path_node(i).node_id() != b.path_node(i).node_id()) return false;
+                }
+                for(unsigned int i = 0; i < n; i++) {
+                    if(a.path_relationship(i).relationship_id() != b.path_relationship(i).relationship_id()) return false;
+                }
+                return true;
+            }
+            default: return false;
+        }
+    }
+
+    int compare(const value_ref& a, const value_ref& b) noexcept
+    {
+        auto ta = a.get_type(), tb = b.get_type();
+        int ra = compare_rank(ta), rb = compare_rank(tb);
+        if(ra != rb) return ra < rb ? -1 : 1;
+        switch(ta) {
+            case value_type::type_int:
+            case value_type::type_float: return compare_numbers(a.get_value(), ta, b.get_value(), tb);
+            case value_type::type_null: return 0;
+            case value_type::type_bool: return static_cast<int>(a.to_bool()) - static_cast<int>(b.to_bool());
+            case value_type::type_identity: return compare_three_way(a.to_identity(), b.to_identity());
+            case value_type::type_string: return compare_strings(a.to_string_ref(), b.to_string_ref());
+            case value_type::type_bytes: return compare_strings(a.to_bytes_ref(), b.to_bytes_ref());
+            case value_type::type_node: return compare_three_way(a.node_id(), b.node_id());
+            case value_type::type_relationship: return compare_three_way(a.relationship_id(), b.relationship_id());
+            case value_type::type_list: {
+                auto na = a.list_size(), nb = b.list_size();
+                for(unsigned int i = 0; i < na && i < nb; i++) {
+                    int res = compare(a.list_entry(i), b.list_entry(i));
+                    if(res != 0) return res;
+                }
+                return compare_three_way(na, nb);
+            }
+            case value_type::type_map: {
+                try {
+                    // Entries compare as (key, value) pairs in key order
+                    auto ka = compare_sorted_keys(a), kb = compare_sorted_keys(b);
+                    for(size_t i = 0; i < ka.size() && i < kb.size(); i++) {
+                        int res = compare_strings(a.map_key(ka[i]), b.map_key(kb[i]));
+                        if(res == 0) res = compare(a.map_value(ka[i]), b.map_value(kb[i]));
+                        if(res != 0) return res;
+                    }
+                    return compare_three_way(ka.size(), kb.size());
+                } catch(...) {
+                    return compare_three_way(a.map_size(), b.map_size());
+                }
+            }
+            case value_type::type_path: {
+                auto na = a.path_length(), nb = b.path_length();
+                for(unsigned int i = 0; i <= na && i <= nb; i++) {
+                    int res = compare_three_way(a.path_node(i).node_id(), b.path_node(i).node_id());
+                    if(res == 0 && i < na && i < nb)
+                        res = compare_three_way(a.path_relationship(i).relationship_id(), b.path_relationship(i).relationship_id());
+                    if(res != 0) return res;
+                }
+                return compare_three_way(na, nb);
+            }
+            default: return 0;
+        }
+    }
+
+    size_t hash_value(const value_ref& v) noexcept
+    {
+        auto type = v.get_type();
+        uint64_t seed = static_cast<uint64_t>(type) * hash_k2;
+        switch(type) {
+            case value_type::type_null: return hash_mix(seed);
+            case value_type::type_bool: return hash_mix(seed ^ v.to_bool());
+            case value_type::type_int:
+                return hash_mix(static_cast<uint64_t>(value_type::type_int) * hash_k2 ^ static_cast<uint64_t>(neo4j_int_value(v.get_value())));
+            case value_type::type_float: {
+                double f = neo4j_float_value(v.get_value());
+                // Integral floats must hash like the equal int
+                if(f >= -9223372036854775808.0 && f < 9223372036854775808.0 && std::trunc(f) == f)
+                    return hash_mix(static_cast<uint64_t>(value_type::type_int) * hash_k2 ^ static_cast<uint64_t>(static_cast<long long>(f)));
+                if(std::isnan(f)) return hash_mix(seed ^ 0x7ff8000000000000ULL);
+                uint64_t bits;
+                memcpy(&bits, &f, sizeof(bits));
+                return hash_mix(seed ^ bits);
+            }
+            case value_type::type_identity: return hash_mix(seed ^ static_cast<uint64_t>(v.to_identity()));
+            case value_type::type_string: {
+                auto str = v.to_string_ref();
+                return hash_bytes(str.data(), str.size(), seed);
+            }
+            case value_type::type_bytes: {
+                auto bytes = v.to_bytes_ref();
+                return hash_bytes(bytes.data(), bytes.size(), seed);
+            }
+            case value_type::type_node: return hash_mix(seed ^ static_cast<uint64_t>(v.node_id()));
+            case value_type::type_relationship: return hash_mix(seed ^ static_cast<uint64_t>(v.relationship_id()));
+            case value_type::type_list: {
+                auto n = v.list_size();
+                uint64_t h = seed ^ n;
+                for(unsigned int i = 0; i < n; i++) h = hash_combine(h, hash_value(v.list_entry(i)));
+                return hash_mix(h);
+            }
+            case value_type::type_map: {
+                // Entry order does not matter for equality, so the entries are summed
+                auto n = v.map_size();
+                uint64_t sum = 0;
+                for(unsigned int i = 0; i < n; i++) {
+                    auto key = v.map_key(i);
+                    sum += hash_combine(hash_bytes(key.data(), key.size(), hash_k1), hash_value(v.map_value(i)));
+                }
+                return hash_mix(seed ^ sum ^ n);
+            }
+            case value_type::type_path: {
+                auto n = v.path_length();
+                uint64_t h = seed ^ n;
+                for(unsigned int i = 0; i <= n; i++) h = hash_combine(h, static_cast<uint64_t>(v.path_node(i).node_id()));
+                for(unsigned int i = 0; i < n; i++) h = hash_combine(h, static_cast<uint64_t>(v.path_relationship(i).relationship_id()));
+                return hash_mix(h);
+            }
+            default: return hash_mix(seed);
+        }
+    }
+}
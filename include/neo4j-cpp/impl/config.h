@@ -2,6 +2,7 @@
 #include <neo4j-client.h>
 #include "../config.h"
 #include "../exception.h"
+#include "../transport.h"
 
 namespace neo4j {
     void config::copy_from(const config& other)
@@ -12,6 +13,8 @@ namespace neo4j {
             cfg = old_cfg;
             throw exception(neo4j_strerror(errno, nullptr, 0));
         }
+        memory_accounting = other.memory_accounting;
+        mem_limits = other.mem_limits;
         if(other.custom_client_id) {
             this->set_client_id(other.get_client_id());
         }
@@ -54,6 +57,11 @@ namespace neo4j {
         this->copy_from(other);
     }
 
+    shared_config config::freeze() const
+    {
+        return std::make_shared<const config>(*this);
+    }
+
     config& config::operator=(const config& other)
     {
         this->copy_from(other);
@@ -87,6 +95,16 @@ namespace neo4j {
         return neo4j_config_get_memory_allocator(cfg);
     }
 
+    bool config::get_memory_accounting() const
+    {
+        return memory_accounting;
+    }
+
+    const memory_limits& config::get_memory_limits() const
+    {
+        return mem_limits;
+    }
+
     const struct neo4j_plan_table_colors* config::get_plan_table_colorization() const
     {
         return neo4j_config_get_plan_table_colorization(cfg);
@@ -193,6 +211,11 @@ namespace neo4j {
         neo4j_config_set_connection_factory(cfg, factory);
     }
 
+    void config::set_interruptible_io(bool enable)
+    {
+        neo4j_config_set_connection_factory(cfg, enable ? interruptible_tcp_factory() : &neo4j_std_connection_factory);
+    }
+
     void config::set_known_hosts_file(const std::string& file)
     {
         int res = neo4j_config_set_known_hosts_file(cfg, file.c_str());
@@ -214,6 +237,17 @@ namespace neo4j {
         neo4j_config_set_memory_allocator(cfg, allocator);
     }
 
+    void config::set_memory_accounting(bool enable)
+    {
+        memory_accounting = enable;
+    }
+
+    void config::set_memory_limits(const memory_limits& limits)
+    {
+        mem_limits = limits;
+        memory_accounting = true;
+    }
+
     void config::set_password(const std::string& password)
     {
         int res = neo4j_config_set_password(cfg, password.c_str());
@@ -281,13 +315,13 @@ namespace neo4j {
 
     void config::set_so_rcvbuf_size(size_t size)
     {
-        int res = neo4j_config_set_rcvbuf_size(cfg, size);
+        int res = neo4j_config_set_so_rcvbuf_size(cfg, size);
         if(res != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
     void config::set_so_sndbuf_size(size_t size)
     {
-        int res = neo4j_config_set_sndbuf_size(cfg, size);
+        int res = neo4j_config_set_so_sndbuf_size(cfg, size);
         if(res != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
@@ -3,43 +3,124 @@
 #include "../exception.h"
 #include "../connection.h"
 #include "../config.h"
+#include "../error.h"
+#include "../result_stream.h"
+#include "../result.h"
+#include "../plan.h"
+#include "../params.h"
+#include "../transport.h"
 
 namespace neo4j {
-    connection::connection(const std::string& uri, connect_flags flags)
+    uint_fast32_t connection::native_flags(connect_flags flags) noexcept
     {
         uint_fast32_t nflags = 0;
         if((flags & connect_flags::insecure) != connect_flags::none) nflags |= NEO4J_INSECURE;
         if((flags & connect_flags::no_uri_credentials) != connect_flags::none) nflags |= NEO4J_NO_URI_CREDENTIALS;
         if((flags & connect_flags::no_uri_password) != connect_flags::none) nflags |= NEO4J_NO_URI_PASSWORD;
-        con = neo4j_connect(uri.c_str(), NULL, nflags);
+        return nflags;
+    }
+
+    connection::connection(const std::string& puri, connect_flags pflags)
+        : uri(puri), flags(pflags)
+    {
+        transport_interrupt::capture capture(transport);
+        con = neo4j_connect(uri.c_str(), native_config(), native_flags(flags));
         if(con == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
-    connection::connection(const std::string& uri, const config& conf, connect_flags flags)
-        : cfg(std::make_unique<config>(conf))
+    connection::connection(const std::string& puri, const config& conf, connect_flags pflags)
+        : connection(puri, conf.freeze(), pflags)
+    {}
+
+    connection::connection(const std::string& hostname, uint16_t port, const config& conf, bool pinsecure)
+        : connection(hostname, port, conf.freeze(), pinsecure)
+    {}
+
+    connection::connection(const std::string& puri, shared_config conf, connect_flags pflags)
+        : cfg(std::move(conf)), uri(puri), flags(pflags)
     {
-        uint_fast32_t nflags = 0;
-        if((flags & connect_flags::insecure) != connect_flags::none) nflags |= NEO4J_INSECURE;
-        if((flags & connect_flags::no_uri_credentials) != connect_flags::none) nflags |= NEO4J_NO_URI_CREDENTIALS;
-        if((flags & connect_flags::no_uri_password) != connect_flags::none) nflags |= NEO4J_NO_URI_PASSWORD;
-        con = neo4j_connect(uri.c_str(), cfg->cfg, nflags);
+        setup_memory_accounting();
+        transport_interrupt::capture capture(transport);
+        con = neo4j_connect(uri.c_str(), native_config(), native_flags(flags));
         if(con == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
-    connection::connection(const std::string& hostname, uint16_t port, const config& conf, bool insecure)
-        : cfg(std::make_unique<config>(conf))
+    connection::connection(const std::string& hostname, uint16_t port, shared_config conf, bool pinsecure)
+        : cfg(std::move(conf)), insecure(pinsecure)
     {
-        con = neo4j_tcp_connect(hostname.c_str(), port, cfg->cfg, insecure ? NEO4J_INSECURE : NEO4J_CONNECT_DEFAULT);
+        setup_memory_accounting();
+        transport_interrupt::capture capture(transport);
+        con = neo4j_tcp_connect(hostname.c_str(), port, native_config(), insecure ? NEO4J_INSECURE : NEO4J_CONNECT_DEFAULT);
         if(con == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
+    connection::connection(const std::string& puri, connect_flags pflags, std::error_code& ec)
+        : uri(puri), flags(pflags)
+    {
+        transport_interrupt::capture capture(transport);
+        con = neo4j_connect(uri.c_str(), native_config(), native_flags(flags));
+        if(con == nullptr) ec = make_client_error(errno);
+        else ec.clear();
+    }
+
+    connection::connection(const std::string& puri, const config& conf, connect_flags pflags, std::error_code& ec)
+        : connection(puri, conf.freeze(), pflags, ec)
+    {}
+
+    connection::connection(const std::string& hostname, uint16_t port, const config& conf, bool pinsecure, std::error_code& ec)
+        : connection(hostname, port, conf.freeze(), pinsecure, ec)
+    {}
+
+    connection::connection(const std::string& puri, shared_config conf, connect_flags pflags, std::error_code& ec)
+        : cfg(std::move(conf)), uri(puri), flags(pflags)
+    {
+        setup_memory_accounting();
+        transport_interrupt::capture capture(transport);
+        con = neo4j_connect(uri.c_str(), native_config(), native_flags(flags));
+        if(con == nullptr) ec = make_client_error(errno);
+        else ec.clear();
+    }
+
+    connection::connection(const std::string& hostname, uint16_t port, shared_config conf, bool pinsecure, std::error_code& ec)
+        : cfg(std::move(conf)), insecure(pinsecure)
+    {
+        setup_memory_accounting();
+        transport_interrupt::capture capture(transport);
+        con = neo4j_tcp_connect(hostname.c_str(), port, native_config(), insecure ? NEO4J_INSECURE : NEO4J_CONNECT_DEFAULT);
+        if(con == nullptr) ec = make_client_error(errno);
+        else ec.clear();
+    }
+
+    struct neo4j_config* connection::native_config() const
+    {
+        return cfg ? cfg->cfg : nullptr;
+    }
+
+    void connection::setup_memory_accounting()
+    {
+        origin = cfg;
+        if(!cfg || !cfg->get_memory_accounting()) return;
+        account.reset(new memory_account(cfg->get_memory_limits(), cfg->get_memory_allocator()));
+        // The allocator is per connection, so accounting configs are not shared
+        auto own = std::make_shared<config>(*cfg);
+        own->set_memory_allocator(account->allocator());
+        cfg = std::move(own);
+    }
+
     connection::~connection()
     {
+        if(con == nullptr) return;
         int res = neo4j_close(con);
         (void)res;
         // TODO: How to handle error ?
     }
 
+    std::shared_ptr<connection> connection::reconnect() const
+    {
+        if(uri.empty()) return std::make_shared<connection>(get_hostname(), get_port(), origin, insecure);
+        return std::make_shared<connection>(uri, origin, flags);
+    }
+
     std::string connection::get_hostname() const
     {
         return neo4j_connection_hostname(con);
@@ -74,12 +155,29 @@ namespace neo4j {
         return ptr;
     }
 
+    memory_usage connection::get_memory_usage() const noexcept
+    {
+        if(account == nullptr) return memory_usage{ 0, 0, 0, 0 };
+        return account->usage();
+    }
+
     void connection::reset()
     {
+        std::lock_guard<std::mutex> lck(ctl);
+        clear_interrupt_locked();
         int res = neo4j_reset(con);
         if(res != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
     }
 
+    void connection::reset(std::error_code& ec) noexcept
+    {
+        std::lock_guard<std::mutex> lck(ctl);
+        clear_interrupt_locked();
+        int res = neo4j_reset(con);
+        if(res != 0) ec = make_client_error(errno);
+        else ec.clear();
+    }
+
     std::shared_ptr<result_stream> connection::send(const std::string& query)
     {
         return std::make_shared<result_stream>(this->shared_from_this(), false, query);
@@ -89,4 +187,156 @@ namespace neo4j {
     {
         return std::make_shared<result_stream>(this->shared_from_this(), true, query);
     }
-}
\ No newline at end of file
+
+    void connection::interrupt() noexcept
+    {
+        std::lock_guard<std::mutex> lck(ctl);
+        clear_interrupt_locked();
+        int res = neo4j_reset(con);
+        (void)res;
+    }
+
+    void connection::interrupt_async() noexcept
+    {
+        // No libneo4j calls here, the owning thread may be using the connection.
+        // The transport goes first, so a settle() seeing the flag clears both.
+        if(transport) {
+            aborted = true;
+            transport->interrupt();
+        }
+        interrupted = true;
+    }
+
+    bool connection::needs_settle() const noexcept
+    {
+        return interrupted || (transport && transport->is_interrupted());
+    }
+
+    void connection::settle() noexcept
+    {
+        if(!needs_settle()) return;
+        std::lock_guard<std::mutex> lck(ctl);
+        settle_locked();
+    }
+
+    void connection::settle_locked() noexcept
+    {
+        if(!needs_settle()) return;
+        clear_interrupt_locked();
+        // Fails whatever is still outstanding. If the interrupt aborted a
+        // read mid message, libneo4j closed the session and this fails too.
+        int res = neo4j_reset(con);
+        (void)res;
+    }
+
+    void connection::clear_interrupt_locked() noexcept
+    {
+        interrupted = false;
+        if(transport) transport->clear();
+    }
+
+    std::shared_ptr<result_stream> connection::send(const std::string& query, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), false, query, timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::run(const std::string& query, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), true, query, timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::send(const std::string& query, const value& params)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), false, query, params);
+    }
+
+    std::shared_ptr<result_stream> connection::run(const std::string& query, const value& params)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), true, query, params);
+    }
+
+    std::shared_ptr<result_stream> connection::send(const std::string& query, const value& params, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), false, query, params, timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::run(const std::string& query, const value& params, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), true, query, params, timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::send(const std::string& query, const parameters& params)
+    {
+        // The stream keeps a shallow value whose payload stays with params
+        return send(query, value(nullptr, params.get_value()));
+    }
+
+    std::shared_ptr<result_stream> connection::run(const std::string& query, const parameters& params)
+    {
+        return run(query, value(nullptr, params.get_value()));
+    }
+
+    std::shared_ptr<result_stream> connection::send(const std::string& query, const parameters& params, std::chrono::milliseconds timeout)
+    {
+        return send(query, value(nullptr, params.get_value()), timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::run(const std::string& query, const parameters& params, std::chrono::milliseconds timeout)
+    {
+        return run(query, value(nullptr, params.get_value()), timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::send(static_query query, const value& params, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), false, query, params, timeout);
+    }
+
+    std::shared_ptr<result_stream> connection::run(static_query query, const value& params, std::chrono::milliseconds timeout)
+    {
+        return std::make_shared<result_stream>(this->shared_from_this(), true, query, params, timeout);
+    }
+
+    struct statement_plan connection::profile(const std::string& query)
+    {
+        auto stream = run("PROFILE " + query);
+        while(stream->fetch_next()) {}
+        return stream->statement_plan();
+    }
+
+    struct statement_plan connection::explain(const std::string& query)
+    {
+        return run("EXPLAIN " + query)->statement_plan();
+    }
+
+    expected<std::shared_ptr<result_stream>> connection::send_nothrow(const std::string& query)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<result_stream>(this->shared_from_this(), false, query, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<result_stream>> connection::run_nothrow(const std::string& query)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<result_stream>(this->shared_from_this(), true, query, ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<result_stream>> connection::send_nothrow(const std::string& query, const value& params)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<result_stream>(this->shared_from_this(), false, query, params, std::chrono::milliseconds::zero(), ec);
+        if(ec) return error(ec);
+        return res;
+    }
+
+    expected<std::shared_ptr<result_stream>> connection::run_nothrow(const std::string& query, const value& params)
+    {
+        std::error_code ec;
+        auto res = std::make_shared<result_stream>(this->shared_from_this(), true, query, params, std::chrono::milliseconds::zero(), ec);
+        if(ec) return error(ec);
+        return res;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <neo4j-client.h>
+#include "../cursor.h"
+#include "../result_stream.h"
+#include "../exception.h"
+
+namespace neo4j {
+    result_cursor::result_cursor(std::shared_ptr<result_stream> s, unsigned int w)
+        : stream(std::move(s)), window(w == 0 ? 1 : w)
+    {
+        if(stream == nullptr) throw exception("result_cursor requires a stream");
+        fields = stream->nfields();
+    }
+
+    void result_cursor::read_ahead() noexcept
+    {
+        // libneo4j only parses records on demand, so peeking window - 1 records
+        // ahead bounds the buffered records. Refilling once the window drained keeps
+        // the peek cost linear in the number of rows.
+        if(exhausted || window == 1 || ahead != 0) return;
+        std::error_code ec;
+        auto res = stream->peek(window - 1, ec);
+        if(res) ahead = window;
+        else if(!ec) exhausted = true;
+        // Errors (including memory pressure) are left to fetch_next
+    }
+
+    bool result_cursor::next()
+    {
+        std::error_code ec;
+        bool res = next(ec);
+        if(ec) {
+            if(ec == std::errc::timed_out) throw timeout_error("statement deadline exceeded");
+            if(stream->is_memory_exceeded()) throw memory_limit_error("stream memory limit exceeded");
+            throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+        }
+        return res;
+    }
+
+    bool result_cursor::next(std::error_code& ec) noexcept
+    {
+        // Drop our reference first so libneo4j can recycle the row
+        current = neo4j::result();
+        current = stream->fetch_next(ec);
+        if(!current) return false;
+        rows++;
+        if(ahead != 0) ahead--;
+        read_ahead();
+        return true;
+    }
+
+    value_ref result_cursor::field(unsigned int idx) const
+    {
+        if(!current) throw exception("cursor is not positioned on a row");
+        if(idx >= fields) throw exception("field index out of range");
+        return current.field_ref(idx);
+    }
+
+    value result_cursor::copy_field(unsigned int idx) const
+    {
+        return field(idx).to_owned();
+    }
+
+    std::vector<value> result_cursor::copy_row() const
+    {
+        std::vector<value> res;
+        res.reserve(fields);
+        for(unsigned int i = 0; i < fields; i++) res.push_back(copy_field(i));
+        return res;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <neo4j-client.h>
+#include "../error.h"
+#include "../exception.h"
+
+namespace neo4j {
+    class client_error_category : public std::error_category {
+    public:
+        const char* name() const noexcept override { return "neo4j-client"; }
+        std::string message(int ev) const override {
+            char buf[256];
+            auto ptr = neo4j_strerror(ev, buf, sizeof(buf));
+            return ptr == nullptr ? "Unknown error" : ptr;
+        }
+    };
+
+    const std::error_category& client_category() noexcept
+    {
+        static client_error_category category;
+        return category;
+    }
+
+    const struct failure_details& error::failure_details() const
+    {
+        if(!details) throw exception("No failure details available");
+        return *details;
+    }
+
+    std::string error::message() const
+    {
+        if(details) return details->message;
+        return ec.message();
+    }
+
+    void error::raise() const
+    {
+        throw exception(message());
+    }
+}
@@ -0,0 +1,246 @@
+#pragma once
+#include <algorithm>
+#include "../executor.h"
+#include "../connection.h"
+#include "../config.h"
+#include "../exception.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace neo4j {
+    executor_queue::executor_queue() noexcept
+        : head(&stub), tail(&stub)
+    {}
+
+    void executor_queue::push(executor_task* task) noexcept
+    {
+        // Counted first so size() never drops below the poppable tasks
+        count.fetch_add(1);
+        task->next.store(nullptr, std::memory_order_relaxed);
+        auto prev = head.exchange(task, std::memory_order_acq_rel);
+        prev->next.store(task, std::memory_order_release);
+    }
+
+    executor_task* executor_queue::pop_locked() noexcept
+    {
+        auto t = tail;
+        auto next = t->next.load(std::memory_order_acquire);
+        if(t == &stub) {
+            if(next == nullptr) return nullptr;
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if(next != nullptr) {
+            tail = next;
+            return t;
+        }
+        // A producer swapped head but has not linked its node yet
+        if(t != head.load(std::memory_order_acquire)) return nullptr;
+        push(&stub);
+        count.fetch_sub(1);
+        next = t->next.load(std::memory_order_acquire);
+        if(next != nullptr) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+    executor_task* executor_queue::try_pop() noexcept
+    {
+        if(consuming.test_and_set(std::memory_order_acquire)) return nullptr;
+        auto res = pop_locked();
+        consuming.clear(std::memory_order_release);
+        if(res != nullptr) count.fetch_sub(1);
+        return res;
+    }
+
+    struct sharded_executor::worker {
+        size_t index;
+        executor_queue queue;
+        std::vector<std::shared_ptr<connection>> conns;
+        size_t next_con = 0;
+        std::atomic<unsigned long long> executed{0};
+        std::atomic<unsigned long long> stolen{0};
+        // Set while a task runs, the queued tasks wait behind it
+        std::atomic<bool> running{false};
+        // Only used to park idle workers
+        std::atomic<bool> sleeping{false};
+        std::mutex mtx;
+        std::condition_variable wake;
+        std::thread thread;
+    };
+
+    sharded_executor::sharded_executor(const std::string& uri, const executor_options& o, connect_flags flags)
+        : opts(o)
+    {
+        start(uri, nullptr, flags);
+    }
+
+    sharded_executor::sharded_executor(const std::string& uri, const config& conf, const executor_options& o, connect_flags flags)
+        : sharded_executor(uri, conf.freeze(), o, flags)
+    {}
+
+    sharded_executor::sharded_executor(const std::string& uri, shared_config conf, const executor_options& o, connect_flags flags)
+        : opts(o)
+    {
+        start(uri, conf, flags);
+    }
+
+    void sharded_executor::start(const std::string& uri, const shared_config& conf, connect_flags flags)
+    {
+        size_t n = opts.workers;
+        if(n == 0) n = std::max(1u, std::thread::hardware_concurrency());
+        if(opts.connections_per_worker == 0) opts.connections_per_worker = 1;
+        std::vector<std::promise<void>> ready(n);
+        for(size_t i = 0; i < n; i++) {
+            workers.emplace_back(new worker());
+            workers.back()->index = i;
+        }
+        for(size_t i = 0; i < n; i++) {
+            auto& w = *workers[i];
+            w.thread = std::thread([this, &w, &uri, &conf, flags, &ready, i]() { run_worker(w, uri, conf, flags, ready[i]); });
+        }
+        // Connections are opened by their workers, report the first failure
+        std::exception_ptr failure;
+        for(auto& r : ready) {
+            try {
+                r.get_future().get();
+            } catch(...) {
+                if(!failure) failure = std::current_exception();
+            }
+        }
+        if(failure) {
+            stopping = true;
+            for(auto& w : workers) wake(*w);
+            for(auto& w : workers) w->thread.join();
+            std::rethrow_exception(failure);
+        }
+    }
+
+    sharded_executor::~sharded_executor()
+    {
+        stopping = true;
+        for(auto& w : workers) wake(*w);
+        for(auto& w : workers) {
+            if(w->thread.joinable()) w->thread.join();
+        }
+    }
+
+    void sharded_executor::enqueue(size_t shard, executor_task* task)
+    {
+        if(stopping) throw exception("executor stopped");
+        auto& w = *workers[shard % workers.size()];
+        w.queue.push(task);
+        // All seq_cst: either the parking worker sees the task or we see it
+        // parked (see run_worker)
+        if(w.sleeping) {
+            wake(w);
+            return;
+        }
+        // The owner is busy, let a parked worker take the task
+        if(opts.steal && w.running) wake_thief();
+    }
+
+    void sharded_executor::wake_thief()
+    {
+        if(sleepers == 0) return;
+        for(auto& other : workers) {
+            if(other->sleeping) {
+                wake(*other);
+                return;
+            }
+        }
+    }
+
+    void sharded_executor::wake(worker& w)
+    {
+        std::lock_guard<std::mutex> lck(w.mtx);
+        w.wake.notify_all();
+    }
+
+    sharded_executor::worker* sharded_executor::find_victim(const worker& w) const noexcept
+    {
+        // The most loaded worker busy with a task, an idle owner runs its queue itself
+        worker* victim = nullptr;
+        for(auto& other : workers) {
+            if(other.get() == &w || !other->running || other->queue.size() == 0) continue;
+            if(victim == nullptr || other->queue.size() > victim->queue.size()) victim = other.get();
+        }
+        return victim;
+    }
+
+    bool sharded_executor::run_one(worker& w)
+    {
+        auto task = w.queue.try_pop();
+        bool steal = false;
+        if(task == nullptr && opts.steal) {
+            // Run it on our own connection
+            auto victim = find_victim(w);
+            if(victim != nullptr) {
+                task = victim->queue.try_pop();
+                steal = task != nullptr;
+            }
+        }
+        if(task == nullptr) return false;
+        auto& con = *w.conns[w.next_con];
+        w.next_con = (w.next_con + 1) % w.conns.size();
+        // Counted before completing, so a caller woken by the future sees it
+        w.executed.fetch_add(1, std::memory_order_relaxed);
+        if(steal) w.stolen.fetch_add(1, std::memory_order_relaxed);
+        // All seq_cst: a worker parking meanwhile either sees us running or
+        // is woken here (see run_worker)
+        w.running = true;
+        if(opts.steal && w.queue.size() > 0) wake_thief();
+        task->complete(task, &con);
+        w.running = false;
+        return true;
+    }
+
+    void sharded_executor::run_worker(worker& w, const std::string& uri, const shared_config& conf, connect_flags flags, std::promise<void>& ready)
+    {
+#ifdef __linux__
+        if(opts.pin_threads) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(w.index % std::max(1u, std::thread::hardware_concurrency()), &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#endif
+        try {
+            for(size_t i = 0; i < opts.connections_per_worker; i++) {
+                w.conns.push_back(std::make_shared<connection>(uri, conf, flags));
+            }
+            ready.set_value();
+        } catch(...) {
+            ready.set_exception(std::current_exception());
+            return;
+        }
+        while(true) {
+            if(run_one(w)) continue;
+            if(stopping) {
+                // Drain what is still queued for us
+                if(w.queue.size() == 0) break;
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lck(w.mtx);
+            // Published before checking the queues, pairs with enqueue
+            w.sleeping = true;
+            sleepers++;
+            if(w.queue.size() == 0 && !stopping && !(opts.steal && find_victim(w) != nullptr)) w.wake.wait(lck);
+            sleepers--;
+            w.sleeping = false;
+        }
+    }
+
+    std::vector<executor_stats> sharded_executor::stats() const
+    {
+        std::vector<executor_stats> res;
+        for(auto& w : workers) res.push_back({ w->index, w->executed.load(), w->stolen.load(), w->queue.size() });
+        return res;
+    }
+}
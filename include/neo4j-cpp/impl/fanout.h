@@ -0,0 +1,237 @@
+#pragma once
+#include <neo4j-client.h>
+#include <algorithm>
+#include "../fanout.h"
+#include "../pool.h"
+#include "../connection.h"
+#include "../result_stream.h"
+#include "../result.h"
+#include "../value_ref.h"
+#include "../exception.h"
+#include "../compare.h"
+
+namespace neo4j {
+    fanout_stream::fanout_stream(std::shared_ptr<connection_pool> p, const std::string& q, std::vector<value> partitions, const fanout_options& o)
+        : pool(std::move(p)), query(q), opts(o), shards(partitions.size())
+    {
+        if(!pool) throw exception("fan-out needs a connection pool");
+        if(opts.shard_buffer == 0) opts.shard_buffer = 1;
+        for(size_t i = 0; i < partitions.size(); i++) {
+            if(!partitions[i].is_null() && !partitions[i].is_map()) throw exception("fan-out partitions must be parameter maps");
+            shards[i].params = std::move(partitions[i]);
+        }
+        size_t nworkers;
+        if(opts.order == merge_order::ordered) {
+            // Merging needs the head of every shard, so they all run at once
+            if(shards.size() > pool->get_max_size()) throw exception("ordered fan-out needs one pooled connection per partition");
+            nworkers = shards.size();
+        } else {
+            nworkers = opts.parallelism == 0 ? pool->get_max_size() : opts.parallelism;
+            nworkers = std::min(nworkers, shards.size());
+        }
+        try {
+            for(size_t i = 0; i < nworkers; i++) workers.emplace_back([this](){ work(); });
+        } catch(...) {
+            cancel();
+            for(auto& t : workers) t.join();
+            throw;
+        }
+    }
+
+    fanout_stream::~fanout_stream()
+    {
+        cancel();
+        for(auto& t : workers) t.join();
+    }
+
+    void fanout_stream::work()
+    {
+        while(true) {
+            size_t idx;
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                if(cancelled || next_shard >= shards.size()) return;
+                idx = next_shard++;
+                shards[idx].state = shard_state::running;
+                shards[idx].started = std::chrono::steady_clock::now();
+            }
+            run_shard(idx);
+        }
+    }
+
+    void fanout_stream::run_shard(size_t idx)
+    {
+        auto& s = shards[idx];
+        try {
+            auto con = pool->acquire();
+            // Params are not modified once workers started
+            auto stream = con->run(query, s.params);
+            auto n = stream->nfields();
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                if(names.empty()) {
+                    for(unsigned int i = 0; i < n; i++) names.push_back(stream->fieldname(i));
+                }
+            }
+            while(true) {
+                auto rec = stream->fetch_next();
+                if(!rec) break;
+                // Copy out of the row so it outlives the worker's stream
+                std::vector<value> row;
+                row.reserve(n);
+                for(unsigned int i = 0; i < n; i++) row.push_back(rec.field_ref(i).to_owned());
+                std::unique_lock<std::mutex> lck(mtx);
+                space_ready.wait(lck, [&](){ return cancelled || s.rows.size() < opts.shard_buffer; });
+                if(cancelled) {
+                    lck.unlock();
+                    // Drop the remaining rows on the server instead of draining them
+                    std::error_code ec;
+                    con->reset(ec);
+                    break;
+                }
+                s.rows.push_back(std::move(row));
+                s.fetched++;
+                row_ready.notify_all();
+            }
+            std::lock_guard<std::mutex> lck(mtx);
+            s.state = shard_state::done;
+            s.finished = std::chrono::steady_clock::now();
+            row_ready.notify_all();
+        } catch(...) {
+            std::lock_guard<std::mutex> lck(mtx);
+            s.state = shard_state::failed;
+            s.finished = std::chrono::steady_clock::now();
+            if(!failure) failure = std::current_exception();
+            cancelled = true;
+            row_ready.notify_all();
+            space_ready.notify_all();
+        }
+    }
+
+    bool fanout_stream::pick(size_t& idx)
+    {
+        if(shards.empty()) return false;
+        if(opts.order == merge_order::unordered) {
+            // Round robin over the shards with buffered rows
+            for(size_t i = 1; i <= shards.size(); i++) {
+                auto candidate = (last_shard + i) % shards.size();
+                if(!shards[candidate].rows.empty()) {
+                    idx = last_shard = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+        static const value null_key;
+        auto key = [&](size_t i) -> const value& {
+            auto& row = shards[i].rows.front();
+            return opts.key_column < row.size() ? row[opts.key_column] : null_key;
+        };
+        bool found = false;
+        for(size_t i = 0; i < shards.size(); i++) {
+            auto& s = shards[i];
+            if(s.rows.empty()) {
+                // An unfinished shard may still produce a smaller key
+                if(s.state == shard_state::pending || s.state == shard_state::running) return false;
+                continue;
+            }
+            if(!found) {
+                idx = i;
+                found = true;
+                continue;
+            }
+            int cmp = compare(key(i), key(idx));
+            if(opts.descending ? cmp > 0 : cmp < 0) idx = i;
+        }
+        return found;
+    }
+
+    fanout_record fanout_stream::fetch_next()
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        while(true) {
+            if(failure) std::rethrow_exception(failure);
+            if(cancelled) return fanout_record();
+            size_t idx;
+            if(pick(idx)) {
+                auto& s = shards[idx];
+                fanout_record res;
+                res.shard = idx;
+                res.fields = std::move(s.rows.front());
+                res.valid = true;
+                s.rows.pop_front();
+                s.consumed++;
+                space_ready.notify_all();
+                return res;
+            }
+            bool active = false;
+            for(auto& s : shards) {
+                if(s.state == shard_state::pending || s.state == shard_state::running || !s.rows.empty()) active = true;
+            }
+            if(!active) return fanout_record();
+            row_ready.wait(lck);
+        }
+    }
+
+    std::vector<std::string> fanout_stream::fieldnames() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return names;
+    }
+
+    std::vector<shard_progress> fanout_stream::progress() const
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lck(mtx);
+        std::vector<shard_progress> res;
+        res.reserve(shards.size());
+        for(size_t i = 0; i < shards.size(); i++) {
+            auto& s = shards[i];
+            std::chrono::steady_clock::duration elapsed{0};
+            if(s.state == shard_state::running) elapsed = now - s.started;
+            else if(s.state != shard_state::pending) elapsed = s.finished - s.started;
+            res.push_back({i, s.state, s.fetched, s.consumed, elapsed});
+        }
+        return res;
+    }
+
+    std::vector<size_t> fanout_stream::stragglers(double factor) const
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lck(mtx);
+        std::vector<std::chrono::steady_clock::duration> done;
+        for(auto& s : shards) {
+            if(s.state == shard_state::done) done.push_back(s.finished - s.started);
+        }
+        std::vector<size_t> res;
+        if(done.empty()) return res;
+        std::nth_element(done.begin(), done.begin() + done.size() / 2, done.end());
+        auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(done[done.size() / 2] * factor);
+        for(size_t i = 0; i < shards.size(); i++) {
+            if(shards[i].state == shard_state::running && now - shards[i].started > limit) res.push_back(i);
+        }
+        return res;
+    }
+
+    void fanout_stream::cancel()
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        cancelled = true;
+        row_ready.notify_all();
+        space_ready.notify_all();
+    }
+
+    fanout_executor::fanout_executor(std::shared_ptr<connection_pool> p, const fanout_options& o)
+        : pool(std::move(p)), opts(o)
+    {}
+
+    std::shared_ptr<fanout_stream> fanout_executor::run(const std::string& query, std::vector<value> partitions) const
+    {
+        return run(query, std::move(partitions), opts);
+    }
+
+    std::shared_ptr<fanout_stream> fanout_executor::run(const std::string& query, std::vector<value> partitions, const fanout_options& o) const
+    {
+        return std::make_shared<fanout_stream>(pool, query, std::move(partitions), o);
+    }
+}
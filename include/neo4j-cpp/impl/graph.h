@@ -0,0 +1,174 @@
+#pragma once
+#include <neo4j-client.h>
+#include <limits>
+#include "../graph.h"
+#include "../value_ref.h"
+#include "../path.h"
+#include "../result.h"
+#include "../result_stream.h"
+#include "../exception.h"
+
+namespace neo4j {
+    bool csr_graph::find_node(long long id, uint32_t& idx) const noexcept
+    {
+        auto it = node_index.find(id);
+        if(it == node_index.end()) return false;
+        idx = it->second;
+        return true;
+    }
+
+    uint32_t csr_graph::find_type(const std::string& name) const noexcept
+    {
+        for(size_t i = 0; i < type_names.size(); i++) {
+            if(type_names[i] == name) return static_cast<uint32_t>(i);
+        }
+        return static_cast<uint32_t>(type_names.size());
+    }
+
+    graph_builder::graph_builder(const graph_builder_options& o)
+        : opts(o), node_columns(o.node_properties.size()), relationship_columns(o.relationship_properties.size())
+    {}
+
+    uint32_t graph_builder::add_node(long long id)
+    {
+        auto it = node_index.find(id);
+        if(it != node_index.end()) return it->second;
+        if(node_ids.size() >= std::numeric_limits<uint32_t>::max()) throw exception("too many nodes for graph_builder");
+        auto idx = static_cast<uint32_t>(node_ids.size());
+        node_ids.push_back(id);
+        node_index.emplace(id, idx);
+        for(auto& col : node_columns) col.emplace_back();
+        return idx;
+    }
+
+    bool graph_builder::add_relationship(long long id, long long start, long long end, string_ref type)
+    {
+        if(!relationship_seen.insert(id).second) return false;
+        if(edges.size() >= std::numeric_limits<uint32_t>::max()) throw exception("too many relationships for graph_builder");
+        auto source = add_node(start);
+        auto target = add_node(end);
+        edges.push_back({source, target, types.intern(type)});
+        relationship_ids.push_back(id);
+        for(auto& col : relationship_columns) col.emplace_back();
+        return true;
+    }
+
+    // Compares keys in place, so rows don't pay for a std::map of their properties
+    static void copy_columns(const value_ref& props, const std::vector<std::string>& names, std::vector<std::vector<value>>& columns, size_t idx)
+    {
+        auto n = props.map_size();
+        for(unsigned int k = 0; k < n; k++) {
+            auto key = props.map_key(k);
+            for(size_t i = 0; i < names.size(); i++) {
+                if(key == string_ref(names[i])) columns[i][idx] = props.map_value(k).to_owned();
+            }
+        }
+    }
+
+    void graph_builder::add_node(const value_ref& node)
+    {
+        auto idx = add_node(node.node_id());
+        if(node_columns.empty()) return;
+        copy_columns(node.node_properties_ref(), opts.node_properties, node_columns, idx);
+    }
+
+    void graph_builder::add_relationship(const value_ref& rel, long long start, long long end)
+    {
+        auto id = rel.relationship_id();
+        // Checked first so duplicates don't pay for the type string
+        if(relationship_seen.count(id) != 0) return;
+        add_relationship(id, start, end, rel.relationship_type_ref());
+        if(relationship_columns.empty()) return;
+        copy_columns(rel.relationship_properties_ref(), opts.relationship_properties, relationship_columns, edges.size() - 1);
+    }
+
+    void graph_builder::add(const value_ref& val)
+    {
+        switch(val.get_type()) {
+            case value_type::type_node:
+                add_node(val);
+                break;
+            case value_type::type_relationship:
+                add_relationship(val, val.relationship_start_node_id(), val.relationship_end_node_id());
+                break;
+            case value_type::type_path: {
+                path_view path(val);
+                auto prev = path.start_node().node_id();
+                add_node(path.start_node());
+                for(auto it = path.begin(); it != path.end(); ++it) {
+                    auto next = path.node(it.index() + 1);
+                    add_node(next);
+                    auto step = *it;
+                    auto id = next.node_id();
+                    add_relationship(step.relationship, step.forward ? prev : id, step.forward ? id : prev);
+                    prev = id;
+                }
+                break;
+            }
+            case value_type::type_list: {
+                auto n = val.list_size();
+                for(unsigned int i = 0; i < n; i++) add(val.list_entry(i));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    size_t graph_builder::add(result_stream& stream)
+    {
+        auto n = stream.nfields();
+        size_t rows = 0;
+        while(auto row = stream.fetch_next()) {
+            for(unsigned int i = 0; i < n; i++) add(row.field_ref(i));
+            rows++;
+        }
+        return rows;
+    }
+
+    csr_graph graph_builder::build()
+    {
+        csr_graph g;
+        auto n = node_ids.size();
+        auto m = edges.size();
+        g.offsets.assign(n + 1, 0);
+        for(auto& e : edges) g.offsets[e.source + 1]++;
+        for(size_t i = 0; i < n; i++) g.offsets[i + 1] += g.offsets[i];
+
+        // Counting sort by source, pos[i] is the CSR position of input edge i
+        std::vector<uint32_t> next(g.offsets.begin(), g.offsets.end() - 1);
+        std::vector<uint32_t> pos(m);
+        g.targets.resize(m);
+        g.types.resize(m);
+        g.relationship_ids.resize(m);
+        for(size_t i = 0; i < m; i++) {
+            auto p = next[edges[i].source]++;
+            pos[i] = p;
+            g.targets[p] = edges[i].target;
+            g.types[p] = edges[i].type;
+            g.relationship_ids[p] = relationship_ids[i];
+        }
+        if(opts.incoming) {
+            g.in_offsets.assign(n + 1, 0);
+            for(auto& e : edges) g.in_offsets[e.target + 1]++;
+            for(size_t i = 0; i < n; i++) g.in_offsets[i + 1] += g.in_offsets[i];
+            next.assign(g.in_offsets.begin(), g.in_offsets.end() - 1);
+            g.in_edges.resize(m);
+            for(size_t i = 0; i < m; i++) g.in_edges[next[edges[i].target]++] = pos[i];
+        }
+        for(size_t c = 0; c < relationship_columns.size(); c++) {
+            auto& col = g.relationship_properties[opts.relationship_properties[c]];
+            col.resize(m);
+            for(size_t i = 0; i < m; i++) col[pos[i]] = std::move(relationship_columns[c][i]);
+        }
+        for(size_t c = 0; c < node_columns.size(); c++)
+            g.node_properties[opts.node_properties[c]] = std::move(node_columns[c]);
+        g.node_ids = std::move(node_ids);
+        g.node_index = std::move(node_index);
+        g.type_names.reserve(types.size());
+        for(symbol t = 0; t < types.size(); t++) g.type_names.push_back(types.name(t).str());
+
+        *this = graph_builder(opts);
+        return g;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "../intern.h"
+#include "../exception.h"
+
+namespace neo4j {
+    symbol intern_table::intern(string_ref str)
+    {
+        auto it = index.find(str);
+        if(it != index.end()) return it->second;
+        if(names.size() >= UINT32_MAX) throw exception("intern table is full");
+        strings.emplace_back(str.data(), str.size());
+        string_ref stable(strings.back());
+        auto id = static_cast<symbol>(names.size());
+        names.push_back(stable);
+        index.emplace(stable, id);
+        return id;
+    }
+
+    bool intern_table::find(string_ref str, symbol& res) const noexcept
+    {
+        auto it = index.find(str);
+        if(it == index.end()) return false;
+        res = it->second;
+        return true;
+    }
+
+    string_ref intern_table::name(symbol s) const
+    {
+        if(s >= names.size()) throw exception("unknown symbol");
+        return names[s];
+    }
+
+    label_set intern_table::labels(const value_ref& node)
+    {
+        label_set res;
+        labels(node, res);
+        return res;
+    }
+
+    void intern_table::labels(const value_ref& node, label_set& res)
+    {
+        res.clear();
+        auto n = node.node_label_count();
+        for(unsigned int i = 0; i < n; i++) res.insert(intern(node.node_label(i)));
+    }
+
+    symbol intern_table::type(const value_ref& relationship)
+    {
+        return intern(relationship.relationship_type_ref());
+    }
+
+    symbol intern_table::key(const value_ref& map, unsigned int idx)
+    {
+        return intern(map.map_key(idx));
+    }
+
+    void intern_table::properties(const value_ref& val, std::vector<property_ref>& res)
+    {
+        value_ref map = val;
+        if(val.is_node()) map = val.node_properties_ref();
+        else if(val.is_relationship()) map = val.relationship_properties_ref();
+        else if(!val.is_map()) throw exception("not a map, node or relationship");
+        auto n = map.map_size();
+        res.reserve(res.size() + n);
+        for(unsigned int i = 0; i < n; i++) res.push_back(property_ref{ intern(map.map_key(i)), map.map_value(i) });
+    }
+
+    std::vector<property_ref> intern_table::properties(const value_ref& val)
+    {
+        std::vector<property_ref> res;
+        properties(val, res);
+        return res;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "../join.h"
+#include "../result_stream.h"
+#include "../exception.h"
+
+namespace neo4j {
+    hash_join::hash_join(std::shared_ptr<result_stream> build, unsigned int build_key,
+        std::shared_ptr<result_stream> p, unsigned int pk, join_type t)
+        : probe(std::move(p)), probe_key(pk), type(t), next(table.end()), last(table.end())
+    {
+        if(!build || !probe) throw exception("hash join needs two result streams");
+        auto nbuild = build->nfields();
+        probe_fields = probe->nfields();
+        if(build_key >= nbuild || probe_key >= probe_fields) throw exception("join key column out of range");
+        while(auto row = build->fetch_next()) {
+            if(row.field_ref(build_key).is_null()) continue;
+            std::vector<value> fields;
+            fields.reserve(nbuild);
+            for(unsigned int i = 0; i < nbuild; i++) fields.push_back(row.field_ref(i).to_owned());
+            auto key = fields[build_key];
+            table.emplace(std::move(key), std::move(fields));
+        }
+        next = last = table.end();
+    }
+
+    join_record hash_join::fetch_next()
+    {
+        while(true) {
+            if(next != last) {
+                join_record res;
+                res.probe = current;
+                res.build = next->second;
+                res.valid = true;
+                ++next;
+                return res;
+            }
+            auto row = probe->fetch_next();
+            if(!row) return join_record();
+            // Probe rows are only retained while they are returned
+            current.clear();
+            current.reserve(probe_fields);
+            for(unsigned int i = 0; i < probe_fields; i++) current.push_back(row.field(i));
+            auto& key = current[probe_key];
+            if(key.is_null()) {
+                next = last = table.end();
+            } else {
+                auto range = table.equal_range(key);
+                next = range.first;
+                last = range.second;
+            }
+            if(next == last && type == join_type::left) {
+                join_record res;
+                res.probe = std::move(current);
+                res.valid = true;
+                return res;
+            }
+        }
+    }
+}
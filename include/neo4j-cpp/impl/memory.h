@@ -0,0 +1,145 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cstring>
+#include <cerrno>
+#include "../memory.h"
+
+namespace neo4j {
+    // Stream counter charged by allocations of the current thread
+    static memory_counter*& memory_current_counter() noexcept
+    {
+        static thread_local memory_counter* counter = nullptr;
+        return counter;
+    }
+
+    // Every allocation is prefixed with its size and stream counter
+    struct memory_header {
+        size_t size;
+        memory_counter* counter;
+    };
+    static_assert(sizeof(memory_header) == 16, "allocations must stay 16 byte aligned");
+
+    struct memory_account::hook {
+        struct neo4j_memory_allocator base;
+        memory_account* owner;
+    };
+
+    void memory_counter::add(size_t size) noexcept
+    {
+        auto now = live += size;
+        allocations++;
+        allocated += size;
+        auto p = peak.load(std::memory_order_relaxed);
+        while(now > p && !peak.compare_exchange_weak(p, now, std::memory_order_relaxed)) {}
+    }
+
+    void memory_counter::remove(size_t size) noexcept
+    {
+        live -= size;
+    }
+
+    memory_usage memory_counter::usage() const noexcept
+    {
+        return { live.load(), peak.load(), allocations.load(), allocated.load() };
+    }
+
+    static void* memory_hook_alloc(struct neo4j_memory_allocator* allocator, void* context, size_t size)
+    {
+        return reinterpret_cast<memory_account::hook*>(allocator)->owner->allocate(size, false, context);
+    }
+
+    static void* memory_hook_calloc(struct neo4j_memory_allocator* allocator, void* context, size_t count, size_t size)
+    {
+        if(size != 0 && count > SIZE_MAX / size) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        return reinterpret_cast<memory_account::hook*>(allocator)->owner->allocate(count * size, true, context);
+    }
+
+    static void memory_hook_free(struct neo4j_memory_allocator* allocator, void* ptr)
+    {
+        reinterpret_cast<memory_account::hook*>(allocator)->owner->deallocate(ptr);
+    }
+
+    static void memory_hook_vfree(struct neo4j_memory_allocator* allocator, void** ptrs, size_t n)
+    {
+        auto owner = reinterpret_cast<memory_account::hook*>(allocator)->owner;
+        for(size_t i = 0; i < n; i++) owner->deallocate(ptrs[i]);
+    }
+
+    memory_account::memory_account(const memory_limits& limits, struct neo4j_memory_allocator* alloc)
+        : h(new hook()), lim(limits), inner(alloc != nullptr ? alloc : &neo4j_std_memory_allocator)
+    {
+        h->base.alloc = memory_hook_alloc;
+        h->base.calloc = memory_hook_calloc;
+        h->base.free = memory_hook_free;
+        h->base.vfree = memory_hook_vfree;
+        h->owner = this;
+    }
+
+    memory_account::~memory_account()
+    {}
+
+    struct neo4j_memory_allocator* memory_account::allocator() noexcept
+    {
+        return &h->base;
+    }
+
+    bool memory_account::over_soft_limit(const memory_counter* stream) const noexcept
+    {
+        if(over_soft_limit()) return true;
+        return stream != nullptr && lim.stream_soft != 0 && stream->get_live() > lim.stream_soft;
+    }
+
+    void* memory_account::allocate(size_t size, bool zero, void* context) noexcept
+    {
+        auto counter = memory_current_counter();
+        if((lim.connection_hard != 0 && total.get_live() + size > lim.connection_hard)
+            || (counter != nullptr && lim.stream_hard != 0 && counter->get_live() + size > lim.stream_hard)) {
+            total.refused = true;
+            if(counter != nullptr) counter->refused = true;
+            errno = ENOMEM;
+            return nullptr;
+        }
+        if(size > SIZE_MAX - sizeof(memory_header)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        void* raw = zero ? inner->calloc(inner, context, 1, size + sizeof(memory_header))
+            : inner->alloc(inner, context, size + sizeof(memory_header));
+        if(raw == nullptr) return nullptr;
+        auto hdr = static_cast<memory_header*>(raw);
+        hdr->size = size;
+        hdr->counter = counter;
+        total.add(size);
+        if(counter != nullptr) {
+            counter->retain();
+            counter->add(size);
+        }
+        return hdr + 1;
+    }
+
+    void memory_account::deallocate(void* ptr) noexcept
+    {
+        if(ptr == nullptr) return;
+        auto hdr = static_cast<memory_header*>(ptr) - 1;
+        total.remove(hdr->size);
+        if(hdr->counter != nullptr) {
+            hdr->counter->remove(hdr->size);
+            hdr->counter->release();
+        }
+        inner->free(inner, hdr);
+    }
+
+    memory_account::scope::scope(memory_counter* counter) noexcept
+        : prev(memory_current_counter())
+    {
+        memory_current_counter() = counter;
+    }
+
+    memory_account::scope::~scope()
+    {
+        memory_current_counter() = prev;
+    }
+}
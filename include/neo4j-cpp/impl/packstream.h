@@ -0,0 +1,469 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cstring>
+#include <map>
+#include "../packstream.h"
+#include "../value.h"
+#include "../value_ref.h"
+#include "../exception.h"
+
+namespace neo4j {
+    void packstream_writer::put_be(uint64_t v, size_t bytes)
+    {
+        for(size_t i = bytes; i > 0; i--) put(static_cast<uint8_t>(v >> ((i - 1) * 8)));
+    }
+
+    void packstream_writer::put_size(size_t size, uint8_t tiny, uint8_t m8, uint8_t m16, uint8_t m32)
+    {
+        if(tiny != 0 && size < 16) put(tiny | static_cast<uint8_t>(size));
+        else if(size <= 0xff) { put(m8); put_be(size, 1); }
+        else if(size <= 0xffff) { put(m16); put_be(size, 2); }
+        else if(size <= 0xffffffffull) { put(m32); put_be(size, 4); }
+        else throw exception("packstream value too large");
+    }
+
+    void packstream_writer::write_null()
+    {
+        put(0xC0);
+    }
+
+    void packstream_writer::write_bool(bool b)
+    {
+        put(b ? 0xC3 : 0xC2);
+    }
+
+    void packstream_writer::write_int(int64_t i)
+    {
+        if(i >= -16 && i <= 127) put(static_cast<uint8_t>(i));
+        else if(i >= INT8_MIN && i <= INT8_MAX) { put(0xC8); put_be(static_cast<uint64_t>(i), 1); }
+        else if(i >= INT16_MIN && i <= INT16_MAX) { put(0xC9); put_be(static_cast<uint64_t>(i), 2); }
+        else if(i >= INT32_MIN && i <= INT32_MAX) { put(0xCA); put_be(static_cast<uint64_t>(i), 4); }
+        else { put(0xCB); put_be(static_cast<uint64_t>(i), 8); }
+    }
+
+    void packstream_writer::write_float(double d)
+    {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        put(0xC1);
+        put_be(bits, 8);
+    }
+
+    void packstream_writer::write_string(const char* str, size_t len)
+    {
+        put_size(len, 0x80, 0xD0, 0xD1, 0xD2);
+        buf.insert(buf.end(), str, str + len);
+    }
+
+    void packstream_writer::write_bytes(const void* data, size_t len)
+    {
+        put_size(len, 0, 0xCC, 0xCD, 0xCE);
+        auto p = static_cast<const uint8_t*>(data);
+        buf.insert(buf.end(), p, p + len);
+    }
+
+    void packstream_writer::write_list_header(size_t size)
+    {
+        put_size(size, 0x90, 0xD4, 0xD5, 0xD6);
+    }
+
+    void packstream_writer::write_map_header(size_t size)
+    {
+        put_size(size, 0xA0, 0xD8, 0xD9, 0xDA);
+    }
+
+    void packstream_writer::write_struct_header(size_t fields, uint8_t signature)
+    {
+        if(fields < 16) put(0xB0 | static_cast<uint8_t>(fields));
+        else if(fields <= 0xff) { put(0xDC); put_be(fields, 1); }
+        else if(fields <= 0xffff) { put(0xDD); put_be(fields, 2); }
+        else throw exception("packstream struct too large");
+        put(signature);
+    }
+
+    void packstream_writer::write(const value_ref& val)
+    {
+        switch(val.get_type()) {
+            case value_type::type_null: write_null(); break;
+            case value_type::type_bool: write_bool(val.to_bool()); break;
+            case value_type::type_int: write_int(val.to_int()); break;
+            case value_type::type_float: write_float(val.to_float()); break;
+            case value_type::type_identity: write_int(val.to_identity()); break;
+            case value_type::type_string: {
+                auto str = val.to_string_ref();
+                write_string(str.data(), str.size());
+                break;
+            }
+            case value_type::type_bytes: {
+                auto bytes = val.to_bytes_ref();
+                write_bytes(bytes.data(), bytes.size());
+                break;
+            }
+            case value_type::type_list: {
+                auto len = val.list_size();
+                write_list_header(len);
+                for(unsigned int i = 0; i < len; i++) write(val.list_entry(i));
+                break;
+            }
+            case value_type::type_map: {
+                auto size = val.map_size();
+                write_map_header(size);
+                for(unsigned int i = 0; i < size; i++) {
+                    auto key = val.map_key(i);
+                    write_string(key.data(), key.size());
+                    write(val.map_value(i));
+                }
+                break;
+            }
+            case value_type::type_node: {
+                write_struct_header(3, 0x4E);
+                write_int(val.node_id());
+                auto labels = val.node_labels();
+                write_list_header(labels.size());
+                for(auto& l : labels) write_string(l);
+                auto props = val.node_properties();
+                write_map_header(props.size());
+                for(auto& e : props) {
+                    write_string(e.first);
+                    write(e.second);
+                }
+                break;
+            }
+            case value_type::type_relationship: {
+                write_struct_header(5, 0x52);
+                write_int(val.relationship_id());
+                write_int(val.relationship_start_node_id());
+                write_int(val.relationship_end_node_id());
+                write_string(val.relationship_type());
+                auto props = val.relationship_properties();
+                write_map_header(props.size());
+                for(auto& e : props) {
+                    write_string(e.first);
+                    write(e.second);
+                }
+                break;
+            }
+            case value_type::type_path: {
+                // Bolt path: distinct nodes, distinct unbound relationships and
+                // a sequence of (relationship index, node index) per hop
+                auto len = val.path_length();
+                std::vector<value_ref> nodes, rels;
+                std::map<long long, int64_t> node_idx, rel_idx;
+                std::vector<int64_t> sequence;
+                auto node_index = [&](const value_ref& n) {
+                    auto it = node_idx.find(n.node_id());
+                    if(it != node_idx.end()) return it->second;
+                    nodes.push_back(n);
+                    return node_idx[n.node_id()] = nodes.size() - 1;
+                };
+                node_index(val.path_node(0));
+                for(unsigned int i = 0; i < len; i++) {
+                    bool forward;
+                    auto rel = val.path_relationship(i, forward);
+                    auto it = rel_idx.find(rel.relationship_id());
+                    int64_t idx;
+                    if(it != rel_idx.end()) idx = it->second;
+                    else {
+                        rels.push_back(rel);
+                        idx = rel_idx[rel.relationship_id()] = rels.size();
+                    }
+                    sequence.push_back(forward ? idx : -idx);
+                    sequence.push_back(node_index(val.path_node(i + 1)));
+                }
+                write_struct_header(3, 0x50);
+                write_list_header(nodes.size());
+                for(auto& n : nodes) write(n);
+                write_list_header(rels.size());
+                for(auto& r : rels) {
+                    write_struct_header(3, 0x72);
+                    write_int(r.relationship_id());
+                    write_string(r.relationship_type());
+                    auto props = r.relationship_properties();
+                    write_map_header(props.size());
+                    for(auto& e : props) {
+                        write_string(e.first);
+                        write(e.second);
+                    }
+                }
+                write_list_header(sequence.size());
+                for(auto s : sequence) write_int(s);
+                break;
+            }
+            default: throw exception("unsupported value type");
+        }
+    }
+
+    uint8_t packstream_reader::get()
+    {
+        if(ptr == end) throw exception("malformed packstream: unexpected end of data");
+        return *ptr++;
+    }
+
+    uint64_t packstream_reader::get_be(size_t bytes)
+    {
+        if(remaining() < bytes) throw exception("malformed packstream: unexpected end of data");
+        uint64_t res = 0;
+        for(size_t i = 0; i < bytes; i++) res = (res << 8) | *ptr++;
+        return res;
+    }
+
+    const uint8_t* packstream_reader::take(size_t len)
+    {
+        if(remaining() < len) throw exception("malformed packstream: unexpected end of data");
+        auto res = ptr;
+        ptr += len;
+        return res;
+    }
+
+    packstream_reader::marker packstream_reader::peek() const
+    {
+        if(ptr == end) return marker::invalid;
+        uint8_t m = *ptr;
+        if(m < 0x80 || m >= 0xF0) return marker::integer;
+        switch(m & 0xF0) {
+            case 0x80: return marker::string;
+            case 0x90: return marker::list;
+            case 0xA0: return marker::map;
+            case 0xB0: return marker::structure;
+        }
+        switch(m) {
+            case 0xC0: return marker::null;
+            case 0xC1: return marker::floating;
+            case 0xC2: case 0xC3: return marker::boolean;
+            case 0xC8: case 0xC9: case 0xCA: case 0xCB: return marker::integer;
+            case 0xCC: case 0xCD: case 0xCE: return marker::bytes;
+            case 0xD0: case 0xD1: case 0xD2: return marker::string;
+            case 0xD4: case 0xD5: case 0xD6: return marker::list;
+            case 0xD8: case 0xD9: case 0xDA: return marker::map;
+            case 0xDC: case 0xDD: return marker::structure;
+            default: return marker::invalid;
+        }
+    }
+
+    void packstream_reader::read_null()
+    {
+        if(get() != 0xC0) throw exception("malformed packstream: expected null");
+    }
+
+    bool packstream_reader::read_bool()
+    {
+        auto m = get();
+        if(m == 0xC2) return false;
+        if(m == 0xC3) return true;
+        throw exception("malformed packstream: expected bool");
+    }
+
+    int64_t packstream_reader::read_int()
+    {
+        auto m = get();
+        if(m < 0x80) return m;
+        if(m >= 0xF0) return static_cast<int8_t>(m);
+        switch(m) {
+            case 0xC8: return static_cast<int8_t>(get_be(1));
+            case 0xC9: return static_cast<int16_t>(get_be(2));
+            case 0xCA: return static_cast<int32_t>(get_be(4));
+            case 0xCB: return static_cast<int64_t>(get_be(8));
+            default: throw exception("malformed packstream: expected int");
+        }
+    }
+
+    double packstream_reader::read_float()
+    {
+        if(get() != 0xC1) throw exception("malformed packstream: expected float");
+        uint64_t bits = get_be(8);
+        double res;
+        memcpy(&res, &bits, sizeof(res));
+        return res;
+    }
+
+    const char* packstream_reader::read_string(size_t& len)
+    {
+        auto m = get();
+        if((m & 0xF0) == 0x80) len = m & 0x0F;
+        else if(m == 0xD0) len = get_be(1);
+        else if(m == 0xD1) len = get_be(2);
+        else if(m == 0xD2) len = get_be(4);
+        else throw exception("malformed packstream: expected string");
+        return reinterpret_cast<const char*>(take(len));
+    }
+
+    std::string packstream_reader::read_string()
+    {
+        size_t len;
+        auto str = read_string(len);
+        return std::string(str, len);
+    }
+
+    const uint8_t* packstream_reader::read_bytes(size_t& len)
+    {
+        auto m = get();
+        if(m == 0xCC) len = get_be(1);
+        else if(m == 0xCD) len = get_be(2);
+        else if(m == 0xCE) len = get_be(4);
+        else throw exception("malformed packstream: expected bytes");
+        return take(len);
+    }
+
+    size_t packstream_reader::read_list_header()
+    {
+        auto m = get();
+        if((m & 0xF0) == 0x90) return m & 0x0F;
+        if(m == 0xD4) return get_be(1);
+        if(m == 0xD5) return get_be(2);
+        if(m == 0xD6) return get_be(4);
+        throw exception("malformed packstream: expected list");
+    }
+
+    size_t packstream_reader::read_map_header()
+    {
+        auto m = get();
+        if((m & 0xF0) == 0xA0) return m & 0x0F;
+        if(m == 0xD8) return get_be(1);
+        if(m == 0xD9) return get_be(2);
+        if(m == 0xDA) return get_be(4);
+        throw exception("malformed packstream: expected map");
+    }
+
+    size_t packstream_reader::read_struct_header(uint8_t& signature)
+    {
+        auto m = get();
+        size_t res;
+        if((m & 0xF0) == 0xB0) res = m & 0x0F;
+        else if(m == 0xDC) res = get_be(1);
+        else if(m == 0xDD) res = get_be(2);
+        else throw exception("malformed packstream: expected struct");
+        signature = get();
+        return res;
+    }
+
+    void packstream_reader::skip()
+    {
+        size_t len;
+        switch(peek()) {
+            case marker::null: read_null(); break;
+            case marker::boolean: read_bool(); break;
+            case marker::integer: read_int(); break;
+            case marker::floating: read_float(); break;
+            case marker::string: read_string(len); break;
+            case marker::bytes: read_bytes(len); break;
+            case marker::list: {
+                auto n = read_list_header();
+                for(size_t i = 0; i < n; i++) skip();
+                break;
+            }
+            case marker::map: {
+                auto n = read_map_header();
+                for(size_t i = 0; i < n * 2; i++) skip();
+                break;
+            }
+            case marker::structure: {
+                uint8_t sig;
+                auto n = read_struct_header(sig);
+                for(size_t i = 0; i < n; i++) skip();
+                break;
+            }
+            default: throw exception("malformed packstream: invalid marker");
+        }
+    }
+
+    value packstream_reader::read_path()
+    {
+        auto nodes = read_value();
+        if(!nodes.is_list() || nodes.list_size() == 0) throw exception("malformed packstream: path without nodes");
+        struct unbound {
+            int64_t id;
+            value type, props;
+        };
+        std::vector<unbound> unbound_rels(read_list_header());
+        for(auto& r : unbound_rels) {
+            uint8_t sig;
+            if(read_struct_header(sig) != 3 || sig != 0x72) throw exception("malformed packstream: expected unbound relationship");
+            r.id = read_int();
+            r.type = read_value();
+            r.props = read_value();
+        }
+        auto sequence = read_value();
+        if(!sequence.is_list() || sequence.list_size() % 2 != 0) throw exception("malformed packstream: invalid path sequence");
+        // Bound again from the sequence, so every relationship of the path knows its nodes
+        std::vector<value> rels(unbound_rels.size());
+        auto prev = nodes.list_entry(0).node_id();
+        for(unsigned int i = 0; i < sequence.list_size(); i += 2) {
+            auto rel = sequence.list_entry(i).to_int();
+            auto node = sequence.list_entry(i + 1).to_int();
+            if(rel == 0 || static_cast<size_t>(rel < 0 ? -rel : rel) > rels.size()
+                || node < 0 || static_cast<unsigned long long>(node) >= nodes.list_size()) throw exception("malformed packstream: invalid path sequence");
+            auto next = nodes.list_entry(node).node_id();
+            auto idx = (rel < 0 ? -rel : rel) - 1;
+            if(rels[idx].is_null()) {
+                auto& r = unbound_rels[idx];
+                rels[idx] = value::from_struct(value_type::type_relationship, {
+                    value(nullptr, neo4j_identity(r.id)), value(nullptr, neo4j_identity(rel > 0 ? prev : next)),
+                    value(nullptr, neo4j_identity(rel > 0 ? next : prev)), std::move(r.type), std::move(r.props)
+                });
+            }
+            prev = next;
+        }
+        for(auto& r : rels) {
+            if(r.is_null()) throw exception("malformed packstream: relationship not part of the path");
+        }
+        return value::from_struct(value_type::type_path, { std::move(nodes), value(std::move(rels)), std::move(sequence) });
+    }
+
+    value packstream_reader::read_value()
+    {
+        switch(peek()) {
+            case marker::null: read_null(); return value();
+            case marker::boolean: return value(read_bool());
+            case marker::integer: return value(static_cast<long long>(read_int()));
+            case marker::floating: return value(read_float());
+            case marker::string: return value(read_string());
+            case marker::bytes: {
+                size_t len;
+                auto ptr = read_bytes(len);
+                return value(std::vector<uint8_t>(ptr, ptr + len));
+            }
+            case marker::list: {
+                list_builder builder;
+                auto n = read_list_header();
+                builder.reserve(n);
+                for(size_t i = 0; i < n; i++) builder.push_back(read_value());
+                return builder.build();
+            }
+            case marker::map: {
+                map_builder builder;
+                auto n = read_map_header();
+                for(size_t i = 0; i < n; i++) {
+                    auto key = read_string();
+                    builder.set(key, read_value());
+                }
+                return builder.build();
+            }
+            case marker::structure: {
+                uint8_t sig;
+                auto n = read_struct_header(sig);
+                if(sig == 0x4E && n == 3) {
+                    auto id = read_int();
+                    auto labels = read_value();
+                    auto props = read_value();
+                    return value::from_struct(value_type::type_node, {
+                        value(nullptr, neo4j_identity(id)), std::move(labels), std::move(props)
+                    });
+                }
+                if(sig == 0x52 && n == 5) {
+                    auto id = read_int();
+                    auto start = read_int();
+                    auto end = read_int();
+                    auto type = read_value();
+                    auto props = read_value();
+                    return value::from_struct(value_type::type_relationship, {
+                        value(nullptr, neo4j_identity(id)), value(nullptr, neo4j_identity(start)),
+                        value(nullptr, neo4j_identity(end)), std::move(type), std::move(props)
+                    });
+                }
+                if(sig == 0x50 && n == 3) return read_path();
+                throw exception("packstream structure not supported");
+            }
+            default: throw exception("malformed packstream: invalid marker");
+        }
+    }
+}
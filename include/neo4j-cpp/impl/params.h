@@ -0,0 +1,129 @@
+#pragma once
+#include <neo4j-client.h>
+#include <deque>
+#include "../params.h"
+#include "../exception.h"
+
+namespace neo4j {
+    struct parameters::storage {
+        std::vector<neo4j_map_entry_t> entries;
+        // Deques keep the addresses of keys and encoded lists stable
+        std::deque<std::string> keys;
+        std::deque<std::vector<neo4j_value_t>> lists;
+    };
+
+    parameters::parameters()
+        : s(new storage())
+    {}
+
+    parameters::parameters(parameters&&) noexcept = default;
+    parameters& parameters::operator=(parameters&&) noexcept = default;
+    parameters::~parameters() = default;
+
+    size_t parameters::entry(string_ref key)
+    {
+        for(size_t i = 0; i < s->entries.size(); i++) {
+            auto& k = s->entries[i].key;
+            if(neo4j_string_length(k) == key.size() && memcmp(neo4j_ustring_value(k), key.data(), key.size()) == 0) return i;
+        }
+        s->keys.emplace_back(key.data(), key.size());
+        auto& k = s->keys.back();
+        neo4j_map_entry_t e;
+        e.key = neo4j_ustring(k.data(), k.size());
+        e.value = neo4j_null;
+        s->entries.push_back(e);
+        return s->entries.size() - 1;
+    }
+
+    size_t parameters::open_list(string_ref key, size_t n)
+    {
+        if(n > UINT32_MAX) throw exception("parameter list too long");
+        auto idx = entry(key);
+        s->lists.emplace_back(n, neo4j_null);
+        auto& items = s->lists.back();
+        s->entries[idx].value = neo4j_list(items.data(), n);
+        return s->lists.size() - 1;
+    }
+
+    void parameters::put(size_t list, size_t idx, long long v)
+    {
+        s->lists[list][idx] = neo4j_int(v);
+    }
+
+    void parameters::put(size_t list, size_t idx, double v)
+    {
+        s->lists[list][idx] = neo4j_float(v);
+    }
+
+    void parameters::put(size_t list, size_t idx, bool v)
+    {
+        s->lists[list][idx] = neo4j_bool(v);
+    }
+
+    void parameters::put(size_t list, size_t idx, string_ref v)
+    {
+        s->lists[list][idx] = neo4j_ustring(v.data(), v.size());
+    }
+
+    void parameters::put(size_t list, size_t idx, const value& v)
+    {
+        s->lists[list][idx] = v.get_value();
+    }
+
+    parameters& parameters::set_null(string_ref key)
+    {
+        s->entries[entry(key)].value = neo4j_null;
+        return *this;
+    }
+
+    parameters& parameters::set(string_ref key, bool v)
+    {
+        s->entries[entry(key)].value = neo4j_bool(v);
+        return *this;
+    }
+
+    parameters& parameters::set(string_ref key, long long v)
+    {
+        s->entries[entry(key)].value = neo4j_int(v);
+        return *this;
+    }
+
+    parameters& parameters::set(string_ref key, double v)
+    {
+        s->entries[entry(key)].value = neo4j_float(v);
+        return *this;
+    }
+
+    parameters& parameters::set(string_ref key, string_ref v)
+    {
+        s->entries[entry(key)].value = neo4j_ustring(v.data(), v.size());
+        return *this;
+    }
+
+    parameters& parameters::set_bytes(string_ref key, const uint8_t* data, size_t len)
+    {
+        s->entries[entry(key)].value = neo4j_bytes(reinterpret_cast<const char*>(data), len);
+        return *this;
+    }
+
+    parameters& parameters::set(string_ref key, const value& v)
+    {
+        s->entries[entry(key)].value = v.get_value();
+        return *this;
+    }
+
+    size_t parameters::size() const noexcept
+    {
+        return s->entries.size();
+    }
+
+    struct neo4j_value parameters::get_value() const
+    {
+        return neo4j_map(s->entries.data(), s->entries.size());
+    }
+
+    value_ref parameters::ref() const
+    {
+        return value_ref(nullptr, get_value());
+    }
+}
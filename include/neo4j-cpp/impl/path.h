@@ -0,0 +1,33 @@
+#pragma once
+#include <neo4j-client.h>
+#include "../path.h"
+#include "../exception.h"
+
+namespace neo4j {
+    path_view::path_view(const value_ref& val)
+        : path(val)
+    {
+        if(!val.is_path()) throw exception("not a path");
+        len = neo4j_path_length(val.get_value());
+    }
+
+    value_ref path_view::node(unsigned int hop) const
+    {
+        if(hop > len) throw exception("path index out of range");
+        return value_ref(path.get_result(), neo4j_path_get_node(path.get_value(), hop));
+    }
+
+    value_ref path_view::relationship(unsigned int hop, bool& forward) const
+    {
+        if(hop >= len) throw exception("path index out of range");
+        return value_ref(path.get_result(), neo4j_path_get_relationship(path.get_value(), hop, &forward));
+    }
+
+    path_view::step path_view::operator[](unsigned int hop) const
+    {
+        step res;
+        res.node = node(hop);
+        res.relationship = relationship(hop, res.forward);
+        return res;
+    }
+}
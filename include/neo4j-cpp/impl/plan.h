@@ -0,0 +1,82 @@
+#pragma once
+#include <neo4j-client.h>
+#include <algorithm>
+#include "../plan.h"
+
+namespace neo4j {
+    static plan_step plan_step_from_native(const struct neo4j_statement_execution_step* step)
+    {
+        plan_step res;
+        if(step->operator_type != nullptr) res.operator_type = step->operator_type;
+        for(unsigned int i = 0; i < step->nidentifiers; i++) res.identifiers.push_back(step->identifiers[i]);
+        res.estimated_rows = step->estimated_rows;
+        res.rows = step->rows;
+        res.db_hits = step->db_hits;
+        res.page_cache_hits = step->page_cache_hits;
+        res.page_cache_misses = step->page_cache_misses;
+        res.sources.reserve(step->nsources);
+        for(unsigned int i = 0; i < step->nsources; i++) res.sources.push_back(plan_step_from_native(step->sources[i]));
+        return res;
+    }
+
+    statement_plan statement_plan::from_native(const struct neo4j_statement_plan* plan)
+    {
+        statement_plan res;
+        res.version = plan->version;
+        if(plan->planner != nullptr) res.planner = plan->planner;
+        if(plan->runtime != nullptr) res.runtime = plan->runtime;
+        res.is_profile = plan->is_profile;
+        res.output_step = plan_step_from_native(plan->output_step);
+        return res;
+    }
+
+    static void collect_plan_steps(const plan_step& step, std::vector<const plan_step*>& out)
+    {
+        out.push_back(&step);
+        for(auto& s : step.sources) collect_plan_steps(s, out);
+    }
+
+    std::vector<const plan_step*> costliest_operators(const statement_plan& plan, size_t count)
+    {
+        std::vector<const plan_step*> res;
+        collect_plan_steps(plan.output_step, res);
+        auto cmp = [&plan](const plan_step* a, const plan_step* b) {
+            if(plan.is_profile && a->db_hits != b->db_hits) return a->db_hits > b->db_hits;
+            return a->estimated_rows > b->estimated_rows;
+        };
+        count = std::min(count, res.size());
+        std::partial_sort(res.begin(), res.begin() + count, res.end(), cmp);
+        res.resize(count);
+        return res;
+    }
+
+    static void plan_step_to_string(const plan_step& step, bool profile, size_t depth, std::string& out)
+    {
+        out.append(depth * 2, ' ');
+        out += step.operator_type;
+        out += " (estimated rows: " + std::to_string(step.estimated_rows);
+        if(profile) {
+            out += ", rows: " + std::to_string(step.rows);
+            out += ", db hits: " + std::to_string(step.db_hits);
+        }
+        out += ")";
+        if(!step.identifiers.empty()) {
+            out += " [";
+            for(size_t i = 0; i < step.identifiers.size(); i++) {
+                if(i != 0) out += ", ";
+                out += step.identifiers[i];
+            }
+            out += "]";
+        }
+        out += "\n";
+        for(auto& s : step.sources) plan_step_to_string(s, profile, depth + 1, out);
+    }
+
+    std::string to_string(const statement_plan& plan)
+    {
+        std::string res = (plan.is_profile ? "profile" : "plan");
+        res += " (planner: " + plan.planner + ", runtime: " + plan.runtime + ")\n";
+        plan_step_to_string(plan.output_step, plan.is_profile, 1, res);
+        return res;
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <neo4j-client.h>
+#include "../pool.h"
+#include "../config.h"
+#include "../connection.h"
+#include "../exception.h"
+#include "../tuning.h"
+
+namespace neo4j {
+    connection_pool::connection_pool(const std::string& puri, connect_flags pflags, size_t pmax)
+        : connection_pool(puri, shared_config(), pflags, pmax)
+    {}
+
+    connection_pool::connection_pool(const std::string& puri, const config& conf, connect_flags pflags, size_t pmax)
+        : connection_pool(puri, conf.freeze(), pflags, pmax)
+    {}
+
+    connection_pool::connection_pool(const std::string& puri, shared_config conf, connect_flags pflags, size_t pmax)
+        : uri(puri), cfg(std::move(conf)), flags(pflags), max_size(pmax)
+    {}
+
+    connection_pool::~connection_pool()
+    {}
+
+    void connection_pool::set_buffer_tuner(std::shared_ptr<buffer_tuner> t)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        tuner = std::move(t);
+    }
+
+    std::shared_ptr<buffer_tuner> connection_pool::get_buffer_tuner() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return tuner;
+    }
+
+    std::shared_ptr<connection> connection_pool::acquire()
+    {
+        std::shared_ptr<buffer_tuner> t;
+        // Closed after the lock is released
+        std::vector<std::shared_ptr<connection>> closing;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            // Only acquire() copies pooled pointers, so a use count of one can't change under the lock
+            for(auto it = conns.begin(); it != conns.end();) {
+                if(*it == nullptr || it->use_count() != 1) {
+                    ++it;
+                    continue;
+                }
+                if(!(*it)->is_aborted()) return *it;
+                // A deadline cut its session short
+                closing.push_back(std::move(*it));
+                it = conns.erase(it);
+            }
+            if(conns.size() >= max_size) throw exception("connection pool for " + uri + " exhausted");
+            // Reserve the slot while connecting without the lock
+            conns.push_back(nullptr);
+            t = tuner;
+        }
+        std::shared_ptr<connection> con;
+        try {
+            if(t) {
+                // The tuned sizes change over time, so these get their own config
+                config tuned = cfg ? *cfg : config();
+                t->apply(tuned);
+                con = std::make_shared<connection>(uri, tuned, flags);
+            } else con = std::make_shared<connection>(uri, cfg, flags);
+        } catch(...) {
+            std::lock_guard<std::mutex> lck(mtx);
+            for(auto it = conns.begin(); it != conns.end(); ++it) {
+                if(*it == nullptr) {
+                    conns.erase(it);
+                    break;
+                }
+            }
+            throw;
+        }
+        std::lock_guard<std::mutex> lck(mtx);
+        for(auto& c : conns) {
+            if(c == nullptr) {
+                c = con;
+                break;
+            }
+        }
+        return con;
+    }
+
+    size_t connection_pool::size() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return conns.size();
+    }
+
+    size_t connection_pool::in_use() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        size_t res = 0;
+        for(auto& c : conns) {
+            if(c == nullptr || c.use_count() > 1) res++;
+        }
+        return res;
+    }
+
+    size_t connection_pool::idle() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        size_t res = 0;
+        for(auto& c : conns) {
+            if(c != nullptr && c.use_count() == 1) res++;
+        }
+        return res;
+    }
+
+    void connection_pool::clear_idle()
+    {
+        std::vector<std::shared_ptr<connection>> closing;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            for(auto it = conns.begin(); it != conns.end();) {
+                if(*it != nullptr && it->use_count() == 1) {
+                    closing.push_back(std::move(*it));
+                    it = conns.erase(it);
+                } else ++it;
+            }
+        }
+    }
+
+    void connection_pool::discard(const std::shared_ptr<connection>& con)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        for(auto it = conns.begin(); it != conns.end(); ++it) {
+            if(*it == con) {
+                conns.erase(it);
+                break;
+            }
+        }
+    }
+}
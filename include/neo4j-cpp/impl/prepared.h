@@ -0,0 +1,105 @@
+#pragma once
+#include "../prepared.h"
+#include "../connection.h"
+#include "../pool.h"
+#include "../result_stream.h"
+#include "../exception.h"
+
+namespace neo4j {
+    static const std::vector<std::string>& prepared_no_fields()
+    {
+        static const std::vector<std::string> none;
+        return none;
+    }
+
+    prepared_statement::prepared_statement(std::string query, bool v)
+        : text(std::make_shared<const std::string>(std::move(query))), validate(v)
+    {}
+
+    void prepared_statement::capture(result_stream& stream)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if(ready) return;
+        auto n = stream.nfields();
+        if(stream.failure()) return;
+        std::vector<std::string> res;
+        res.reserve(n);
+        for(unsigned int i = 0; i < n; i++) res.push_back(stream.fieldname(i));
+        fields = std::move(res);
+        ready = true;
+    }
+
+    void prepared_statement::check(result_stream& stream) const
+    {
+        // Failed statements report their error when fetching
+        auto n = stream.nfields();
+        if(n != fields.size()) {
+            if(stream.failure()) return;
+            throw exception("statement schema changed: expected " + std::to_string(fields.size()) + " columns, got " + std::to_string(n));
+        }
+        for(unsigned int i = 0; i < n; i++) {
+            if(stream.fieldname_ref(i) != string_ref(fields[i])) throw exception("statement schema changed: column " + std::to_string(i) + " is now " + stream.fieldname_ref(i).str());
+        }
+    }
+
+    void prepared_statement::prepare(connection& con, const value& params)
+    {
+        if(has_type()) return;
+        auto stream = con.run("EXPLAIN " + *text, params);
+        auto err = stream->failure();
+        if(err) throw exception("preparing statement failed: " + err.message());
+        auto type = stream->type();
+        std::lock_guard<std::mutex> lck(mtx);
+        if(ready) {
+            // Captured by a concurrent run, which may already be reading fields
+            check(*stream);
+        } else {
+            auto n = stream->nfields();
+            fields.reserve(n);
+            for(unsigned int i = 0; i < n; i++) fields.push_back(stream->fieldname(i));
+        }
+        stype = type;
+        type_known = true;
+        ready = true;
+    }
+
+    std::shared_ptr<result_stream> prepared_statement::run(connection& con, const value& params)
+    {
+        auto stream = std::make_shared<result_stream>(con.shared_from_this(), true, text, params);
+        if(!ready) capture(*stream);
+        else if(validate) check(*stream);
+        return stream;
+    }
+
+    std::shared_ptr<result_stream> prepared_statement::run(connection_pool& pool, const value& params)
+    {
+        // The stream keeps the pooled connection busy until it is released
+        return run(*pool.acquire(), params);
+    }
+
+    std::shared_ptr<result_stream> prepared_statement::send(connection& con, const value& params)
+    {
+        return std::make_shared<result_stream>(con.shared_from_this(), false, text, params);
+    }
+
+    const std::vector<std::string>& prepared_statement::fieldnames() const noexcept
+    {
+        if(!ready) return prepared_no_fields();
+        return fields;
+    }
+
+    unsigned int prepared_statement::column(string_ref name) const
+    {
+        if(!ready) throw exception("statement schema not captured yet");
+        for(size_t i = 0; i < fields.size(); i++) {
+            if(string_ref(fields[i]) == name) return static_cast<unsigned int>(i);
+        }
+        throw exception("no column named " + name.str());
+    }
+
+    statement_type prepared_statement::type() const
+    {
+        if(!has_type()) throw exception("statement type unknown, call prepare() first");
+        return stype;
+    }
+}
@@ -0,0 +1,421 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../replay.h"
+#include "../packstream.h"
+#include "../exception.h"
+
+namespace neo4j {
+    // Capture format: "NEO4JREC" followed by a little endian uint32 version,
+    // then events of uint32 session, uint8 direction, uint64 nanoseconds
+    // since the session connected, uint32 length and the bytes.
+    static const char replay_magic[8] = {'N', 'E', 'O', '4', 'J', 'R', 'E', 'C'};
+    static const uint32_t replay_version = 1;
+    enum : uint8_t {
+        replay_to_server = 0,
+        replay_to_client = 1
+    };
+
+    static void replay_put_le(std::vector<uint8_t>& buf, uint64_t v, size_t bytes)
+    {
+        for(size_t i = 0; i < bytes; i++) buf.push_back(static_cast<uint8_t>(v >> (i * 8)));
+    }
+
+    static uint64_t replay_get_le(const uint8_t* p, size_t bytes)
+    {
+        uint64_t res = 0;
+        for(size_t i = 0; i < bytes; i++) res |= static_cast<uint64_t>(p[i]) << (i * 8);
+        return res;
+    }
+
+    struct recording_factory_base {
+        struct neo4j_connection_factory base;
+        recording_connection_factory::state* owner;
+    };
+
+    struct recording_connection_factory::state {
+        recording_factory_base factory;
+        struct neo4j_connection_factory* inner;
+        std::mutex mtx;
+        FILE* file;
+        std::vector<uint8_t> buf;
+        std::atomic<uint32_t> next_session{0};
+        std::atomic<unsigned long long> sent{0};
+        std::atomic<unsigned long long> received{0};
+
+        void record(uint32_t session, uint8_t direction, std::chrono::steady_clock::time_point start, const void* data, size_t len) {
+            if(len == 0) return;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            (direction == replay_to_server ? sent : received) += len;
+            std::lock_guard<std::mutex> lck(mtx);
+            buf.clear();
+            replay_put_le(buf, session, 4);
+            buf.push_back(direction);
+            replay_put_le(buf, static_cast<uint64_t>(ns), 8);
+            replay_put_le(buf, len, 4);
+            fwrite(buf.data(), 1, buf.size(), file);
+            fwrite(data, 1, len, file);
+        }
+    };
+
+    struct recording_stream {
+        struct neo4j_iostream base;
+        struct neo4j_iostream* inner;
+        recording_connection_factory::state* owner;
+        uint32_t session;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static void recording_iov(recording_stream* s, uint8_t direction, const struct iovec* iov, unsigned int iovcnt, ssize_t total)
+    {
+        for(unsigned int i = 0; i < iovcnt && total > 0; i++) {
+            size_t n = std::min<size_t>(iov[i].iov_len, static_cast<size_t>(total));
+            s->owner->record(s->session, direction, s->start, iov[i].iov_base, n);
+            total -= n;
+        }
+    }
+
+    static ssize_t recording_read(struct neo4j_iostream* self, void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        auto res = s->inner->read(s->inner, buf, nbyte);
+        if(res > 0) s->owner->record(s->session, replay_to_client, s->start, buf, res);
+        return res;
+    }
+
+    static ssize_t recording_readv(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        auto res = s->inner->readv(s->inner, iov, iovcnt);
+        recording_iov(s, replay_to_client, iov, iovcnt, res);
+        return res;
+    }
+
+    static ssize_t recording_write(struct neo4j_iostream* self, const void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        auto res = s->inner->write(s->inner, buf, nbyte);
+        if(res > 0) s->owner->record(s->session, replay_to_server, s->start, buf, res);
+        return res;
+    }
+
+    static ssize_t recording_writev(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        auto res = s->inner->writev(s->inner, iov, iovcnt);
+        recording_iov(s, replay_to_server, iov, iovcnt, res);
+        return res;
+    }
+
+    static int recording_flush(struct neo4j_iostream* self)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        return s->inner->flush(s->inner);
+    }
+
+    static int recording_close(struct neo4j_iostream* self)
+    {
+        auto s = reinterpret_cast<recording_stream*>(self);
+        int res = s->inner->close(s->inner);
+        delete s;
+        return res;
+    }
+
+    static struct neo4j_iostream* recording_connect(struct neo4j_connection_factory* factory, const char* hostname,
+        unsigned int port, neo4j_config_t* config, uint_fast32_t flags, struct neo4j_logger* logger)
+    {
+        auto owner = reinterpret_cast<recording_factory_base*>(factory)->owner;
+        auto inner = owner->inner->tcp_connect(owner->inner, hostname, port, config, flags, logger);
+        if(inner == nullptr) return nullptr;
+        auto s = new (std::nothrow) recording_stream();
+        if(s == nullptr) {
+            inner->close(inner);
+            errno = ENOMEM;
+            return nullptr;
+        }
+        s->base.read = recording_read;
+        s->base.readv = recording_readv;
+        s->base.write = recording_write;
+        s->base.writev = recording_writev;
+        s->base.flush = recording_flush;
+        s->base.close = recording_close;
+        s->inner = inner;
+        s->owner = owner;
+        s->session = owner->next_session++;
+        s->start = std::chrono::steady_clock::now();
+        return &s->base;
+    }
+
+    recording_connection_factory::recording_connection_factory(const std::string& path, struct neo4j_connection_factory* inner)
+        : st(new state())
+    {
+        st->factory.base.tcp_connect = recording_connect;
+        st->factory.owner = st.get();
+        st->inner = inner != nullptr ? inner : &neo4j_std_connection_factory;
+        st->file = fopen(path.c_str(), "wb");
+        if(st->file == nullptr) throw exception("failed to open " + path + ": " + strerror(errno));
+        std::vector<uint8_t> header(replay_magic, replay_magic + sizeof(replay_magic));
+        replay_put_le(header, replay_version, 4);
+        fwrite(header.data(), 1, header.size(), st->file);
+    }
+
+    recording_connection_factory::~recording_connection_factory()
+    {
+        fclose(st->file);
+    }
+
+    struct neo4j_connection_factory* recording_connection_factory::get() const noexcept
+    {
+        return &st->factory.base;
+    }
+
+    size_t recording_connection_factory::sessions() const noexcept
+    {
+        return st->next_session;
+    }
+
+    unsigned long long recording_connection_factory::bytes_sent() const noexcept
+    {
+        return st->sent;
+    }
+
+    unsigned long long recording_connection_factory::bytes_received() const noexcept
+    {
+        return st->received;
+    }
+
+    void recording_connection_factory::flush()
+    {
+        std::lock_guard<std::mutex> lck(st->mtx);
+        if(fflush(st->file) != 0) throw exception(std::string("failed to flush capture: ") + strerror(errno));
+    }
+
+    struct replay_factory_base {
+        struct neo4j_connection_factory base;
+        replay_connection_factory::state* owner;
+    };
+
+    struct replay_connection_factory::state {
+        struct chunk {
+            std::chrono::nanoseconds offset;
+            size_t begin;
+            size_t end;
+        };
+        struct session {
+            // Server bytes, split into the reads they were recorded as
+            std::vector<uint8_t> data;
+            std::vector<chunk> chunks;
+            std::vector<uint8_t> sent;
+        };
+
+        replay_factory_base factory;
+        pacing mode;
+        std::vector<session> sessions;
+        unsigned long long total = 0;
+        std::atomic<size_t> next_session{0};
+        std::atomic<unsigned long long> replayed{0};
+    };
+
+    struct replay_stream {
+        struct neo4j_iostream base;
+        replay_connection_factory::state* owner;
+        const replay_connection_factory::state::session* session;
+        size_t chunk;
+        size_t offset;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static ssize_t replay_read(struct neo4j_iostream* self, void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<replay_stream*>(self);
+        auto& chunks = s->session->chunks;
+        auto out = static_cast<uint8_t*>(buf);
+        size_t done = 0;
+        while(done < nbyte && s->chunk < chunks.size()) {
+            auto& c = chunks[s->chunk];
+            if(s->owner->mode == replay_connection_factory::pacing::recorded) {
+                // Return what we have rather than waiting for the next chunk
+                if(done > 0 && s->offset == c.begin) break;
+                std::this_thread::sleep_until(s->start + c.offset);
+            }
+            size_t n = std::min(nbyte - done, c.end - s->offset);
+            memcpy(out + done, s->session->data.data() + s->offset, n);
+            done += n;
+            s->offset += n;
+            if(s->offset == c.end) {
+                s->chunk++;
+                if(s->chunk < chunks.size()) s->offset = chunks[s->chunk].begin;
+            }
+        }
+        s->owner->replayed += done;
+        return done;
+    }
+
+    static ssize_t replay_readv(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        ssize_t total = 0;
+        for(unsigned int i = 0; i < iovcnt; i++) {
+            auto res = replay_read(self, iov[i].iov_base, iov[i].iov_len);
+            total += res;
+            if(static_cast<size_t>(res) < iov[i].iov_len) break;
+        }
+        return total;
+    }
+
+    static ssize_t replay_write(struct neo4j_iostream*, const void*, size_t nbyte)
+    {
+        return nbyte;
+    }
+
+    static ssize_t replay_writev(struct neo4j_iostream*, const struct iovec* iov, unsigned int iovcnt)
+    {
+        ssize_t total = 0;
+        for(unsigned int i = 0; i < iovcnt; i++) total += iov[i].iov_len;
+        return total;
+    }
+
+    static int replay_flush(struct neo4j_iostream*)
+    {
+        return 0;
+    }
+
+    static int replay_close(struct neo4j_iostream* self)
+    {
+        delete reinterpret_cast<replay_stream*>(self);
+        return 0;
+    }
+
+    static struct neo4j_iostream* replay_connect(struct neo4j_connection_factory* factory, const char*,
+        unsigned int, neo4j_config_t*, uint_fast32_t, struct neo4j_logger*)
+    {
+        auto owner = reinterpret_cast<replay_factory_base*>(factory)->owner;
+        auto idx = owner->next_session++;
+        if(idx >= owner->sessions.size()) {
+            errno = ECONNREFUSED;
+            return nullptr;
+        }
+        auto s = new (std::nothrow) replay_stream();
+        if(s == nullptr) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        s->base.read = replay_read;
+        s->base.readv = replay_readv;
+        s->base.write = replay_write;
+        s->base.writev = replay_writev;
+        s->base.flush = replay_flush;
+        s->base.close = replay_close;
+        s->owner = owner;
+        s->session = &owner->sessions[idx];
+        s->chunk = 0;
+        s->offset = 0;
+        s->start = std::chrono::steady_clock::now();
+        return &s->base;
+    }
+
+    replay_connection_factory::replay_connection_factory(const std::string& path, pacing mode)
+        : st(new state())
+    {
+        st->factory.base.tcp_connect = replay_connect;
+        st->factory.owner = st.get();
+        st->mode = mode;
+
+        FILE* file = fopen(path.c_str(), "rb");
+        if(file == nullptr) throw exception("failed to open " + path + ": " + strerror(errno));
+        std::vector<uint8_t> content;
+        uint8_t buf[65536];
+        size_t n;
+        while((n = fread(buf, 1, sizeof(buf), file)) > 0) content.insert(content.end(), buf, buf + n);
+        fclose(file);
+
+        if(content.size() < 12 || memcmp(content.data(), replay_magic, sizeof(replay_magic)) != 0)
+            throw exception(path + " is not a capture file");
+        if(replay_get_le(content.data() + 8, 4) != replay_version) throw exception(path + " has an unsupported capture version");
+        size_t pos = 12;
+        while(pos < content.size()) {
+            if(content.size() - pos < 17) throw exception(path + " is truncated");
+            auto session = replay_get_le(content.data() + pos, 4);
+            auto direction = content[pos + 4];
+            auto ns = replay_get_le(content.data() + pos + 5, 8);
+            auto len = replay_get_le(content.data() + pos + 13, 4);
+            pos += 17;
+            if(content.size() - pos < len) throw exception(path + " is truncated");
+            if(session >= st->sessions.size()) st->sessions.resize(session + 1);
+            auto& s = st->sessions[session];
+            if(direction == replay_to_client) {
+                s.chunks.push_back({std::chrono::nanoseconds(ns), s.data.size(), s.data.size() + len});
+                s.data.insert(s.data.end(), content.begin() + pos, content.begin() + pos + len);
+                st->total += len;
+            } else {
+                s.sent.insert(s.sent.end(), content.begin() + pos, content.begin() + pos + len);
+            }
+            pos += len;
+        }
+    }
+
+    replay_connection_factory::~replay_connection_factory()
+    {}
+
+    struct neo4j_connection_factory* replay_connection_factory::get() const noexcept
+    {
+        return &st->factory.base;
+    }
+
+    size_t replay_connection_factory::sessions() const noexcept
+    {
+        return st->sessions.size();
+    }
+
+    std::vector<recorded_statement> replay_connection_factory::statements(size_t session) const
+    {
+        if(session >= st->sessions.size()) throw exception("session index out of range");
+        auto& sent = st->sessions[session].sent;
+        std::vector<recorded_statement> res;
+        // Skip the 20 byte handshake, then undo the chunking
+        size_t pos = 20;
+        std::vector<uint8_t> msg;
+        while(pos + 2 <= sent.size()) {
+            size_t len = (sent[pos] << 8) | sent[pos + 1];
+            pos += 2;
+            if(len != 0) {
+                if(sent.size() - pos < len) break;
+                msg.insert(msg.end(), sent.begin() + pos, sent.begin() + pos + len);
+                pos += len;
+                continue;
+            }
+            if(msg.empty()) continue;
+            packstream_reader r(msg.data(), msg.size());
+            uint8_t signature;
+            r.read_struct_header(signature);
+            if(signature == 0x10) {
+                recorded_statement stmt;
+                stmt.query = r.read_string();
+                stmt.params = r.read_value();
+                res.push_back(std::move(stmt));
+            }
+            msg.clear();
+        }
+        return res;
+    }
+
+    unsigned long long replay_connection_factory::recorded_bytes() const noexcept
+    {
+        return st->total;
+    }
+
+    unsigned long long replay_connection_factory::bytes_replayed() const noexcept
+    {
+        return st->replayed;
+    }
+
+    void replay_connection_factory::rewind() noexcept
+    {
+        st->next_session = 0;
+    }
+}
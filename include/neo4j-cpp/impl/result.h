@@ -2,6 +2,7 @@
 #include <neo4j-client.h>
 #include "../result.h"
 #include "../value.h"
+#include "../value_ref.h"
 
 namespace neo4j {
     result::result()
@@ -32,4 +33,9 @@ namespace neo4j {
     {
         return value(this->res, neo4j_result_field(res, idx));
     }
+
+    value_ref result::field_ref(unsigned int idx) const
+    {
+        return value_ref(this->res, neo4j_result_field(res, idx));
+    }
 }
\ No newline at end of file
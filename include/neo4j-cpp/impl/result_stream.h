@@ -3,26 +3,229 @@
 #include "../result_stream.h"
 #include "../connection.h"
 #include "../exception.h"
+#include "../error.h"
 #include "../result.h"
+#include "../plan.h"
+#include "../slow_query_log.h"
+#include "../watchdog.h"
+#include <algorithm>
 
 namespace neo4j {
-    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q)
-        : con(c), query(q)
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q, std::chrono::milliseconds timeout)
+        : con(c), result(nullptr), owned_query(q), query(owned_query.c_str()), slow_log(con->slow_log)
     {
-        if(results) result = neo4j_run(con->con, query.c_str(), neo4j_null);
-        else result = neo4j_send(con->con, query.c_str(), neo4j_null);
-        if(result == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
+        std::error_code ec;
+        start(results, timeout, ec);
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q, std::error_code& ec)
+        : con(c), result(nullptr), owned_query(q), query(owned_query.c_str()), slow_log(con->slow_log)
+    {
+        start(results, std::chrono::milliseconds::zero(), ec);
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q, std::chrono::milliseconds timeout, std::error_code& ec)
+        : con(c), result(nullptr), owned_query(q), query(owned_query.c_str()), slow_log(con->slow_log)
+    {
+        start(results, timeout, ec);
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q, const value& p, std::chrono::milliseconds timeout)
+        : con(c), result(nullptr), owned_query(q), query(owned_query.c_str()), params(p), slow_log(con->slow_log)
+    {
+        if(!params.is_null() && !params.is_map()) throw exception("statement parameters must be a map");
+        std::error_code ec;
+        start(results, timeout, ec);
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, const std::string& q, const value& p, std::chrono::milliseconds timeout, std::error_code& ec)
+        : con(c), result(nullptr), owned_query(q), query(owned_query.c_str()), params(p), slow_log(con->slow_log)
+    {
+        if(!params.is_null() && !params.is_map()) {
+            ec = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+        start(results, timeout, ec);
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, static_query q, const value& p, std::chrono::milliseconds timeout)
+        : con(c), result(nullptr), query(q.text), params(p), slow_log(con->slow_log)
+    {
+        if(!params.is_null() && !params.is_map()) throw exception("statement parameters must be a map");
+        std::error_code ec;
+        start(results, timeout, ec);
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+    }
+
+    result_stream::result_stream(std::shared_ptr<connection> c, bool results, std::shared_ptr<const std::string> q, const value& p, std::chrono::milliseconds timeout)
+        : con(c), result(nullptr), shared_query(std::move(q)), query(shared_query->c_str()), params(p), slow_log(con->slow_log)
+    {
+        if(!params.is_null() && !params.is_map()) throw exception("statement parameters must be a map");
+        std::error_code ec;
+        start(results, timeout, ec);
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
     }
 
     result_stream::~result_stream()
     {
+        if(result == nullptr) return;
+        // Only this deadline, earlier statements may still be outstanding
+        cancel_deadline();
+        finish();
         int res = neo4j_close_results(result);
         (void)res;
+        if(memory != nullptr) memory->release();
+    }
+
+    void result_stream::start(bool results, std::chrono::milliseconds timeout, std::error_code& ec) noexcept
+    {
+        if(slow_log) started = std::chrono::steady_clock::now();
+        if(con->account != nullptr) {
+            memory = new(std::nothrow) memory_counter();
+            if(memory == nullptr) {
+                ec = std::make_error_code(std::errc::not_enough_memory);
+                return;
+            }
+        }
+        {
+            memory_account::scope guard(memory);
+            std::lock_guard<std::mutex> lck(con->ctl);
+            con->settle_locked();
+            seq = ++con->sent;
+            auto p = params.is_null() ? neo4j_null : params.get_value();
+            if(results) result = neo4j_run(con->con, query, p);
+            else result = neo4j_send(con->con, query, p);
+            ec.clear();
+            if(result == nullptr) ec = make_client_error(errno);
+            else if(timeout > std::chrono::milliseconds::zero()) {
+                try {
+                    con->deadlines.reserve(con->deadlines.size() + 1);
+                    // Completion and the destructor cancel (and wait for) the timer,
+                    // so capturing this is safe
+                    deadline = watchdog::global().schedule(timeout, [this](){
+                        timed_out = true;
+                        con->interrupt_async();
+                    });
+                    con->deadlines.push_back(this);
+                } catch(...) {
+                    ec = std::make_error_code(std::errc::not_enough_memory);
+                }
+            }
+            if(!ec) return;
+            // The destructor does not run for a stream that failed to start
+            if(result != nullptr) {
+                int res = neo4j_close_results(result);
+                (void)res;
+                result = nullptr;
+            }
+        }
+        if(memory != nullptr) {
+            memory->release();
+            memory = nullptr;
+        }
+    }
+
+    void result_stream::record_fetch(bool has_record) noexcept
+    {
+        if(!has_record) {
+            finish();
+            complete();
+            return;
+        }
+        if(rows++ == 0 && slow_log) first_record = std::chrono::steady_clock::now() - started;
+    }
+
+    void result_stream::finish() noexcept
+    {
+        if(finished) return;
+        finished = true;
+        if(!slow_log) return;
+        auto total = std::chrono::steady_clock::now() - started;
+        if(total < slow_log->threshold()) return;
+        try {
+            auto wall = std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(total);
+            slow_log->submit(query, wall, first_record, total, rows);
+        } catch(...) {
+            // Recording is best effort
+        }
+    }
+
+    void result_stream::complete() const noexcept
+    {
+        std::lock_guard<std::mutex> lck(con->ctl);
+        // Responses arrive in order, statements sent before this one are complete too
+        auto& pending = con->deadlines;
+        while(!pending.empty() && pending.front()->seq <= seq) pending.front()->cancel_deadline_locked();
+    }
+
+    void result_stream::cancel_deadline() noexcept
+    {
+        std::lock_guard<std::mutex> lck(con->ctl);
+        cancel_deadline_locked();
+    }
+
+    void result_stream::cancel_deadline_locked() const noexcept
+    {
+        if(deadline == 0) return;
+        watchdog::global().cancel(deadline);
+        deadline = 0;
+        auto& pending = con->deadlines;
+        pending.erase(std::remove(pending.begin(), pending.end(), this), pending.end());
+    }
+
+    void result_stream::check_timeout(std::error_code& ec) const noexcept
+    {
+        if(!timed_out) return;
+        // The watchdog only interrupted the socket, reset on this thread
+        con->settle();
+        ec = std::make_error_code(std::errc::timed_out);
+    }
+
+    void result_stream::check_memory(std::error_code& ec) noexcept
+    {
+        if(memory == nullptr || !memory->limit_exceeded()) return;
+        if(!memory_exceeded) {
+            memory_exceeded = true;
+            // Drop whatever the server still streams for this statement
+            con->interrupt();
+            complete();
+        }
+        ec = std::make_error_code(std::errc::not_enough_memory);
+    }
+
+    memory_usage result_stream::get_memory_usage() const noexcept
+    {
+        if(memory == nullptr) return memory_usage{ 0, 0, 0, 0 };
+        return memory->usage();
+    }
+
+    bool result_stream::memory_pressure() const noexcept
+    {
+        return con->account != nullptr && con->account->over_soft_limit(memory);
+    }
+
+    struct failure_details result_stream::to_failure_details(const struct neo4j_failure_details* ptr)
+    {
+        struct failure_details res;
+        if(ptr->code != nullptr) res.code = ptr->code;
+        res.column = ptr->column;
+        if(ptr->context != nullptr) res.context = ptr->context;
+        res.context_offset = ptr->context_offset;
+        if(ptr->description != nullptr) res.description = ptr->description;
+        res.line = ptr->line;
+        if(ptr->message != nullptr) res.message = ptr->message;
+        res.offset = ptr->offset;
+        return res;
     }
 
     int result_stream::check_failure() const
     {
-        return neo4j_check_failure(result);
+        memory_account::scope guard(memory);
+        int res = neo4j_check_failure(result);
+        if(res != 0) complete();
+        return res;
     }
 
     std::string result_stream::error_code() const
@@ -41,33 +244,56 @@ namespace neo4j {
 
     struct failure_details result_stream::failure_details() const
     {
+        memory_account::scope guard(memory);
         auto ptr = neo4j_failure_details(result);
         if(ptr == nullptr) throw exception("No error occurred");
-        struct failure_details res;
-        res.code = ptr->code;
-        res.column = ptr->column;
-        if(ptr->context != nullptr) res.context = ptr->context;
-        res.context_offset = ptr->context_offset;
-        res.description = ptr->description;
-        res.line = ptr->line;
-        res.message = ptr->message;
-        res.offset = ptr->offset;
-        return res;
+        return to_failure_details(ptr);
+    }
+
+    error result_stream::failure() const
+    {
+        memory_account::scope guard(memory);
+        int res = neo4j_check_failure(result);
+        if(timed_out) {
+            std::error_code ec;
+            check_timeout(ec);
+            return error(ec);
+        }
+        if(memory_exceeded) return error(std::make_error_code(std::errc::not_enough_memory));
+        if(res == 0) return error();
+        complete();
+        if(res == NEO4J_STATEMENT_EVALUATION_FAILED) {
+            auto ptr = neo4j_failure_details(result);
+            if(ptr != nullptr) return error(make_client_error(res), to_failure_details(ptr));
+        }
+        return error(make_client_error(res));
     }
 
     unsigned int result_stream::nfields() const
     {
+        memory_account::scope guard(memory);
         return neo4j_nfields(result);
     }
 
     std::string result_stream::fieldname(unsigned int index) const
     {
+        memory_account::scope guard(memory);
         return neo4j_fieldname(result, index);
     }
 
+    string_ref result_stream::fieldname_ref(unsigned int index) const
+    {
+        memory_account::scope guard(memory);
+        auto ptr = neo4j_fieldname(result, index);
+        if(ptr == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
+        return string_ref(ptr);
+    }
+
     statement_type result_stream::type() const
     {
+        memory_account::scope guard(memory);
         int res = neo4j_statement_type(result);
+        complete();
         if(res < 0) throw exception(neo4j_strerror(errno, nullptr, 0));
         switch(res) {
             case NEO4J_READ_ONLY_STATEMENT: return statement_type::read_only;
@@ -79,25 +305,112 @@ namespace neo4j {
         }
     }
 
+    struct update_counts result_stream::update_counts() const
+    {
+        memory_account::scope guard(memory);
+        errno = 0;
+        auto counts = neo4j_update_counts(result);
+        complete();
+        if(errno != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
+        struct update_counts res;
+        res.nodes_created = counts.nodes_created;
+        res.nodes_deleted = counts.nodes_deleted;
+        res.relationships_created = counts.relationships_created;
+        res.relationships_deleted = counts.relationships_deleted;
+        res.properties_set = counts.properties_set;
+        res.labels_added = counts.labels_added;
+        res.labels_removed = counts.labels_removed;
+        res.indexes_added = counts.indexes_added;
+        res.indexes_removed = counts.indexes_removed;
+        res.constraints_added = counts.constraints_added;
+        res.constraints_removed = counts.constraints_removed;
+        return res;
+    }
+
+    struct statement_plan result_stream::statement_plan() const
+    {
+        memory_account::scope guard(memory);
+        auto plan = neo4j_statement_plan(result);
+        complete();
+        if(plan == nullptr) throw exception(neo4j_strerror(errno, nullptr, 0));
+        struct statement_plan res;
+        try {
+            res = statement_plan::from_native(plan);
+        } catch(...) {
+            neo4j_statement_plan_release(plan);
+            throw;
+        }
+        neo4j_statement_plan_release(plan);
+        return res;
+    }
+
     neo4j::result result_stream::fetch_next()
     {
+        std::error_code ec;
+        auto res = fetch_next(ec);
+        if(ec == std::errc::timed_out) throw timeout_error("statement deadline exceeded");
+        if(memory_exceeded) throw memory_limit_error("stream memory limit exceeded");
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+        return res;
+    }
+
+    neo4j::result result_stream::fetch_next(std::error_code& ec) noexcept
+    {
+        if(memory_exceeded) {
+            ec = std::make_error_code(std::errc::not_enough_memory);
+            return neo4j::result();
+        }
+        ec.clear();
+        check_timeout(ec);
+        if(ec) return neo4j::result();
+        memory_account::scope guard(memory);
         errno = 0;
         auto ptr = neo4j_fetch_next(result);
+        record_fetch(ptr != nullptr);
         if(ptr == nullptr) {
-            if(errno != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
-            else return neo4j::result();
+            check_timeout(ec);
+            if(!ec) check_memory(ec);
+            if(!ec && errno != 0) ec = make_client_error(errno);
+            return neo4j::result();
         }
+        ec.clear();
         return neo4j::result(ptr);
     }
 
     neo4j::result result_stream::peek(unsigned int depth)
     {
+        std::error_code ec;
+        auto res = peek(depth, ec);
+        if(ec == std::errc::timed_out) throw timeout_error("statement deadline exceeded");
+        if(memory_exceeded) throw memory_limit_error("stream memory limit exceeded");
+        if(ec == std::errc::resource_unavailable_try_again) throw memory_limit_error("soft memory limit reached, read-ahead suspended");
+        if(ec) throw exception(neo4j_strerror(ec.value(), nullptr, 0));
+        return res;
+    }
+
+    neo4j::result result_stream::peek(unsigned int depth, std::error_code& ec) noexcept
+    {
+        if(memory_exceeded) {
+            ec = std::make_error_code(std::errc::not_enough_memory);
+            return neo4j::result();
+        }
+        if(depth > 1 && memory_pressure()) {
+            ec = std::make_error_code(std::errc::resource_unavailable_try_again);
+            return neo4j::result();
+        }
+        ec.clear();
+        check_timeout(ec);
+        if(ec) return neo4j::result();
+        memory_account::scope guard(memory);
         errno = 0;
         auto ptr = neo4j_peek(result, depth);
         if(ptr == nullptr) {
-            if(errno != 0) throw exception(neo4j_strerror(errno, nullptr, 0));
-            else return neo4j::result();
+            check_timeout(ec);
+            if(!ec) check_memory(ec);
+            if(!ec && errno != 0) ec = make_client_error(errno);
+            return neo4j::result();
         }
+        ec.clear();
         return neo4j::result(ptr);
     }
 }
\ No newline at end of file
@@ -0,0 +1,289 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include "../retry.h"
+#include "../connection.h"
+#include "../pool.h"
+#include "../routing.h"
+#include "../value.h"
+#include "../exception.h"
+
+namespace neo4j {
+    failure_class classify_failure(string_ref code) noexcept
+    {
+        static const string_ref transient_prefix("Neo.TransientError.");
+        if(code.empty()) return failure_class::none;
+        if(code.size() > transient_prefix.size() && string_ref(code.data(), transient_prefix.size()) == transient_prefix) {
+            // Termination was requested by someone, running again would ignore that
+            if(code == string_ref("Neo.TransientError.Transaction.Terminated")
+                || code == string_ref("Neo.TransientError.Transaction.LockClientStopped"))
+                return failure_class::permanent;
+            return failure_class::transient;
+        }
+        // Sent by a member that lost or never had the leadership, it keeps
+        // refusing until the statement goes to the new leader
+        if(code == string_ref("Neo.ClientError.Cluster.NotALeader")
+            || code == string_ref("Neo.ClientError.General.ForbiddenOnReadOnlyDatabase"))
+            return failure_class::reroute;
+        return failure_class::permanent;
+    }
+
+    failure_class classify_failure(const error& err) noexcept
+    {
+        if(!err) return failure_class::none;
+        if(err.has_failure_details()) return classify_failure(string_ref(err.failure_details().code));
+        auto& ec = err.code();
+        if(ec.category() == client_category()) {
+            switch(ec.value()) {
+                case NEO4J_CONNECTION_CLOSED:
+                case NEO4J_SESSION_FAILED:
+                case NEO4J_SESSION_ENDED:
+                case ECONNRESET:
+                case ECONNREFUSED:
+                case ECONNABORTED:
+                case EPIPE:
+                case ETIMEDOUT:
+                case EHOSTUNREACH:
+                case ENETUNREACH:
+                case ENETDOWN:
+                case ENOTCONN:
+                    return failure_class::connection;
+                default: return failure_class::permanent;
+            }
+        }
+        // Statement deadlines (std::errc::timed_out) are the caller's limit, not retried
+        if(ec == std::errc::not_connected || ec == std::errc::connection_refused || ec == std::errc::connection_reset)
+            return failure_class::connection;
+        return failure_class::permanent;
+    }
+
+    retry_policy::retry_policy(const retry_options& o)
+        : opts(o)
+    {
+        if(opts.max_attempts == 0) opts.max_attempts = 1;
+        if(opts.multiplier < 1) opts.multiplier = 1;
+        opts.jitter = std::min(1.0, std::max(0.0, opts.jitter));
+    }
+
+    static bool is_retried(failure_class cls, bool routed) noexcept
+    {
+        return cls == failure_class::transient || cls == failure_class::connection
+            || (routed && cls == failure_class::reroute);
+    }
+
+    bool retry_policy::is_retryable(const error& err, idempotency mode, bool routed) const noexcept
+    {
+        if(!is_retried(classify_failure(err), routed)) return false;
+        return mode != idempotency::non_idempotent;
+    }
+
+    std::chrono::milliseconds retry_policy::backoff(unsigned int retry) const
+    {
+        // Jitter spreads the retries of clients that failed together
+        thread_local std::mt19937_64 rng(std::random_device{}());
+        double base = static_cast<double>(opts.initial_backoff.count()) * std::pow(opts.multiplier, retry);
+        base = std::min(base, static_cast<double>(opts.max_backoff.count()));
+        std::uniform_real_distribution<double> dist(1 - opts.jitter, 1 + opts.jitter);
+        return std::chrono::milliseconds(static_cast<long long>(base * dist(rng)));
+    }
+
+    template<typename Attempt>
+    error retry_policy::retry_loop(idempotency mode, bool routed, Attempt&& attempt)
+    {
+        operations.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + opts.deadline;
+        for(unsigned int n = 0;; n++) {
+            auto timeout = std::chrono::milliseconds::zero();
+            if(opts.deadline.count() > 0) {
+                timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if(timeout.count() <= 0) timeout = std::chrono::milliseconds(1);
+            }
+            attempts.fetch_add(1, std::memory_order_relaxed);
+            auto err = attempt(timeout);
+            if(!err) {
+                if(n > 0) recovered.fetch_add(1, std::memory_order_relaxed);
+                return err;
+            }
+            if(!is_retried(classify_failure(err), routed)) return err;
+            if(mode == idempotency::non_idempotent) {
+                unsafe.fetch_add(1, std::memory_order_relaxed);
+                return err;
+            }
+            if(n + 1 >= opts.max_attempts) {
+                exhausted.fetch_add(1, std::memory_order_relaxed);
+                return err;
+            }
+            auto delay = backoff(n);
+            if(opts.deadline.count() > 0 && std::chrono::steady_clock::now() + delay >= deadline) {
+                deadline_exceeded.fetch_add(1, std::memory_order_relaxed);
+                return err;
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    template<typename Fn>
+    error retry_policy::on_pool(connection_pool& pool, idempotency mode, Fn&& fn)
+    {
+        return retry_loop(mode, false, [&](std::chrono::milliseconds timeout) {
+            std::shared_ptr<connection> con;
+            try {
+                con = pool.acquire();
+            } catch(const exception&) {
+                return error(std::make_error_code(std::errc::not_connected));
+            }
+            auto err = fn(*con, timeout);
+            if(classify_failure(err) == failure_class::connection) {
+                pool.discard(con);
+                reconnects.fetch_add(1, std::memory_order_relaxed);
+            }
+            return err;
+        });
+    }
+
+    template<typename Fn>
+    error retry_policy::on_connection(std::shared_ptr<connection>& con, idempotency mode, Fn&& fn)
+    {
+        if(con == nullptr) throw exception("retry needs a connection");
+        bool broken = false;
+        return retry_loop(mode, false, [&](std::chrono::milliseconds timeout) {
+            if(broken) {
+                std::error_code ec;
+                con->reset(ec);
+                if(ec) {
+                    try {
+                        con = con->reconnect();
+                    } catch(const exception&) {
+                        return error(std::make_error_code(std::errc::not_connected));
+                    }
+                    reconnects.fetch_add(1, std::memory_order_relaxed);
+                }
+                broken = false;
+            }
+            auto err = fn(*con, timeout);
+            broken = classify_failure(err) == failure_class::connection;
+            return err;
+        });
+    }
+
+    template<typename Fn>
+    error retry_policy::on_routing(routing_client& client, access_mode access, idempotency mode, Fn&& fn)
+    {
+        return retry_loop(mode, true, [&](std::chrono::milliseconds timeout) {
+            std::shared_ptr<connection> con;
+            try {
+                con = client.acquire(access);
+            } catch(const exception&) {
+                return error(std::make_error_code(std::errc::not_connected));
+            }
+            auto err = fn(*con, timeout);
+            auto cls = classify_failure(err);
+            if(cls == failure_class::connection) {
+                client.discard(con);
+                reconnects.fetch_add(1, std::memory_order_relaxed);
+            } else if(cls == failure_class::reroute) {
+                client.mark_down(*con);
+                reroutes.fetch_add(1, std::memory_order_relaxed);
+            }
+            return err;
+        });
+    }
+
+    error retry_policy::execute(connection_pool& pool, idempotency mode, const std::function<error(connection&)>& fn)
+    {
+        return on_pool(pool, mode, [&](connection& con, std::chrono::milliseconds) { return fn(con); });
+    }
+
+    error retry_policy::execute(std::shared_ptr<connection>& con, idempotency mode, const std::function<error(connection&)>& fn)
+    {
+        return on_connection(con, mode, [&](connection& c, std::chrono::milliseconds) { return fn(c); });
+    }
+
+    error retry_policy::execute(routing_client& client, access_mode access, idempotency mode, const std::function<error(connection&)>& fn)
+    {
+        return on_routing(client, access, mode, [&](connection& con, std::chrono::milliseconds) { return fn(con); });
+    }
+
+    static error retry_start(connection& con, const std::string& query, const value& params,
+        std::chrono::milliseconds timeout, std::shared_ptr<result_stream>& stream)
+    {
+        std::error_code ec;
+        stream = std::make_shared<result_stream>(con.shared_from_this(), true, query, params, timeout, ec);
+        if(ec) {
+            stream.reset();
+            return error(ec);
+        }
+        auto err = stream->failure();
+        if(err) stream.reset();
+        // The budget covers starting the statement, not reading its records
+        else stream->cancel_deadline();
+        return err;
+    }
+
+    expected<std::shared_ptr<result_stream>> retry_policy::run_nothrow(connection_pool& pool, const std::string& query, const value& params, idempotency mode)
+    {
+        std::shared_ptr<result_stream> stream;
+        auto err = on_pool(pool, mode, [&](connection& con, std::chrono::milliseconds timeout) {
+            return retry_start(con, query, params, timeout, stream);
+        });
+        if(err) return err;
+        return stream;
+    }
+
+    expected<std::shared_ptr<result_stream>> retry_policy::run_nothrow(std::shared_ptr<connection>& con, const std::string& query, const value& params, idempotency mode)
+    {
+        std::shared_ptr<result_stream> stream;
+        auto err = on_connection(con, mode, [&](connection& c, std::chrono::milliseconds timeout) {
+            return retry_start(c, query, params, timeout, stream);
+        });
+        if(err) return err;
+        return stream;
+    }
+
+    expected<std::shared_ptr<result_stream>> retry_policy::run_nothrow(routing_client& client, const std::string& query, const value& params, idempotency mode)
+    {
+        std::shared_ptr<result_stream> stream;
+        auto access = mode == idempotency::read_only ? access_mode::read : access_mode::write;
+        auto err = on_routing(client, access, mode, [&](connection& con, std::chrono::milliseconds timeout) {
+            return retry_start(con, query, params, timeout, stream);
+        });
+        if(err) return err;
+        return stream;
+    }
+
+    std::shared_ptr<result_stream> retry_policy::run(connection_pool& pool, const std::string& query, const value& params, idempotency mode)
+    {
+        return run_nothrow(pool, query, params, mode).value();
+    }
+
+    std::shared_ptr<result_stream> retry_policy::run(std::shared_ptr<connection>& con, const std::string& query, const value& params, idempotency mode)
+    {
+        return run_nothrow(con, query, params, mode).value();
+    }
+
+    std::shared_ptr<result_stream> retry_policy::run(routing_client& client, const std::string& query, const value& params, idempotency mode)
+    {
+        return run_nothrow(client, query, params, mode).value();
+    }
+
+    retry_stats retry_policy::stats() const noexcept
+    {
+        retry_stats res;
+        res.operations = operations;
+        res.attempts = attempts;
+        res.retries = retries;
+        res.recovered = recovered;
+        res.exhausted = exhausted;
+        res.deadline_exceeded = deadline_exceeded;
+        res.unsafe = unsafe;
+        res.reconnects = reconnects;
+        res.reroutes = reroutes;
+        return res;
+    }
+}
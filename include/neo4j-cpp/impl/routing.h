@@ -0,0 +1,286 @@
+#pragma once
+#include <neo4j-client.h>
+#include <algorithm>
+#include "../routing.h"
+#include "../pool.h"
+#include "../config.h"
+#include "../connection.h"
+#include "../result.h"
+#include "../value.h"
+#include "../exception.h"
+
+namespace neo4j {
+    routing_client::routing_client(std::vector<std::string> pseeds, const routing_options& popts)
+        : routing_client(std::move(pseeds), config(), popts)
+    {}
+
+    routing_client::routing_client(std::vector<std::string> pseeds, const config& conf, const routing_options& popts)
+        : routing_client(std::move(pseeds), conf.freeze(), popts)
+    {}
+
+    routing_client::routing_client(std::vector<std::string> pseeds, shared_config conf, const routing_options& popts)
+        : cfg(std::move(conf)), opts(popts), seeds(std::move(pseeds))
+    {
+        if(seeds.empty()) throw exception("routing client needs at least one seed address");
+    }
+
+    routing_client::~routing_client()
+    {}
+
+    std::shared_ptr<routing_client::member> routing_client::get_member(const std::string& address)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return member_locked(address);
+    }
+
+    std::shared_ptr<routing_client::member> routing_client::member_locked(const std::string& address)
+    {
+        auto& m = members[address];
+        if(!m) {
+            m = std::make_shared<member>();
+            m->address = address;
+            m->pool.reset(new connection_pool("neo4j://" + address, cfg, opts.flags, opts.max_connections));
+        }
+        return m;
+    }
+
+    bool routing_client::is_down(const member& m, std::chrono::steady_clock::time_point now) const noexcept
+    {
+        return m.down_until > now;
+    }
+
+    void routing_client::mark_down(member& m)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        m.backoff = m.backoff.count() == 0 ? opts.min_backoff : std::min(m.backoff * 2, opts.max_backoff);
+        m.down_until = std::chrono::steady_clock::now() + m.backoff;
+        // A lost writer usually means a new leader, so fetch a new table
+        if(std::find(writers.begin(), writers.end(), m.address) != writers.end())
+            expires = std::chrono::steady_clock::time_point{};
+        m.pool->clear_idle();
+    }
+
+    void routing_client::mark_down(const std::string& address)
+    {
+        mark_down(*get_member(address));
+    }
+
+    // Members are keyed by the "host:port" their pool connects to
+    static std::string routing_address(const connection& con)
+    {
+        return con.get_hostname() + ":" + std::to_string(con.get_port());
+    }
+
+    void routing_client::mark_down(const connection& con)
+    {
+        mark_down(routing_address(con));
+    }
+
+    void routing_client::discard(const std::shared_ptr<connection>& con)
+    {
+        if(con == nullptr) return;
+        auto m = get_member(routing_address(*con));
+        m->pool->discard(con);
+        mark_down(*m);
+    }
+
+    bool routing_client::refresh_from(const std::string& address)
+    {
+        auto m = get_member(address);
+        std::vector<std::string> nreaders, nwriters, nrouters;
+        long long ttl = -1;
+        try {
+            auto con = m->pool->acquire();
+            auto stream = con->run("CALL dbms.cluster.routing.getRoutingTable({})");
+            unsigned int ttl_idx = stream->nfields(), servers_idx = stream->nfields();
+            for(unsigned int i = 0; i < stream->nfields(); i++) {
+                auto name = stream->fieldname(i);
+                if(name == "ttl") ttl_idx = i;
+                else if(name == "servers") servers_idx = i;
+            }
+            if(servers_idx == stream->nfields()) throw exception("routing table without servers");
+            auto rec = stream->fetch_next();
+            if(!rec) throw exception("empty routing table");
+            if(ttl_idx != stream->nfields()) ttl = rec.field(ttl_idx).to_int();
+            auto servers = rec.field(servers_idx);
+            for(unsigned int i = 0; i < servers.list_size(); i++) {
+                auto server = servers.list_entry(i);
+                auto role = server.map_entry("role").to_string();
+                auto addresses = server.map_entry("addresses");
+                std::vector<std::string>* target = nullptr;
+                if(role == "READ") target = &nreaders;
+                else if(role == "WRITE") target = &nwriters;
+                else if(role == "ROUTE") target = &nrouters;
+                else continue;
+                for(unsigned int a = 0; a < addresses.list_size(); a++)
+                    target->push_back(addresses.list_entry(a).to_string());
+            }
+            while(stream->fetch_next()) {}
+        } catch(const std::exception&) {
+            mark_down(*m);
+            return false;
+        }
+        if(nrouters.empty()) return false;
+
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lck(mtx);
+        m->backoff = std::chrono::milliseconds::zero();
+        readers = std::move(nreaders);
+        writers = std::move(nwriters);
+        routers = std::move(nrouters);
+        expires = now + (ttl >= 0 ? std::chrono::seconds(ttl) : opts.default_ttl);
+        // Drop members that left the cluster, their pools close once unused
+        for(auto it = members.begin(); it != members.end();) {
+            auto& a = it->first;
+            if(std::find(readers.begin(), readers.end(), a) == readers.end()
+                && std::find(writers.begin(), writers.end(), a) == writers.end()
+                && std::find(routers.begin(), routers.end(), a) == routers.end()
+                && std::find(seeds.begin(), seeds.end(), a) == seeds.end())
+                it = members.erase(it);
+            else ++it;
+        }
+        return true;
+    }
+
+    void routing_client::refresh()
+    {
+        std::lock_guard<std::mutex> rlck(refresh_mtx);
+        refresh_locked();
+    }
+
+    void routing_client::refresh_locked()
+    {
+        std::vector<std::string> known, up, skipped;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            known = routers;
+            for(auto& s : seeds) {
+                if(std::find(known.begin(), known.end(), s) == known.end()) known.push_back(s);
+            }
+            // Routers that are down are only asked if nobody else answered
+            auto now = std::chrono::steady_clock::now();
+            for(auto& address : known) {
+                if(is_down(*member_locked(address), now)) skipped.push_back(address);
+                else up.push_back(address);
+            }
+        }
+        for(auto& address : up) {
+            if(refresh_from(address)) return;
+        }
+        for(auto& address : skipped) {
+            if(refresh_from(address)) return;
+        }
+        throw exception("no cluster member returned a routing table");
+    }
+
+    void routing_client::ensure_table()
+    {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            if(std::chrono::steady_clock::now() < expires) return;
+        }
+        // Held throughout, so threads waiting here use this refresh
+        std::lock_guard<std::mutex> rlck(refresh_mtx);
+        bool have_table;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            // Another thread refreshed while we waited
+            if(std::chrono::steady_clock::now() < expires) return;
+            have_table = !routers.empty();
+        }
+        try {
+            refresh_locked();
+        } catch(const exception&) {
+            // Keep routing with the stale table rather than failing, and
+            // let the waiting threads use it too instead of asking again
+            if(!have_table) throw;
+            std::lock_guard<std::mutex> lck(mtx);
+            expires = std::chrono::steady_clock::now() + opts.min_backoff;
+        }
+    }
+
+    std::vector<std::shared_ptr<routing_client::member>> routing_client::candidates(access_mode mode)
+    {
+        std::vector<std::shared_ptr<member>> res;
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lck(mtx);
+        auto* addresses = mode == access_mode::read ? &readers : &writers;
+        // Without replicas the leader serves reads as well
+        if(mode == access_mode::read && readers.empty()) addresses = &writers;
+        for(auto& a : *addresses) {
+            auto m = member_locked(a);
+            if(!is_down(*m, now)) res.push_back(m);
+        }
+        if(res.empty()) return res;
+        // Rotate before the stable sort so ties are broken round robin
+        std::rotate(res.begin(), res.begin() + (next++ % res.size()), res.end());
+        std::vector<std::pair<size_t, std::shared_ptr<member>>> load;
+        for(auto& m : res) load.emplace_back(m->pool->in_use(), m);
+        std::stable_sort(load.begin(), load.end(), [](const std::pair<size_t, std::shared_ptr<member>>& a, const std::pair<size_t, std::shared_ptr<member>>& b) {
+            return a.first < b.first;
+        });
+        for(size_t i = 0; i < load.size(); i++) res[i] = load[i].second;
+        return res;
+    }
+
+    std::shared_ptr<connection> routing_client::acquire(access_mode mode)
+    {
+        ensure_table();
+        auto list = candidates(mode);
+        if(list.empty()) {
+            refresh();
+            list = candidates(mode);
+        }
+        for(auto& m : list) {
+            try {
+                auto con = m->pool->acquire();
+                std::lock_guard<std::mutex> lck(mtx);
+                m->backoff = std::chrono::milliseconds::zero();
+                return con;
+            } catch(const exception&) {
+                mark_down(*m);
+            }
+        }
+        throw exception(mode == access_mode::read ? "no cluster member available for reading" : "no cluster member available for writing");
+    }
+
+    std::shared_ptr<result_stream> routing_client::run(const std::string& query, access_mode mode)
+    {
+        return acquire(mode)->run(query);
+    }
+
+    std::shared_ptr<result_stream> routing_client::send(const std::string& query, access_mode mode)
+    {
+        return acquire(mode)->send(query);
+    }
+
+    std::vector<routing_client::member_state> routing_client::states(const std::vector<std::string>& addresses) const
+    {
+        std::vector<member_state> res;
+        auto now = std::chrono::steady_clock::now();
+        for(auto& a : addresses) {
+            auto it = members.find(a);
+            if(it == members.end()) res.push_back({a, 0, false});
+            else res.push_back({a, it->second->pool->in_use(), is_down(*it->second, now)});
+        }
+        return res;
+    }
+
+    std::vector<routing_client::member_state> routing_client::get_readers() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return states(readers);
+    }
+
+    std::vector<routing_client::member_state> routing_client::get_writers() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return states(writers);
+    }
+
+    std::vector<routing_client::member_state> routing_client::get_routers() const
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return states(routers);
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include "../slow_query_log.h"
+#include "../connection.h"
+#include "../plan.h"
+
+namespace neo4j {
+    std::string fingerprint(const std::string& query)
+    {
+        std::string res;
+        res.reserve(query.size());
+        bool space = false;
+        for(size_t i = 0; i < query.size(); i++) {
+            char c = query[i];
+            if(std::isspace(static_cast<unsigned char>(c))) {
+                space = !res.empty();
+                continue;
+            }
+            if(space) {
+                res += ' ';
+                space = false;
+            }
+            if(c == '\'' || c == '"') {
+                // String literal, honoring backslash escapes
+                for(i++; i < query.size() && query[i] != c; i++) {
+                    if(query[i] == '\\') i++;
+                }
+                res += '?';
+            } else if(c == '`') {
+                // Escaped identifier, keep as is
+                size_t end = query.find('`', i + 1);
+                if(end == std::string::npos) end = query.size() - 1;
+                res.append(query, i, end - i + 1);
+                i = end;
+            } else if(std::isdigit(static_cast<unsigned char>(c))
+                && (res.empty() || !(std::isalnum(static_cast<unsigned char>(res.back())) || res.back() == '_' || res.back() == '$'))) {
+                // Numeric literal (not part of an identifier or parameter)
+                bool hex = c == '0' && i + 1 < query.size() && (query[i + 1] == 'x' || query[i + 1] == 'X');
+                while(i + 1 < query.size()) {
+                    char n = query[i + 1];
+                    if(std::isalnum(static_cast<unsigned char>(n)) || n == '.') i++;
+                    // Signed exponent as in 1e-5
+                    else if((n == '+' || n == '-') && !hex && (query[i] == 'e' || query[i] == 'E')
+                        && i + 2 < query.size() && std::isdigit(static_cast<unsigned char>(query[i + 2]))) i++;
+                    else break;
+                }
+                if(!res.empty() && res.back() == '-' && (res.size() < 2 || !std::isalnum(static_cast<unsigned char>(res[res.size() - 2])))) res.back() = '?';
+                else res += '?';
+            } else {
+                res += c;
+            }
+        }
+        return res;
+    }
+
+    slow_query_log::slow_query_log(slow_query_options options)
+        : opts(std::move(options))
+    {
+        if(!opts.file.empty()) out.open(opts.file, std::ios::app);
+        worker = std::thread([this](){ run(); });
+    }
+
+    slow_query_log::~slow_query_log()
+    {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    void slow_query_log::submit(std::string query, std::chrono::system_clock::time_point started,
+        std::chrono::nanoseconds time_to_first_record, std::chrono::nanoseconds total_time, unsigned long long rows)
+    {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            // Drop entries if the worker can not keep up instead of growing unbounded
+            if(pending.size() >= opts.capacity) pending.pop_front();
+            pending.push_back({std::move(query), started, time_to_first_record, total_time, rows});
+        }
+        cv.notify_all();
+    }
+
+    std::vector<slow_query_entry> slow_query_log::entries() const
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        return std::vector<slow_query_entry>(ring.begin(), ring.end());
+    }
+
+    void slow_query_log::clear()
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        ring.clear();
+    }
+
+    void slow_query_log::flush()
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        cv.wait(lck, [this](){ return pending.empty() && processing == 0; });
+    }
+
+    void slow_query_log::run()
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        while(true) {
+            cv.wait(lck, [this](){ return stop || !pending.empty(); });
+            if(pending.empty()) return;
+            auto e = std::move(pending.front());
+            pending.pop_front();
+            processing++;
+            lck.unlock();
+            auto entry = process(std::move(e));
+            if(out.is_open()) write(entry);
+            lck.lock();
+            processing--;
+            ring.push_back(std::move(entry));
+            while(ring.size() > opts.capacity) ring.pop_front();
+            cv.notify_all();
+        }
+    }
+
+    slow_query_entry slow_query_log::process(pending_entry e)
+    {
+        slow_query_entry res;
+        res.fingerprint = fingerprint(e.query);
+        res.query = std::move(e.query);
+        res.started = e.started;
+        res.time_to_first_record = e.time_to_first_record;
+        res.total_time = e.total_time;
+        res.rows = e.rows;
+        res.has_plan = false;
+        if(opts.plan_connection) {
+            try {
+                if(!plan_con) plan_con = opts.plan_connection();
+                if(plan_con) {
+                    res.plan = plan_con->explain(res.query);
+                    res.has_plan = true;
+                }
+            } catch(const std::exception&) {
+                // Drop the connection, it might be broken
+                plan_con.reset();
+            }
+        }
+        return res;
+    }
+
+    void slow_query_log::write(const slow_query_entry& e)
+    {
+        char time[32];
+        std::time_t t = std::chrono::system_clock::to_time_t(e.started);
+        std::tm tm;
+        gmtime_r(&t, &tm);
+        std::strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        out << time
+            << "\ttotal_ms=" << std::chrono::duration_cast<std::chrono::milliseconds>(e.total_time).count()
+            << "\tfirst_record_ms=" << std::chrono::duration_cast<std::chrono::milliseconds>(e.time_to_first_record).count()
+            << "\trows=" << e.rows
+            << "\t" << e.fingerprint << "\n";
+        if(e.has_plan) out << to_string(e.plan);
+        // Entries should be visible to tail -f right away
+        out.flush();
+    }
+}
@@ -0,0 +1,551 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../snapshot.h"
+#include "../result.h"
+#include "../result_stream.h"
+#include "../value_ref.h"
+#include "../exception.h"
+
+namespace neo4j {
+    // Snapshot format: "NEO4JSNP", little endian uint32 version, uint32
+    // field count, uint64 record count and uint64 index offset, then the
+    // field names as PackStream strings, the records as uint32 length plus
+    // the PackStream encoded fields and finally one uint64 offset per record.
+    static const char snapshot_magic[8] = {'N', 'E', 'O', '4', 'J', 'S', 'N', 'P'};
+    static const uint32_t snapshot_version = 1;
+    static const size_t snapshot_header_size = 32;
+    static const uint8_t snapshot_null = 0xC0;
+
+    static void snapshot_put_le(uint8_t* p, uint64_t v, size_t bytes)
+    {
+        for(size_t i = 0; i < bytes; i++) p[i] = static_cast<uint8_t>(v >> (i * 8));
+    }
+
+    static uint64_t snapshot_get_le(const uint8_t* p, size_t bytes)
+    {
+        uint64_t res = 0;
+        for(size_t i = 0; i < bytes; i++) res |= static_cast<uint64_t>(p[i]) << (i * 8);
+        return res;
+    }
+
+    snapshot_value::snapshot_value() noexcept
+        : ptr(&snapshot_null), stop(&snapshot_null + 1)
+    {}
+
+    value_type snapshot_value::get_type() const
+    {
+        auto r = reader();
+        switch(r.peek()) {
+            case packstream_reader::marker::null: return value_type::type_null;
+            case packstream_reader::marker::boolean: return value_type::type_bool;
+            case packstream_reader::marker::integer: return value_type::type_int;
+            case packstream_reader::marker::floating: return value_type::type_float;
+            case packstream_reader::marker::string: return value_type::type_string;
+            case packstream_reader::marker::bytes: return value_type::type_bytes;
+            case packstream_reader::marker::list: return value_type::type_list;
+            case packstream_reader::marker::map: return value_type::type_map;
+            case packstream_reader::marker::structure: {
+                uint8_t sig;
+                r.read_struct_header(sig);
+                if(sig == 0x4E) return value_type::type_node;
+                if(sig == 0x52) return value_type::type_relationship;
+                if(sig == 0x50) return value_type::type_path;
+                return value_type::type_unknown;
+            }
+            default: return value_type::type_unknown;
+        }
+    }
+
+    packstream_reader snapshot_value::structure(uint8_t signature, const char* what) const
+    {
+        auto r = reader();
+        uint8_t sig = 0;
+        if(r.peek() != packstream_reader::marker::structure || (r.read_struct_header(sig), sig != signature))
+            throw exception(std::string("not a ") + what);
+        return r;
+    }
+
+    snapshot_value snapshot_value::entry(packstream_reader& r) const
+    {
+        auto start = r.position();
+        r.skip();
+        return snapshot_value(start, r.position());
+    }
+
+    snapshot_value::iterator snapshot_value::begin() const
+    {
+        auto r = reader();
+        switch(r.peek()) {
+            case packstream_reader::marker::list: {
+                auto n = r.read_list_header();
+                return iterator(r.position(), stop, n, false);
+            }
+            case packstream_reader::marker::map: {
+                auto n = r.read_map_header();
+                return iterator(r.position(), stop, n, true);
+            }
+            default: throw exception("not a list or map");
+        }
+    }
+
+    snapshot_value::iterator snapshot_value::end() const noexcept
+    {
+        return iterator();
+    }
+
+    snapshot_value::iterator::iterator(const uint8_t* data, const uint8_t* end, size_t count, bool p)
+        : pos(data), stop(end), left(count), pairs(p)
+    {
+        load();
+    }
+
+    void snapshot_value::iterator::load()
+    {
+        if(left == 0) return;
+        packstream_reader r(pos, stop - pos);
+        if(pairs) {
+            size_t len;
+            auto key = r.read_string(len);
+            k = string_ref(key, len);
+        }
+        auto start = r.position();
+        r.skip();
+        next = r.position();
+        current = snapshot_value(start, next);
+    }
+
+    snapshot_value::iterator& snapshot_value::iterator::operator++()
+    {
+        pos = next;
+        if(--left == 0) {
+            k = string_ref();
+            current = snapshot_value();
+        }
+        load();
+        return *this;
+    }
+
+    bool snapshot_value::to_bool() const
+    {
+        if(!is_bool()) throw exception("not a bool");
+        return reader().read_bool();
+    }
+
+    long long snapshot_value::to_int() const
+    {
+        if(!is_int()) throw exception("not an int");
+        return reader().read_int();
+    }
+
+    double snapshot_value::to_float() const
+    {
+        if(!is_float()) throw exception("not a float");
+        return reader().read_float();
+    }
+
+    std::string snapshot_value::to_string() const
+    {
+        auto str = to_string_ref();
+        return std::string(str.data(), str.size());
+    }
+
+    string_ref snapshot_value::to_string_ref() const
+    {
+        if(!is_string()) throw exception("not a string");
+        size_t len;
+        auto str = reader().read_string(len);
+        return string_ref(str, len);
+    }
+
+    string_ref snapshot_value::to_bytes_ref() const
+    {
+        if(!is_bytes()) throw exception("not a bytes value");
+        size_t len;
+        auto bytes = reader().read_bytes(len);
+        return string_ref(reinterpret_cast<const char*>(bytes), len);
+    }
+
+    unsigned int snapshot_value::list_size() const
+    {
+        if(!is_list()) throw exception("not a list");
+        return static_cast<unsigned int>(reader().read_list_header());
+    }
+
+    snapshot_value snapshot_value::list_entry(unsigned int idx) const
+    {
+        if(!is_list()) throw exception("not a list");
+        auto r = reader();
+        if(idx >= r.read_list_header()) throw exception("list index out of range");
+        for(unsigned int i = 0; i < idx; i++) r.skip();
+        return entry(r);
+    }
+
+    unsigned int snapshot_value::map_size() const
+    {
+        if(!is_map()) throw exception("not a map");
+        return static_cast<unsigned int>(reader().read_map_header());
+    }
+
+    string_ref snapshot_value::map_key(unsigned int idx) const
+    {
+        if(!is_map()) throw exception("not a map");
+        auto r = reader();
+        if(idx >= r.read_map_header()) throw exception("map index out of range");
+        for(unsigned int i = 0; i < idx * 2; i++) r.skip();
+        size_t len;
+        auto key = r.read_string(len);
+        return string_ref(key, len);
+    }
+
+    snapshot_value snapshot_value::map_value(unsigned int idx) const
+    {
+        if(!is_map()) throw exception("not a map");
+        auto r = reader();
+        if(idx >= r.read_map_header()) throw exception("map index out of range");
+        for(unsigned int i = 0; i < idx * 2 + 1; i++) r.skip();
+        return entry(r);
+    }
+
+    snapshot_value snapshot_value::map_entry(string_ref key) const
+    {
+        if(!is_map()) throw exception("not a map");
+        auto r = reader();
+        auto n = r.read_map_header();
+        for(size_t i = 0; i < n; i++) {
+            size_t len;
+            auto k = r.read_string(len);
+            if(string_ref(k, len) == key) return entry(r);
+            r.skip();
+        }
+        return snapshot_value();
+    }
+
+    long long snapshot_value::node_id() const
+    {
+        return structure(0x4E, "node").read_int();
+    }
+
+    unsigned int snapshot_value::node_label_count() const
+    {
+        auto r = structure(0x4E, "node");
+        r.skip();
+        return static_cast<unsigned int>(r.read_list_header());
+    }
+
+    string_ref snapshot_value::node_label(unsigned int idx) const
+    {
+        auto r = structure(0x4E, "node");
+        r.skip();
+        if(idx >= r.read_list_header()) throw exception("label index out of range");
+        for(unsigned int i = 0; i < idx; i++) r.skip();
+        size_t len;
+        auto label = r.read_string(len);
+        return string_ref(label, len);
+    }
+
+    bool snapshot_value::node_has_label(string_ref label) const
+    {
+        auto r = structure(0x4E, "node");
+        r.skip();
+        auto n = r.read_list_header();
+        for(size_t i = 0; i < n; i++) {
+            size_t len;
+            auto l = r.read_string(len);
+            if(string_ref(l, len) == label) return true;
+        }
+        return false;
+    }
+
+    snapshot_value snapshot_value::node_properties_ref() const
+    {
+        auto r = structure(0x4E, "node");
+        r.skip();
+        r.skip();
+        return entry(r);
+    }
+
+    long long snapshot_value::relationship_id() const
+    {
+        return structure(0x52, "relationship").read_int();
+    }
+
+    long long snapshot_value::relationship_start_node_id() const
+    {
+        auto r = structure(0x52, "relationship");
+        r.skip();
+        return r.read_int();
+    }
+
+    long long snapshot_value::relationship_end_node_id() const
+    {
+        auto r = structure(0x52, "relationship");
+        r.skip();
+        r.skip();
+        return r.read_int();
+    }
+
+    string_ref snapshot_value::relationship_type_ref() const
+    {
+        auto r = structure(0x52, "relationship");
+        for(int i = 0; i < 3; i++) r.skip();
+        size_t len;
+        auto type = r.read_string(len);
+        return string_ref(type, len);
+    }
+
+    snapshot_value snapshot_value::relationship_properties_ref() const
+    {
+        auto r = structure(0x52, "relationship");
+        for(int i = 0; i < 4; i++) r.skip();
+        return entry(r);
+    }
+
+    value snapshot_value::to_owned() const
+    {
+        return reader().read_value();
+    }
+
+    string_ref snapshot_value::raw() const
+    {
+        return string_ref(reinterpret_cast<const char*>(ptr), stop - ptr);
+    }
+
+    snapshot_writer::snapshot_writer(const std::string& ppath, const std::vector<std::string>& fieldnames)
+        : file(nullptr), path(ppath), fields(static_cast<unsigned int>(fieldnames.size())), pos(0)
+    {
+        file = fopen(path.c_str(), "wb");
+        if(file == nullptr) throw exception("failed to open " + path + ": " + strerror(errno));
+        try {
+            // Placeholder header, close() fills in the counts
+            std::vector<uint8_t> header(snapshot_header_size, 0);
+            put(header);
+            for(auto& name : fieldnames) buf.write_string(name);
+            put(buf.data());
+            buf.clear();
+        } catch(...) {
+            fclose(file);
+            throw;
+        }
+    }
+
+    static std::vector<std::string> snapshot_fieldnames(result_stream& stream)
+    {
+        std::vector<std::string> res;
+        auto n = stream.nfields();
+        res.reserve(n);
+        for(unsigned int i = 0; i < n; i++) res.push_back(stream.fieldname(i));
+        return res;
+    }
+
+    snapshot_writer::snapshot_writer(const std::string& ppath, result_stream& stream)
+        : snapshot_writer(ppath, snapshot_fieldnames(stream))
+    {}
+
+    snapshot_writer::~snapshot_writer()
+    {
+        try {
+            close();
+        } catch(...) {}
+    }
+
+    void snapshot_writer::put(const std::vector<uint8_t>& data)
+    {
+        if(data.empty()) return;
+        if(fwrite(data.data(), 1, data.size(), file) != data.size())
+            throw exception("failed to write " + path + ": " + strerror(errno));
+        pos += data.size();
+    }
+
+    void snapshot_writer::write(const result& row)
+    {
+        if(file == nullptr) throw exception("snapshot already closed");
+        // Reserve the length prefix, patched once the record is encoded
+        buf.clear();
+        buf.data().resize(4);
+        for(unsigned int i = 0; i < fields; i++) buf.write(row.field_ref(i));
+        auto len = buf.data().size() - 4;
+        if(len > UINT32_MAX) throw exception("snapshot record too large");
+        snapshot_put_le(buf.data().data(), len, 4);
+        offsets.push_back(pos);
+        put(buf.data());
+    }
+
+    unsigned long long snapshot_writer::write_all(result_stream& stream)
+    {
+        unsigned long long n = 0;
+        while(auto row = stream.fetch_next()) {
+            write(row);
+            n++;
+        }
+        return n;
+    }
+
+    void snapshot_writer::close()
+    {
+        if(file == nullptr) return;
+        FILE* f = file;
+        try {
+            auto index_offset = pos;
+            std::vector<uint8_t> index(offsets.size() * 8);
+            for(size_t i = 0; i < offsets.size(); i++) snapshot_put_le(index.data() + i * 8, offsets[i], 8);
+            put(index);
+            uint8_t header[snapshot_header_size];
+            memcpy(header, snapshot_magic, sizeof(snapshot_magic));
+            snapshot_put_le(header + 8, snapshot_version, 4);
+            snapshot_put_le(header + 12, fields, 4);
+            snapshot_put_le(header + 16, offsets.size(), 8);
+            snapshot_put_le(header + 24, index_offset, 8);
+            if(fseek(f, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), f) != sizeof(header))
+                throw exception("failed to write " + path + ": " + strerror(errno));
+        } catch(...) {
+            file = nullptr;
+            fclose(f);
+            throw;
+        }
+        file = nullptr;
+        if(fclose(f) != 0) throw exception("failed to write " + path + ": " + strerror(errno));
+    }
+
+    snapshot::snapshot(const std::string& path)
+        : data(nullptr), len(0), records(0), index(nullptr)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw exception("failed to open " + path + ": " + strerror(errno));
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw exception("failed to stat " + path + ": " + strerror(err));
+        }
+        if(static_cast<size_t>(st.st_size) < snapshot_header_size) {
+            ::close(fd);
+            throw exception(path + " is not a snapshot file");
+        }
+        len = static_cast<size_t>(st.st_size);
+        auto map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if(map == MAP_FAILED) throw exception("failed to map " + path + ": " + strerror(err));
+        data = static_cast<const uint8_t*>(map);
+        try {
+            if(memcmp(data, snapshot_magic, sizeof(snapshot_magic)) != 0) throw exception(path + " is not a snapshot file");
+            if(snapshot_get_le(data + 8, 4) != snapshot_version) throw exception(path + " has an unsupported snapshot version");
+            auto nfields = snapshot_get_le(data + 12, 4);
+            records = snapshot_get_le(data + 16, 8);
+            auto index_offset = snapshot_get_le(data + 24, 8);
+            // An unfinished writer leaves the index offset at zero
+            if(index_offset < snapshot_header_size || index_offset > len || (len - index_offset) / 8 < records)
+                throw exception(path + " is truncated");
+            index = data + index_offset;
+            packstream_reader r(data + snapshot_header_size, index_offset - snapshot_header_size);
+            for(uint64_t i = 0; i < nfields; i++) names.push_back(r.read_string());
+        } catch(...) {
+            munmap(const_cast<uint8_t*>(data), len);
+            throw;
+        }
+    }
+
+    snapshot::~snapshot()
+    {
+        if(data != nullptr) munmap(const_cast<uint8_t*>(data), len);
+    }
+
+    snapshot::snapshot(snapshot&& other) noexcept
+        : data(other.data), len(other.len), names(std::move(other.names)), records(other.records), index(other.index)
+    {
+        other.data = nullptr;
+        other.len = 0;
+        other.records = 0;
+        other.index = nullptr;
+    }
+
+    snapshot& snapshot::operator=(snapshot&& other) noexcept
+    {
+        if(this != &other) {
+            if(data != nullptr) munmap(const_cast<uint8_t*>(data), len);
+            data = other.data;
+            len = other.len;
+            names = std::move(other.names);
+            records = other.records;
+            index = other.index;
+            other.data = nullptr;
+            other.len = 0;
+            other.records = 0;
+            other.index = nullptr;
+        }
+        return *this;
+    }
+
+    const std::string& snapshot::fieldname(unsigned int idx) const
+    {
+        if(idx >= names.size()) throw exception("field index out of range");
+        return names[idx];
+    }
+
+    string_ref snapshot::record(unsigned long long idx) const
+    {
+        if(idx >= records) throw exception("record index out of range");
+        auto offset = snapshot_get_le(index + idx * 8, 8);
+        auto limit = static_cast<uint64_t>(index - data);
+        if(offset < snapshot_header_size || limit - offset < 4) throw exception("corrupt snapshot record");
+        auto size = snapshot_get_le(data + offset, 4);
+        if(limit - offset - 4 < size) throw exception("corrupt snapshot record");
+        return string_ref(reinterpret_cast<const char*>(data + offset + 4), size);
+    }
+
+    snapshot_cursor::snapshot_cursor(const snapshot& s) noexcept
+        : snap(&s)
+    {}
+
+    bool snapshot_cursor::next()
+    {
+        on_row = false;
+        current.clear();
+        if(rows >= snap->size()) return false;
+        auto rec = snap->record(rows);
+        auto begin = reinterpret_cast<const uint8_t*>(rec.data());
+        packstream_reader r(begin, rec.size());
+        for(unsigned int i = 0; i < snap->nfields(); i++) {
+            auto start = r.position();
+            r.skip();
+            current.emplace_back(start, r.position());
+        }
+        rows++;
+        on_row = true;
+        return true;
+    }
+
+    void snapshot_cursor::seek(unsigned long long idx) noexcept
+    {
+        on_row = false;
+        current.clear();
+        rows = idx;
+    }
+
+    const snapshot_value& snapshot_cursor::field(unsigned int idx) const
+    {
+        if(!on_row) throw exception("cursor is not positioned on a row");
+        if(idx >= current.size()) throw exception("field index out of range");
+        return current[idx];
+    }
+
+    value snapshot_cursor::copy_field(unsigned int idx) const
+    {
+        return field(idx).to_owned();
+    }
+
+    std::vector<value> snapshot_cursor::copy_row() const
+    {
+        if(!on_row) throw exception("cursor is not positioned on a row");
+        std::vector<value> res;
+        res.reserve(current.size());
+        for(auto& v : current) res.push_back(v.to_owned());
+        return res;
+    }
+}
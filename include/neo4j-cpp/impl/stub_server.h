@@ -0,0 +1,265 @@
+#pragma once
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "../stub_server.h"
+#include "../packstream.h"
+#include "../value_ref.h"
+#include "../exception.h"
+
+namespace neo4j {
+    stub_server::stub_server(handler h, uint16_t port)
+        : fn(std::move(h))
+    {
+        listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if(listen_fd < 0) throw exception(strerror(errno));
+        int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        socklen_t len = sizeof(addr);
+        if(::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(listen_fd, 64) != 0
+            || ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            int err = errno;
+            ::close(listen_fd);
+            throw exception(strerror(err));
+        }
+        port_no = ntohs(addr.sin_port);
+        acceptor = std::thread([this](){ accept_loop(); });
+    }
+
+    stub_server::~stub_server()
+    {
+        stop();
+    }
+
+    void stub_server::stop()
+    {
+        if(stopping.exchange(true)) return;
+        ::shutdown(listen_fd, SHUT_RDWR);
+        acceptor.join();
+        ::close(listen_fd);
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            for(auto fd : client_fds) ::shutdown(fd, SHUT_RDWR);
+            threads.swap(clients);
+        }
+        for(auto& t : threads) t.join();
+    }
+
+    void stub_server::accept_loop()
+    {
+        while(!stopping) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if(fd < 0) {
+                if(errno == EINTR) continue;
+                return;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::lock_guard<std::mutex> lck(mtx);
+            if(stopping) {
+                ::close(fd);
+                return;
+            }
+            nconnections++;
+            client_fds.push_back(fd);
+            clients.emplace_back([this, fd](){ serve(fd); });
+        }
+    }
+
+    static bool stub_read_all(int fd, void* buf, size_t len)
+    {
+        auto p = static_cast<uint8_t*>(buf);
+        while(len > 0) {
+            auto n = ::recv(fd, p, len, 0);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            p += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    static bool stub_write_all(int fd, const void* buf, size_t len)
+    {
+        auto p = static_cast<const uint8_t*>(buf);
+        while(len > 0) {
+            auto n = ::send(fd, p, len, MSG_NOSIGNAL);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            p += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    // Append a message to out using Bolt chunking
+    static void stub_chunk(const std::vector<uint8_t>& msg, std::vector<uint8_t>& out)
+    {
+        size_t off = 0;
+        while(off < msg.size()) {
+            size_t n = std::min<size_t>(msg.size() - off, 0xffff);
+            out.push_back(static_cast<uint8_t>(n >> 8));
+            out.push_back(static_cast<uint8_t>(n));
+            out.insert(out.end(), msg.begin() + off, msg.begin() + off + n);
+            off += n;
+        }
+        out.push_back(0);
+        out.push_back(0);
+    }
+
+    void stub_server::serve(int fd)
+    {
+        uint8_t handshake[20];
+        static const uint8_t magic[4] = {0x60, 0x60, 0xB0, 0x17};
+        bool ok = stub_read_all(fd, handshake, sizeof(handshake)) && memcmp(handshake, magic, 4) == 0;
+        uint8_t version[4] = {0, 0, 0, 0};
+        for(size_t i = 4; ok && i < 20; i += 4) {
+            if(handshake[i] == 0 && handshake[i + 1] == 0 && handshake[i + 2] == 0 && handshake[i + 3] == 1) version[3] = 1;
+        }
+        ok = ok && stub_write_all(fd, version, sizeof(version)) && version[3] == 1;
+
+        bool failed = false;
+        bool has_result = false;
+        response current;
+        std::vector<uint8_t> msg, out;
+        packstream_writer w;
+        auto reply = [&](uint8_t signature, std::function<void()> body) {
+            w.clear();
+            w.write_struct_header(body ? 1 : 0, signature);
+            if(body) body();
+            stub_chunk(w.data(), out);
+        };
+        auto success = [&](std::function<void()> meta) {
+            reply(0x70, [&](){
+                if(meta) meta();
+                else w.write_map_header(0);
+            });
+        };
+
+        while(ok && !stopping) {
+            // Read one chunked message
+            msg.clear();
+            while(true) {
+                uint8_t hdr[2];
+                if(!stub_read_all(fd, hdr, 2)) { ok = false; break; }
+                size_t n = (hdr[0] << 8) | hdr[1];
+                if(n == 0) break;
+                size_t off = msg.size();
+                msg.resize(off + n);
+                if(!stub_read_all(fd, msg.data() + off, n)) { ok = false; break; }
+            }
+            if(!ok) break;
+            if(msg.empty()) continue;
+
+            out.clear();
+            try {
+                packstream_reader r(msg.data(), msg.size());
+                uint8_t signature;
+                r.read_struct_header(signature);
+                switch(signature) {
+                    case 0x01: // INIT
+                        success([&](){
+                            w.write_map_header(1);
+                            w.write_string("server");
+                            w.write_string("Neo4j/3.5.0");
+                        });
+                        break;
+                    case 0x10: { // RUN
+                        if(failed) {
+                            reply(0x7E, nullptr);
+                            break;
+                        }
+                        auto query = r.read_string();
+                        auto params = r.read_value();
+                        nstatements++;
+                        current = fn(query, params);
+                        if(!current.failure_code.empty()) {
+                            failed = true;
+                            has_result = false;
+                            reply(0x7F, [&](){
+                                w.write_map_header(2);
+                                w.write_string("code");
+                                w.write_string(current.failure_code);
+                                w.write_string("message");
+                                w.write_string(current.failure_message);
+                            });
+                            break;
+                        }
+                        has_result = true;
+                        success([&](){
+                            w.write_map_header(2);
+                            w.write_string("fields");
+                            w.write_list_header(current.fields.size());
+                            for(auto& f : current.fields) w.write_string(f);
+                            w.write_string("result_available_after");
+                            w.write_int(0);
+                        });
+                        break;
+                    }
+                    case 0x3F: // PULL_ALL
+                    case 0x2F: { // DISCARD_ALL
+                        if(failed || !has_result) {
+                            reply(0x7E, nullptr);
+                            break;
+                        }
+                        has_result = false;
+                        if(current.delay.count() > 0) std::this_thread::sleep_for(current.delay);
+                        if(signature == 0x3F) {
+                            for(auto& rec : current.records) {
+                                reply(0x71, [&](){
+                                    w.write_list_header(rec.size());
+                                    for(auto& v : rec) w.write(v.ref());
+                                });
+                                // Flush large results in pieces
+                                if(out.size() > 65536) {
+                                    if(!stub_write_all(fd, out.data(), out.size())) { ok = false; break; }
+                                    out.clear();
+                                }
+                            }
+                        }
+                        success([&](){
+                            w.write_map_header(2);
+                            w.write_string("type");
+                            w.write_string(current.type);
+                            w.write_string("result_consumed_after");
+                            w.write_int(0);
+                        });
+                        break;
+                    }
+                    case 0x0E: // ACK_FAILURE
+                    case 0x0F: // RESET
+                        failed = false;
+                        has_result = false;
+                        success(nullptr);
+                        break;
+                    default:
+                        ok = false;
+                        break;
+                }
+            } catch(const std::exception&) {
+                ok = false;
+            }
+            if(ok && !out.empty()) ok = stub_write_all(fd, out.data(), out.size());
+        }
+
+        std::lock_guard<std::mutex> lck(mtx);
+        for(auto it = client_fds.begin(); it != client_fds.end(); ++it) {
+            if(*it == fd) {
+                client_fds.erase(it);
+                break;
+            }
+        }
+        ::close(fd);
+    }
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include <neo4j-client.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "../transport.h"
+
+namespace neo4j {
+    transport_interrupt::transport_interrupt()
+    {
+        if(::pipe(pipe_fds) != 0) {
+            pipe_fds[0] = pipe_fds[1] = -1;
+            return;
+        }
+        for(int fd : pipe_fds) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+
+    transport_interrupt::~transport_interrupt()
+    {
+        if(pipe_fds[0] < 0) return;
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+
+    void transport_interrupt::interrupt() noexcept
+    {
+        if(flag.exchange(true)) return;
+        char c = 0;
+        ssize_t res = ::write(pipe_fds[1], &c, 1);
+        (void)res;
+    }
+
+    void transport_interrupt::clear() noexcept
+    {
+        // Cleared before draining, so a concurrent interrupt is never lost
+        flag = false;
+        drain();
+    }
+
+    void transport_interrupt::drain() noexcept
+    {
+        char buf[16];
+        while(::read(pipe_fds[0], buf, sizeof(buf)) > 0) {}
+    }
+
+    static std::shared_ptr<transport_interrupt>*& transport_capture_target() noexcept
+    {
+        static thread_local std::shared_ptr<transport_interrupt>* target = nullptr;
+        return target;
+    }
+
+    transport_interrupt::capture::capture(std::shared_ptr<transport_interrupt>& target) noexcept
+        : prev(transport_capture_target())
+    {
+        transport_capture_target() = &target;
+    }
+
+    transport_interrupt::capture::~capture()
+    {
+        transport_capture_target() = prev;
+    }
+
+    void transport_interrupt::capture::offer(const std::shared_ptr<transport_interrupt>& handle) noexcept
+    {
+        auto target = transport_capture_target();
+        if(target != nullptr) *target = handle;
+    }
+
+    struct transport_stream {
+        struct neo4j_iostream base;
+        int fd;
+        std::shared_ptr<transport_interrupt> intr;
+    };
+
+    // Block until the socket is ready, returns -1 with ECANCELED once interrupted
+    static int transport_wait(transport_stream* s, short events)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = s->fd;
+        fds[0].events = events;
+        fds[1].fd = s->intr->wait_fd();
+        fds[1].events = POLLIN;
+        while(true) {
+            if(s->intr->is_interrupted()) {
+                errno = ECANCELED;
+                return -1;
+            }
+            fds[0].revents = fds[1].revents = 0;
+            int res = ::poll(fds, 2, -1);
+            if(res < 0 && errno == EINTR) continue;
+            if(res < 0) return -1;
+            if(fds[0].revents != 0) return 0;
+            // Woken without the flag, an interrupt() raced clear()
+            if(!s->intr->is_interrupted()) s->intr->drain();
+        }
+    }
+
+    template<typename Fn>
+    static ssize_t transport_io(transport_stream* s, short events, Fn&& fn)
+    {
+        while(true) {
+            if(s->intr->is_interrupted()) {
+                errno = ECANCELED;
+                return -1;
+            }
+            ssize_t res = fn();
+            if(res >= 0) return res;
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+            if(transport_wait(s, events) != 0) return -1;
+        }
+    }
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int transport_send_flags = MSG_NOSIGNAL;
+#else
+    static constexpr int transport_send_flags = 0;
+#endif
+
+    static ssize_t transport_read(struct neo4j_iostream* self, void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<transport_stream*>(self);
+        return transport_io(s, POLLIN, [&](){ return ::recv(s->fd, buf, nbyte, 0); });
+    }
+
+    static ssize_t transport_readv(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<transport_stream*>(self);
+        return transport_io(s, POLLIN, [&](){ return ::readv(s->fd, iov, iovcnt); });
+    }
+
+    static ssize_t transport_write(struct neo4j_iostream* self, const void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<transport_stream*>(self);
+        return transport_io(s, POLLOUT, [&](){ return ::send(s->fd, buf, nbyte, transport_send_flags); });
+    }
+
+    static ssize_t transport_writev(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<transport_stream*>(self);
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = iovcnt;
+        return transport_io(s, POLLOUT, [&](){ return ::sendmsg(s->fd, &msg, transport_send_flags); });
+    }
+
+    static int transport_flush(struct neo4j_iostream*)
+    {
+        return 0;
+    }
+
+    static int transport_close(struct neo4j_iostream* self)
+    {
+        auto s = reinterpret_cast<transport_stream*>(self);
+        int res = ::close(s->fd);
+        delete s;
+        return res;
+    }
+
+    static int transport_open_socket(const char* hostname, unsigned int port, neo4j_config_t* config)
+    {
+        char service[16];
+        snprintf(service, sizeof(service), "%u", port);
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* addrs = nullptr;
+        int err = ::getaddrinfo(hostname, service, &hints, &addrs);
+        if(err != 0) {
+            if(err != EAI_SYSTEM) errno = NEO4J_UNKNOWN_HOST;
+            return -1;
+        }
+        int fd = -1;
+        for(auto ai = addrs; ai != nullptr; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if(fd < 0) continue;
+            int one = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            // Applied before connect, so the window scale is negotiated accordingly
+            int rcv = static_cast<int>(neo4j_config_get_so_rcvbuf_size(config));
+            int snd = static_cast<int>(neo4j_config_get_so_sndbuf_size(config));
+            if(rcv > 0) ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+            if(snd > 0) ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &snd, sizeof(snd));
+            if(::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+            int saved = errno;
+            ::close(fd);
+            fd = -1;
+            errno = saved;
+        }
+        ::freeaddrinfo(addrs);
+        if(fd < 0) return -1;
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        if(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+            int saved = errno;
+            ::close(fd);
+            errno = saved;
+            return -1;
+        }
+        return fd;
+    }
+
+    static struct neo4j_iostream* transport_connect(struct neo4j_connection_factory*, const char* hostname,
+        unsigned int port, neo4j_config_t* config, uint_fast32_t, struct neo4j_logger*)
+    {
+        auto s = new (std::nothrow) transport_stream();
+        if(s == nullptr) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        try {
+            s->intr = std::make_shared<transport_interrupt>();
+        } catch(...) {
+            delete s;
+            errno = ENOMEM;
+            return nullptr;
+        }
+        if(s->intr->wait_fd() < 0) {
+            int saved = errno;
+            delete s;
+            errno = saved;
+            return nullptr;
+        }
+        s->fd = transport_open_socket(hostname, port, config);
+        if(s->fd < 0) {
+            int saved = errno;
+            delete s;
+            errno = saved;
+            return nullptr;
+        }
+        s->base.read = transport_read;
+        s->base.readv = transport_readv;
+        s->base.write = transport_write;
+        s->base.writev = transport_writev;
+        s->base.flush = transport_flush;
+        s->base.close = transport_close;
+        transport_interrupt::capture::offer(s->intr);
+        return &s->base;
+    }
+
+    struct neo4j_connection_factory* interruptible_tcp_factory() noexcept
+    {
+        static struct neo4j_connection_factory factory = { transport_connect };
+        return &factory;
+    }
+}
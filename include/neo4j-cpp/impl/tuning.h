@@ -0,0 +1,210 @@
+#pragma once
+#include <neo4j-client.h>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <new>
+#include "../tuning.h"
+#include "../config.h"
+
+namespace neo4j {
+    struct tuning_factory_base {
+        struct neo4j_connection_factory base;
+        buffer_tuner::state* owner;
+    };
+
+    // One direction of traffic, sized independently
+    struct tuning_direction {
+        std::atomic<size_t> size;
+        std::atomic<unsigned long long> ops{0};
+        std::atomic<unsigned long long> full{0};
+        std::atomic<unsigned long long> bytes{0};
+        // Window totals, reset after each decision
+        std::atomic<unsigned int> window_ops{0};
+        std::atomic<unsigned int> window_full{0};
+        std::atomic<unsigned long long> window_bytes{0};
+
+        explicit tuning_direction(size_t initial) : size(initial) {}
+    };
+
+    struct buffer_tuner::state : std::enable_shared_from_this<buffer_tuner::state> {
+        tuning_factory_base factory;
+        struct neo4j_connection_factory* inner;
+        buffer_tuning_options opts;
+        tuning_direction in, out;
+        std::atomic<unsigned long long> connections{0};
+        std::atomic<unsigned long long> read_ns{0};
+        std::atomic<unsigned long long> adjustments{0};
+
+        state(const buffer_tuning_options& o, struct neo4j_connection_factory* f)
+            : inner(f != nullptr ? f : &neo4j_std_connection_factory), opts(o), in(o.initial_rcvbuf), out(o.initial_sndbuf)
+        {
+            if(opts.window == 0) opts.window = 1;
+        }
+
+        void observe(tuning_direction& d, size_t requested, ssize_t res) {
+            if(res <= 0) return;
+            d.ops.fetch_add(1, std::memory_order_relaxed);
+            d.bytes.fetch_add(res, std::memory_order_relaxed);
+            bool full = static_cast<size_t>(res) >= requested;
+            if(full) d.full.fetch_add(1, std::memory_order_relaxed);
+            d.window_bytes.fetch_add(res, std::memory_order_relaxed);
+            if(full) d.window_full.fetch_add(1, std::memory_order_relaxed);
+            if(d.window_ops.fetch_add(1, std::memory_order_acq_rel) + 1 != opts.window) return;
+            // The thread completing the window decides and starts the next one
+            auto nfull = d.window_full.exchange(0);
+            auto nbytes = d.window_bytes.exchange(0);
+            d.window_ops.store(0);
+            auto size = d.size.load();
+            auto avg = nbytes / opts.window;
+            size_t next = size;
+            if(nfull * 2 > opts.window) next = size * 2;
+            else if(nfull * 20 < opts.window && avg * 8 < size) next = size / 2;
+            if(next > opts.max_size) next = opts.max_size;
+            if(next < opts.min_size) next = opts.min_size;
+            if(next != size && d.size.compare_exchange_strong(size, next)) adjustments++;
+        }
+    };
+
+    struct tuning_stream {
+        struct neo4j_iostream base;
+        struct neo4j_iostream* inner;
+        // Connections may outlive the tuner
+        std::shared_ptr<buffer_tuner::state> owner;
+    };
+
+    static ssize_t tuning_read(struct neo4j_iostream* self, void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        auto start = std::chrono::steady_clock::now();
+        auto res = s->inner->read(s->inner, buf, nbyte);
+        s->owner->read_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        s->owner->observe(s->owner->in, nbyte, res);
+        return res;
+    }
+
+    static size_t tuning_iov_len(const struct iovec* iov, unsigned int iovcnt)
+    {
+        size_t res = 0;
+        for(unsigned int i = 0; i < iovcnt; i++) res += iov[i].iov_len;
+        return res;
+    }
+
+    static ssize_t tuning_readv(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        auto start = std::chrono::steady_clock::now();
+        auto res = s->inner->readv(s->inner, iov, iovcnt);
+        s->owner->read_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        s->owner->observe(s->owner->in, tuning_iov_len(iov, iovcnt), res);
+        return res;
+    }
+
+    static ssize_t tuning_write(struct neo4j_iostream* self, const void* buf, size_t nbyte)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        auto res = s->inner->write(s->inner, buf, nbyte);
+        // Writes as large as the send buffer count as full
+        s->owner->observe(s->owner->out, s->owner->out.size, res);
+        return res;
+    }
+
+    static ssize_t tuning_writev(struct neo4j_iostream* self, const struct iovec* iov, unsigned int iovcnt)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        auto res = s->inner->writev(s->inner, iov, iovcnt);
+        s->owner->observe(s->owner->out, s->owner->out.size, res);
+        return res;
+    }
+
+    static int tuning_flush(struct neo4j_iostream* self)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        return s->inner->flush(s->inner);
+    }
+
+    static int tuning_close(struct neo4j_iostream* self)
+    {
+        auto s = reinterpret_cast<tuning_stream*>(self);
+        int res = s->inner->close(s->inner);
+        delete s;
+        return res;
+    }
+
+    static struct neo4j_iostream* tuning_connect(struct neo4j_connection_factory* factory, const char* hostname,
+        unsigned int port, neo4j_config_t* config, uint_fast32_t flags, struct neo4j_logger* logger)
+    {
+        auto owner = reinterpret_cast<tuning_factory_base*>(factory)->owner;
+        auto inner = owner->inner->tcp_connect(owner->inner, hostname, port, config, flags, logger);
+        if(inner == nullptr) return nullptr;
+        auto s = new (std::nothrow) tuning_stream();
+        if(s == nullptr) {
+            inner->close(inner);
+            errno = ENOMEM;
+            return nullptr;
+        }
+        s->base.read = tuning_read;
+        s->base.readv = tuning_readv;
+        s->base.write = tuning_write;
+        s->base.writev = tuning_writev;
+        s->base.flush = tuning_flush;
+        s->base.close = tuning_close;
+        s->inner = inner;
+        s->owner = owner->shared_from_this();
+        owner->connections++;
+        return &s->base;
+    }
+
+    buffer_tuner::buffer_tuner(const buffer_tuning_options& opts, struct neo4j_connection_factory* inner)
+        : st(std::make_shared<state>(opts, inner))
+    {
+        st->factory.base.tcp_connect = tuning_connect;
+        st->factory.owner = st.get();
+    }
+
+    buffer_tuner::~buffer_tuner()
+    {}
+
+    void buffer_tuner::apply(config& conf) const
+    {
+        auto rcv = rcvbuf_size(), snd = sndbuf_size();
+        conf.set_connection_factory(get());
+        conf.set_rcvbuf_size(rcv);
+        conf.set_sndbuf_size(snd);
+        if(!st->opts.tune_socket) return;
+        // Four buffers in flight keep the pipe full while libneo4j decodes
+        conf.set_so_rcvbuf_size(rcv >= st->opts.socket_threshold ? rcv * 4 : 0);
+        conf.set_so_sndbuf_size(snd >= st->opts.socket_threshold ? snd * 4 : 0);
+    }
+
+    struct neo4j_connection_factory* buffer_tuner::get() const noexcept
+    {
+        return &st->factory.base;
+    }
+
+    size_t buffer_tuner::rcvbuf_size() const noexcept
+    {
+        return st->in.size;
+    }
+
+    size_t buffer_tuner::sndbuf_size() const noexcept
+    {
+        return st->out.size;
+    }
+
+    traffic_stats buffer_tuner::stats() const noexcept
+    {
+        traffic_stats res;
+        res.connections = st->connections;
+        res.bytes_received = st->in.bytes;
+        res.bytes_sent = st->out.bytes;
+        res.reads = st->in.ops;
+        res.full_reads = st->in.full;
+        res.writes = st->out.ops;
+        res.read_ns = st->read_ns;
+        res.rcvbuf_size = st->in.size;
+        res.sndbuf_size = st->out.size;
+        res.adjustments = st->adjustments;
+        return res;
+    }
+}
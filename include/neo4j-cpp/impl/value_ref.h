@@ -0,0 +1,513 @@
+#pragma once
+#include <neo4j-client.h>
+#include <new>
+#include <cstring>
+#include <type_traits>
+#include "../value_ref.h"
+#include "../value.h"
+#include "../exception.h"
+
+namespace neo4j {
+    const struct neo4j_value& value_ref::get() const noexcept
+    {
+        static_assert(sizeof(struct neo4j_value) <= sizeof(raw), "neo4j_value does not fit into value_ref");
+        static_assert(alignof(struct neo4j_value) <= 8, "neo4j_value is overaligned");
+        return *reinterpret_cast<const struct neo4j_value*>(raw);
+    }
+
+    long long value_ref::identity_value(struct neo4j_value id)
+    {
+        // libneo4j has no public accessor for identities, they share the
+        // integer representation which neo4j_int_value refuses for them
+        static_assert(std::is_same<decltype(id._vdata._int), uint64_t>::value, "unexpected neo4j_value layout");
+        static_assert(sizeof(union _neo4j_value_data) == 8, "unexpected neo4j_value layout");
+        if(neo4j_type(id) != NEO4J_IDENTITY) throw exception("not an identity");
+        return static_cast<long long>(id._vdata._int);
+    }
+
+    std::string value_ref::string_value(struct neo4j_value str)
+    {
+        return std::string(neo4j_ustring_value(str), neo4j_string_length(str));
+    }
+
+    value_ref::value_ref() noexcept
+        : result(nullptr)
+    {
+        new (raw) struct neo4j_value(neo4j_null);
+    }
+
+    value_ref::value_ref(struct neo4j_result* parent, struct neo4j_value val) noexcept
+        : result(parent)
+    {
+        new (raw) struct neo4j_value(val);
+    }
+
+    struct neo4j_value value_ref::get_value() const noexcept
+    {
+        return get();
+    }
+
+    static const value_type* value_type_table() noexcept
+    {
+        // The NEO4J_* types are not compile time constants, so the table is filled on first use
+        static const struct table {
+            value_type types[256];
+            table() noexcept {
+                for(auto& t : types) t = value_type::type_unknown;
+                types[NEO4J_NULL] = value_type::type_null;
+                types[NEO4J_BOOL] = value_type::type_bool;
+                types[NEO4J_INT] = value_type::type_int;
+                types[NEO4J_FLOAT] = value_type::type_float;
+                types[NEO4J_STRING] = value_type::type_string;
+                types[NEO4J_BYTES] = value_type::type_bytes;
+                types[NEO4J_LIST] = value_type::type_list;
+                types[NEO4J_MAP] = value_type::type_map;
+                types[NEO4J_NODE] = value_type::type_node;
+                types[NEO4J_RELATIONSHIP] = value_type::type_relationship;
+                types[NEO4J_PATH] = value_type::type_path;
+                types[NEO4J_IDENTITY] = value_type::type_identity;
+            }
+        } t;
+        return t.types;
+    }
+
+    value_type value_ref::get_type() const noexcept
+    {
+        return value_type_table()[neo4j_type(get())];
+    }
+
+    bool value_ref::to_bool() const
+    {
+        if(!is_bool()) throw exception("not a bool");
+        return neo4j_bool_value(get());
+    }
+
+    long long value_ref::to_int() const
+    {
+        if(!is_int()) throw exception("not an int");
+        return neo4j_int_value(get());
+    }
+
+    double value_ref::to_float() const
+    {
+        if(!is_float()) throw exception("not a float");
+        return neo4j_float_value(get());
+    }
+
+    std::string value_ref::to_string() const
+    {
+        if(!is_string()) throw exception("not a string");
+        return string_value(get());
+    }
+
+    string_ref value_ref::to_string_ref() const
+    {
+        if(!is_string()) throw exception("not a string");
+        return string_ref(neo4j_ustring_value(get()), neo4j_string_length(get()));
+    }
+
+    string_ref value_ref::to_bytes_ref() const
+    {
+        if(!is_bytes()) throw exception("not bytes");
+        return string_ref(neo4j_bytes_value(get()), neo4j_bytes_length(get()));
+    }
+
+    std::vector<uint8_t> value_ref::to_bytes() const
+    {
+        if(!is_bytes()) throw exception("not bytes");
+        std::vector<uint8_t> res;
+        res.resize(neo4j_bytes_length(get()));
+        memcpy(res.data(), neo4j_bytes_value(get()), res.size());
+        return res;
+    }
+
+    long long value_ref::to_identity() const
+    {
+        if(!is_identity()) throw exception("not a identity");
+        return identity_value(get());
+    }
+
+    expected<bool> value_ref::try_to_bool() const noexcept
+    {
+        if(!is_bool()) return std::make_error_code(std::errc::invalid_argument);
+        return neo4j_bool_value(get());
+    }
+
+    expected<long long> value_ref::try_to_int() const noexcept
+    {
+        if(!is_int()) return std::make_error_code(std::errc::invalid_argument);
+        return neo4j_int_value(get());
+    }
+
+    expected<double> value_ref::try_to_float() const noexcept
+    {
+        if(!is_float()) return std::make_error_code(std::errc::invalid_argument);
+        return neo4j_float_value(get());
+    }
+
+    expected<std::string> value_ref::try_to_string() const
+    {
+        if(!is_string()) return std::make_error_code(std::errc::invalid_argument);
+        return string_value(get());
+    }
+
+    expected<long long> value_ref::try_to_identity() const noexcept
+    {
+        if(!is_identity()) return std::make_error_code(std::errc::invalid_argument);
+        return identity_value(get());
+    }
+
+    unsigned int value_ref::list_size() const
+    {
+        if(!is_list()) throw exception("not a list");
+        return neo4j_list_length(get());
+    }
+
+    value_ref value_ref::list_entry(unsigned int idx) const
+    {
+        if(!is_list()) throw exception("not a list");
+        if(idx >= neo4j_list_length(get())) throw std::out_of_range("invalid index");
+        return value_ref(result, neo4j_list_get(get(), idx));
+    }
+
+    expected<value_ref> value_ref::try_list_entry(unsigned int idx) const noexcept
+    {
+        if(!is_list()) return std::make_error_code(std::errc::invalid_argument);
+        if(idx >= neo4j_list_length(get())) return std::make_error_code(std::errc::result_out_of_range);
+        return value_ref(result, neo4j_list_get(get(), idx));
+    }
+
+    std::map<std::string, value_ref> value_ref::to_map() const
+    {
+        if(!is_map()) throw exception("not a map");
+        unsigned int size = neo4j_map_size(get());
+        std::map<std::string, value_ref> res;
+        for(unsigned int i = 0; i < size; i++) {
+            auto entry = neo4j_map_getentry(get(), i);
+            res.insert({string_value(entry->key), value_ref(result, entry->value)});
+        }
+        return res;
+    }
+
+    std::set<std::string> value_ref::map_keys() const
+    {
+        if(!is_map()) throw exception("not a map");
+        unsigned int size = neo4j_map_size(get());
+        std::set<std::string> res;
+        for(unsigned int i = 0; i < size; i++) {
+            auto entry = neo4j_map_getentry(get(), i);
+            res.insert(string_value(entry->key));
+        }
+        return res;
+    }
+
+    unsigned int value_ref::map_size() const
+    {
+        if(!is_map()) throw exception("not a map");
+        return neo4j_map_size(get());
+    }
+
+    string_ref value_ref::map_key(unsigned int idx) const
+    {
+        if(!is_map()) throw exception("not a map");
+        auto entry = neo4j_map_getentry(get(), idx);
+        if(entry == nullptr) throw exception("map index out of range");
+        return string_ref(neo4j_ustring_value(entry->key), neo4j_string_length(entry->key));
+    }
+
+    value_ref value_ref::map_value(unsigned int idx) const
+    {
+        if(!is_map()) throw exception("not a map");
+        auto entry = neo4j_map_getentry(get(), idx);
+        if(entry == nullptr) throw exception("map index out of range");
+        return value_ref(result, entry->value);
+    }
+
+    value_ref value_ref::map_entry(const std::string& key) const
+    {
+        if(!is_map()) throw exception("not a map");
+        struct neo4j_value kval = neo4j_string(key.c_str());
+        return value_ref(result, neo4j_map_kget(get(), kval));
+    }
+
+    long long value_ref::node_id() const
+    {
+        if(!is_node()) throw exception("not a node");
+        return identity_value(neo4j_node_identity(get()));
+    }
+
+    std::set<std::string> value_ref::node_labels() const
+    {
+        if(!is_node()) throw exception("not a node");
+        std::set<std::string> res;
+        auto labels = neo4j_node_labels(get());
+        unsigned int len = neo4j_list_length(labels);
+        for(unsigned int i=0; i< len; i++) {
+            res.insert(string_value(neo4j_list_get(labels, i)));
+        }
+        return res;
+    }
+
+    unsigned int value_ref::node_label_count() const
+    {
+        if(!is_node()) throw exception("not a node");
+        return neo4j_list_length(neo4j_node_labels(get()));
+    }
+
+    string_ref value_ref::node_label(unsigned int idx) const
+    {
+        if(!is_node()) throw exception("not a node");
+        auto labels = neo4j_node_labels(get());
+        if(idx >= neo4j_list_length(labels)) throw exception("label index out of range");
+        auto label = neo4j_list_get(labels, idx);
+        return string_ref(neo4j_ustring_value(label), neo4j_string_length(label));
+    }
+
+    bool value_ref::node_has_label(string_ref label) const
+    {
+        if(!is_node()) throw exception("not a node");
+        auto labels = neo4j_node_labels(get());
+        unsigned int len = neo4j_list_length(labels);
+        for(unsigned int i = 0; i < len; i++) {
+            auto l = neo4j_list_get(labels, i);
+            if(string_ref(neo4j_ustring_value(l), neo4j_string_length(l)) == label) return true;
+        }
+        return false;
+    }
+
+    value_ref value_ref::node_properties_ref() const
+    {
+        if(!is_node()) throw exception("not a node");
+        return value_ref(result, neo4j_node_properties(get()));
+    }
+
+    std::map<std::string, value_ref> value_ref::node_properties() const
+    {
+        if(!is_node()) throw exception("not a node");
+        return value_ref(result, neo4j_node_properties(get())).to_map();
+    }
+
+    long long value_ref::relationship_id() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        return identity_value(neo4j_relationship_identity(get()));
+    }
+
+    long long value_ref::relationship_start_node_id() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        auto id = neo4j_relationship_start_node_identity(get());
+        if(neo4j_type(id) == NEO4J_NULL) return 0;
+        return identity_value(id);
+    }
+
+    long long value_ref::relationship_end_node_id() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        auto id = neo4j_relationship_end_node_identity(get());
+        if(neo4j_type(id) == NEO4J_NULL) return 0;
+        return identity_value(id);
+    }
+
+    std::string value_ref::relationship_type() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        return string_value(neo4j_relationship_type(get()));
+    }
+
+    string_ref value_ref::relationship_type_ref() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        auto type = neo4j_relationship_type(get());
+        return string_ref(neo4j_ustring_value(type), neo4j_string_length(type));
+    }
+
+    value_ref value_ref::relationship_properties_ref() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        return value_ref(result, neo4j_relationship_properties(get()));
+    }
+
+    std::map<std::string, value_ref> value_ref::relationship_properties() const
+    {
+        if(!is_relationship()) throw exception("not a relationship");
+        return value_ref(result, neo4j_relationship_properties(get())).to_map();
+    }
+
+    unsigned int value_ref::path_length() const
+    {
+        if(!is_path()) throw exception("not a path");
+        return neo4j_path_length(get());
+    }
+
+    value_ref value_ref::path_node(unsigned int hops) const
+    {
+        if(!is_path()) throw exception("not a path");
+        return value_ref(result, neo4j_path_get_node(get(), hops));
+    }
+
+    value_ref value_ref::path_relationship(unsigned int hops, bool& forward) const
+    {
+        if(!is_path()) throw exception("not a path");
+        return value_ref(result, neo4j_path_get_relationship(get(), hops, &forward));
+    }
+
+    value_ref value_ref::path_relationship(unsigned int hops) const
+    {
+        bool dummy;
+        return path_relationship(hops, dummy);
+    }
+
+    value value_ref::to_owned() const
+    {
+        switch(get_type()) {
+            case value_type::type_null:
+            case value_type::type_bool:
+            case value_type::type_int:
+            case value_type::type_float:
+            case value_type::type_identity:
+                // Scalars are self contained and do not reference the row
+                return value(nullptr, get());
+            case value_type::type_string: return value(to_string());
+            case value_type::type_bytes: return value(to_bytes());
+            case value_type::type_list: {
+                auto len = list_size();
+                list_builder builder(len);
+                for(unsigned int i=0; i<len; i++) builder.push_back(list_entry(i).to_owned());
+                return builder.build();
+            }
+            case value_type::type_map: {
+                unsigned int size = neo4j_map_size(get());
+                map_builder builder;
+                for(unsigned int i = 0; i < size; i++) {
+                    auto entry = neo4j_map_getentry(get(), i);
+                    builder.set(string_value(entry->key), value_ref(result, entry->value).to_owned());
+                }
+                return builder.build();
+            }
+            case value_type::type_node: {
+                return value::from_struct(value_type::type_node, {
+                    value(nullptr, neo4j_node_identity(get())),
+                    value_ref(result, neo4j_node_labels(get())).to_owned(),
+                    value_ref(result, neo4j_node_properties(get())).to_owned()
+                });
+            }
+            case value_type::type_relationship: {
+                return value::from_struct(value_type::type_relationship, {
+                    value(nullptr, neo4j_relationship_identity(get())),
+                    value(nullptr, neo4j_relationship_start_node_identity(get())),
+                    value(nullptr, neo4j_relationship_end_node_identity(get())),
+                    value_ref(result, neo4j_relationship_type(get())).to_owned(),
+                    value_ref(result, neo4j_relationship_properties(get())).to_owned()
+                });
+            }
+            case value_type::type_path: {
+                // Rebuilt hop by hop, listing a node or relationship once per
+                // occurrence. Relationships in a path may be unbound, so their
+                // ends are taken from the neighbouring nodes.
+                auto len = neo4j_path_length(get());
+                std::vector<value> nodes, rels, sequence;
+                nodes.reserve(len + 1);
+                rels.reserve(len);
+                sequence.reserve(2 * len);
+                value_ref prev(result, neo4j_path_get_node(get(), 0));
+                nodes.push_back(prev.to_owned());
+                for(unsigned int i = 0; i < len; i++) {
+                    bool forward;
+                    auto rel = neo4j_path_get_relationship(get(), i, &forward);
+                    value_ref next(result, neo4j_path_get_node(get(), i + 1));
+                    auto from = forward ? prev.node_id() : next.node_id();
+                    auto to = forward ? next.node_id() : prev.node_id();
+                    rels.push_back(value::from_struct(value_type::type_relationship, {
+                        value(nullptr, neo4j_relationship_identity(rel)),
+                        value(nullptr, neo4j_identity(from)),
+                        value(nullptr, neo4j_identity(to)),
+                        value_ref(result, neo4j_relationship_type(rel)).to_owned(),
+                        value_ref(result, neo4j_relationship_properties(rel)).to_owned()
+                    }));
+                    nodes.push_back(next.to_owned());
+                    long long hop = i + 1;
+                    sequence.push_back(value(forward ? hop : -hop));
+                    sequence.push_back(value(hop));
+                    prev = next;
+                }
+                return value::from_struct(value_type::type_path, {
+                    value(std::move(nodes)), value(std::move(rels)), value(std::move(sequence))
+                });
+            }
+            default:
+                // Retaining the row instead would defeat the copy
+                throw exception("value type " + neo4j::to_string(get_type()) + " can not be copied");
+        }
+    }
+
+    std::string value_ref::dump() const
+    {
+        switch(get_type()) {
+            case value_type::type_null: return "null";
+            case value_type::type_bool: return "bool(" + std::string(to_bool()?"true":"false") + ")";
+            case value_type::type_int: return std::to_string(to_int());
+            case value_type::type_float: return std::to_string(to_float());
+            case value_type::type_string: return "\"" + to_string() + "\"";
+            case value_type::type_bytes: return "bytes(len=" + std::to_string(neo4j_bytes_length(get())) + ")";
+            case value_type::type_list: {
+                std::string res = "[";
+                auto len = list_size();
+                if(len != 0) res += "\n";
+                for(unsigned int i=0; i<len; i++) {
+                    res += list_entry(i).dump();
+                    if(i != len - 1) res += ",\n";
+                    else res += "\n";
+                }
+                res+= "]";
+                return res;
+            }
+            case value_type::type_map: {
+                std::string res = "{";
+                auto map = to_map();
+                if(!map.empty()) res += "\n";
+                for(auto& e: map) {
+                    res += e.first + ": " + e.second.dump() + "\n";
+                }
+                res += "}";
+                return res;
+            }
+            case value_type::type_node: {
+                std::string res = "node " + std::to_string(node_id()) + " ( ";
+                for(auto& s: node_labels()) res += ":" + s + " ";
+                res += ") {";
+                auto props = node_properties();
+                if(!props.empty()) res += "\n";
+                for(auto& e: props) {
+                    res += e.first + ": " + e.second.dump() + "\n";
+                }
+                res += "}";
+                return res;
+            }
+            case value_type::type_relationship:{
+                std::string res = "relationship (" +  std::to_string(relationship_start_node_id());
+                res += ")--[" + std::to_string(relationship_id()) + ":" + relationship_type() + "]--(" + std::to_string(relationship_end_node_id()) + ") {";
+                auto props = relationship_properties();
+                if(!props.empty()) res += "\n";
+                for(auto& e: props) {
+                    res += e.first + ": " + e.second.dump() + "\n";
+                }
+                res += "}";
+                return res;
+            }
+            case value_type::type_path: {
+                auto len = path_length();
+                std::string res = "path(" + std::to_string(len) + ") [\n";
+                for(unsigned int i=0; i<len; i++) {
+                    res += path_node(i).dump() + "\n";
+                    res += path_relationship(i).dump() + "\n";
+                }
+                res += path_node(len).dump() + "\n]";
+                return res;
+            } 
+            case value_type::type_identity: return "identity(" + std::to_string(to_identity()) + ")";
+            default:
+            case value_type::type_unknown: return "unknown";
+        }
+    }
+}
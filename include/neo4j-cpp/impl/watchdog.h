@@ -0,0 +1,110 @@
+#pragma once
+#include "../watchdog.h"
+
+namespace neo4j {
+    watchdog::watchdog(std::chrono::milliseconds t, size_t slots)
+        : tick(t.count() > 0 ? t : std::chrono::milliseconds(1)), epoch(clock::now()), wheel(slots == 0 ? 1 : slots)
+    {
+        worker = std::thread([this](){ run(); });
+    }
+
+    watchdog::~watchdog()
+    {
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    uint64_t watchdog::tick_of(clock::time_point t) const noexcept
+    {
+        if(t <= epoch) return 0;
+        // Round up, a timer must never fire before its deadline
+        return static_cast<uint64_t>((t - epoch + tick - clock::duration(1)) / tick);
+    }
+
+    watchdog::timer_id watchdog::schedule(clock::time_point deadline, std::function<void()> fn)
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        auto t = std::max(tick_of(deadline), current_tick);
+        size_t idx = t % wheel.size();
+        auto id = next_id++;
+        auto it = wheel[idx].insert(wheel[idx].end(), timer{id, deadline, std::move(fn)});
+        index.emplace(id, std::make_pair(idx, it));
+        bool wake = index.size() == 1;
+        lck.unlock();
+        // The worker sleeps indefinitely while no timers are pending
+        if(wake) cv.notify_all();
+        return id;
+    }
+
+    bool watchdog::cancel(timer_id id)
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        auto it = index.find(id);
+        if(it != index.end()) {
+            wheel[it->second.first].erase(it->second.second);
+            index.erase(it);
+            return true;
+        }
+        if(std::this_thread::get_id() != worker.get_id())
+            cv.wait(lck, [this, id](){ return running != id; });
+        return false;
+    }
+
+    size_t watchdog::pending() noexcept
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        return index.size();
+    }
+
+    void watchdog::run()
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        current_tick = tick_of(clock::now());
+        while(!stop) {
+            if(index.empty()) {
+                cv.wait(lck, [this](){ return stop || !index.empty(); });
+                current_tick = tick_of(clock::now());
+                continue;
+            }
+            cv.wait_until(lck, epoch + tick * (current_tick + 1), [this](){ return stop; });
+            if(stop) break;
+            auto now = clock::now();
+            auto target = tick_of(now);
+            // Catch up on every slot passed since the last wakeup, but never more than one round
+            for(uint64_t t = current_tick; t <= target && t < current_tick + wheel.size(); t++) {
+                auto& s = wheel[t % wheel.size()];
+                for(auto it = s.begin(); it != s.end();) {
+                    if(it->deadline > now) {
+                        // Belongs to a later round
+                        ++it;
+                        continue;
+                    }
+                    auto fn = std::move(it->fn);
+                    running = it->id;
+                    index.erase(it->id);
+                    s.erase(it);
+                    lck.unlock();
+                    try {
+                        fn();
+                    } catch(...) {}
+                    lck.lock();
+                    running = 0;
+                    cv.notify_all();
+                    // The slot might have changed while unlocked
+                    it = s.begin();
+                }
+            }
+            current_tick = target;
+        }
+    }
+
+    watchdog& watchdog::global()
+    {
+        static watchdog instance;
+        return instance;
+    }
+}
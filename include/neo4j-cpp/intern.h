@@ -0,0 +1,114 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include "string_ref.h"
+#include "value_ref.h"
+#include "compare.h"
+
+namespace neo4j {
+    // Handle of an interned string, valid for the table that issued it
+    using symbol = uint32_t;
+
+    // Set of interned labels stored as a bitset. The first 64 symbols need
+    // no allocation.
+    class label_set {
+        uint64_t low = 0;
+        std::vector<uint64_t> high;
+    public:
+        void insert(symbol s) {
+            if(s < 64) {
+                low |= uint64_t(1) << s;
+                return;
+            }
+            size_t word = s / 64 - 1;
+            if(word >= high.size()) high.resize(word + 1);
+            high[word] |= uint64_t(1) << (s % 64);
+        }
+        bool contains(symbol s) const noexcept {
+            if(s < 64) return (low >> s) & 1;
+            size_t word = s / 64 - 1;
+            return word < high.size() && ((high[word] >> (s % 64)) & 1);
+        }
+        // True if every label of other is in this set
+        bool contains_all(const label_set& other) const noexcept {
+            if((other.low & ~low) != 0) return false;
+            for(size_t i = 0; i < other.high.size(); i++) {
+                uint64_t mine = i < high.size() ? high[i] : 0;
+                if((other.high[i] & ~mine) != 0) return false;
+            }
+            return true;
+        }
+        size_t size() const noexcept {
+            size_t res = popcount(low);
+            for(auto w : high) res += popcount(w);
+            return res;
+        }
+        bool empty() const noexcept { return size() == 0; }
+        void clear() noexcept {
+            low = 0;
+            high.clear();
+        }
+        bool operator==(const label_set& other) const noexcept { return contains_all(other) && other.contains_all(*this); }
+        bool operator!=(const label_set& other) const noexcept { return !(*this == other); }
+
+        template<typename Fn>
+        void for_each(Fn&& fn) const {
+            for_each_bit(low, 0, fn);
+            for(size_t i = 0; i < high.size(); i++) for_each_bit(high[i], static_cast<symbol>((i + 1) * 64), fn);
+        }
+    private:
+        static size_t popcount(uint64_t w) noexcept {
+            size_t res = 0;
+            for(; w != 0; w &= w - 1) res++;
+            return res;
+        }
+        template<typename Fn>
+        static void for_each_bit(uint64_t w, symbol base, Fn& fn) {
+            for(symbol i = 0; w != 0; i++, w >>= 1) {
+                if(w & 1) fn(base + i);
+            }
+        }
+    };
+
+    struct property_ref {
+        symbol key;
+        value_ref value;
+    };
+
+    // Maps property keys, labels and relationship types to small integers,
+    // so reading them from many rows does not allocate once every distinct
+    // string was seen. Interned strings live as long as the table. Not
+    // thread safe, use one table per stream or reader thread.
+    class intern_table {
+        std::deque<std::string> strings;
+        std::vector<string_ref> names;
+        std::unordered_map<string_ref, symbol, string_ref_hash> index;
+    public:
+        intern_table() = default;
+        intern_table(intern_table&&) = default;
+        intern_table& operator=(intern_table&&) = default;
+        intern_table(const intern_table&) = delete;
+        intern_table& operator=(const intern_table&) = delete;
+
+        symbol intern(string_ref str);
+        // False if str was never interned
+        bool find(string_ref str, symbol& res) const noexcept;
+        // The returned data is stable for the lifetime of the table
+        string_ref name(symbol s) const;
+        size_t size() const noexcept { return names.size(); }
+
+        label_set labels(const value_ref& node);
+        void labels(const value_ref& node, label_set& res);
+        symbol type(const value_ref& relationship);
+        symbol key(const value_ref& map, unsigned int idx);
+        // Entries of a map, node or relationship, appended to res
+        void properties(const value_ref& val, std::vector<property_ref>& res);
+        std::vector<property_ref> properties(const value_ref& val);
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/intern.h"
+#endif
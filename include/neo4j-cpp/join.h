@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "value.h"
+#include "compare.h"
+
+namespace neo4j {
+    class result_stream;
+
+    enum class join_type {
+        inner,
+        // Probe rows without a match are returned with empty build fields
+        left
+    };
+
+    struct join_record {
+        std::vector<value> probe;
+        std::vector<value> build;
+        bool valid = false;
+
+        explicit operator bool() const noexcept { return valid; }
+        bool operator !() const noexcept { return !valid; }
+    };
+
+    // Joins two result streams on a key column. The build stream is read
+    // completely into a hash table (its rows are copied out), the probe
+    // stream is then streamed row by row. Null keys never match.
+    class hash_join {
+        std::unordered_multimap<value, std::vector<value>> table;
+        std::shared_ptr<result_stream> probe;
+        unsigned int probe_key;
+        join_type type;
+        std::vector<value> current;
+        std::unordered_multimap<value, std::vector<value>>::const_iterator next, last;
+        unsigned int probe_fields;
+    public:
+        hash_join(std::shared_ptr<result_stream> build, unsigned int build_key,
+            std::shared_ptr<result_stream> probe, unsigned int probe_key, join_type type = join_type::inner);
+
+        hash_join(const hash_join&) = delete;
+        hash_join& operator=(const hash_join&) = delete;
+
+        join_record fetch_next();
+        size_t build_rows() const noexcept { return table.size(); }
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/join.h"
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+struct neo4j_memory_allocator;
+
+namespace neo4j {
+    // Limits in bytes of memory allocated by libneo4j, 0 disables a limit.
+    // Above the soft limit a stream stops reading ahead; an allocation that
+    // would exceed the hard limit fails, aborting the stream with
+    // memory_limit_error. The allocation fails while libneo4j receives a
+    // record, which can leave the session failed: replace the connection
+    // (connection_pool::discard) if its next statement fails.
+    struct memory_limits {
+        size_t stream_soft = 0;
+        size_t stream_hard = 0;
+        size_t connection_soft = 0;
+        size_t connection_hard = 0;
+    };
+
+    struct memory_usage {
+        size_t live;
+        size_t peak;
+        unsigned long long allocations;
+        unsigned long long allocated_bytes;
+    };
+
+    // Live bytes of one stream. Allocations hold a reference, so it stays
+    // valid until the last of them is freed.
+    class memory_counter {
+        std::atomic<size_t> live{0};
+        std::atomic<size_t> peak{0};
+        std::atomic<unsigned long long> allocations{0};
+        std::atomic<unsigned long long> allocated{0};
+        std::atomic<size_t> refs{1};
+        std::atomic<bool> refused{false};
+
+        friend class memory_account;
+    public:
+        void add(size_t size) noexcept;
+        void remove(size_t size) noexcept;
+        size_t get_live() const noexcept { return live; }
+        memory_usage usage() const noexcept;
+        // Set once an allocation was refused because of a hard limit
+        bool limit_exceeded() const noexcept { return refused; }
+
+        void retain() noexcept { refs++; }
+        void release() noexcept { if(--refs == 0) delete this; }
+    };
+
+    // Accounts the memory of one connection by wrapping its allocator.
+    class memory_account {
+    public:
+        struct hook;
+    private:
+        std::unique_ptr<hook> h;
+        memory_limits lim;
+        struct neo4j_memory_allocator* inner;
+        memory_counter total;
+    public:
+        // Inner is the allocator used for the actual allocations
+        memory_account(const memory_limits& limits, struct neo4j_memory_allocator* inner);
+        ~memory_account();
+
+        memory_account(const memory_account&) = delete;
+        memory_account& operator=(const memory_account&) = delete;
+
+        struct neo4j_memory_allocator* allocator() noexcept;
+        const memory_limits& limits() const noexcept { return lim; }
+        memory_usage usage() const noexcept { return total.usage(); }
+        bool over_soft_limit() const noexcept { return lim.connection_soft != 0 && total.get_live() > lim.connection_soft; }
+        bool over_soft_limit(const memory_counter* stream) const noexcept;
+
+        void* allocate(size_t size, bool zero, void* context) noexcept;
+        void deallocate(void* ptr) noexcept;
+
+        // Allocations made by this thread while the scope is alive are
+        // charged to the stream counter as well.
+        class scope {
+            memory_counter* prev;
+        public:
+            explicit scope(memory_counter* counter) noexcept;
+            ~scope();
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+        };
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/memory.h"
+#endif
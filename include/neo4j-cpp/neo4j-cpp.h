@@ -1,9 +1,36 @@
 #pragma once
 
 #include "exception.h"
+#include "error.h"
 #include "client.h"
+#include "compare.h"
 #include "config.h"
 #include "connection.h"
+#include "cursor.h"
+#include "executor.h"
+#include "fanout.h"
+#include "graph.h"
+#include "intern.h"
+#include "join.h"
+#include "memory.h"
+#include "packstream.h"
+#include "params.h"
+#include "path.h"
+#include "plan.h"
+#include "query.h"
+#include "pool.h"
+#include "prepared.h"
+#include "replay.h"
 #include "result_stream.h"
+#include "retry.h"
+#include "routing.h"
+#include "slow_query_log.h"
+#include "snapshot.h"
+#include "transport.h"
+#include "tuning.h"
+#include "watchdog.h"
 #include "result.h"
-#include "value.h"
\ No newline at end of file
+#include "value.h"
+#include "value_ref.h"
+#include "string_ref.h"
+#include "visit.h"
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace neo4j {
+    class value;
+    class value_ref;
+
+    // Encoder for the PackStream serialization format used by Bolt.
+    class packstream_writer {
+        std::vector<uint8_t> buf;
+
+        void put(uint8_t b) { buf.push_back(b); }
+        void put_be(uint64_t v, size_t bytes);
+        void put_size(size_t size, uint8_t tiny, uint8_t m8, uint8_t m16, uint8_t m32);
+    public:
+        const std::vector<uint8_t>& data() const noexcept { return buf; }
+        std::vector<uint8_t>& data() noexcept { return buf; }
+        void clear() noexcept { buf.clear(); }
+
+        void write_null();
+        void write_bool(bool b);
+        void write_int(int64_t i);
+        void write_float(double d);
+        void write_string(const char* str, size_t len);
+        void write_string(const std::string& str) { write_string(str.data(), str.size()); }
+        void write_bytes(const void* data, size_t len);
+        void write_list_header(size_t size);
+        void write_map_header(size_t size);
+        void write_struct_header(size_t fields, uint8_t signature);
+
+        // Serialize a value including nodes, relationships and paths.
+        void write(const value_ref& val);
+    };
+
+    // Decoder for PackStream data. Throws neo4j::exception on malformed input.
+    class packstream_reader {
+        const uint8_t* ptr;
+        const uint8_t* end;
+
+        uint8_t get();
+        uint64_t get_be(size_t bytes);
+        const uint8_t* take(size_t len);
+        value read_path();
+    public:
+        enum class marker {
+            null,
+            boolean,
+            integer,
+            floating,
+            string,
+            bytes,
+            list,
+            map,
+            structure,
+            invalid
+        };
+
+        packstream_reader(const void* data, size_t len) noexcept
+            : ptr(static_cast<const uint8_t*>(data)), end(static_cast<const uint8_t*>(data) + len)
+        {}
+
+        size_t remaining() const noexcept { return end - ptr; }
+        const uint8_t* position() const noexcept { return ptr; }
+        marker peek() const;
+
+        void read_null();
+        bool read_bool();
+        int64_t read_int();
+        double read_float();
+        // The returned pointer references the input buffer
+        const char* read_string(size_t& len);
+        std::string read_string();
+        const uint8_t* read_bytes(size_t& len);
+        size_t read_list_header();
+        size_t read_map_header();
+        size_t read_struct_header(uint8_t& signature);
+        void skip();
+        // Decode the next value into an owned value, including nodes,
+        // relationships and paths.
+        value read_value();
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/packstream.h"
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include "string_ref.h"
+#include "value.h"
+#include "value_ref.h"
+
+struct neo4j_value;
+
+namespace neo4j {
+    // Statement parameters that reference caller owned data instead of
+    // copying it into value trees. Strings, lists and values passed in are
+    // not copied and must stay alive (and unchanged) until the result
+    // stream the parameters were sent with is destroyed. Scalars, keys and
+    // the per element encoding of lists are held by the object itself.
+    class parameters {
+        struct storage;
+        std::unique_ptr<storage> s;
+
+        size_t entry(string_ref key);
+        // Reserve an encoded list of n elements for key and return its handle
+        size_t open_list(string_ref key, size_t n);
+        void put(size_t list, size_t idx, long long v);
+        void put(size_t list, size_t idx, double v);
+        void put(size_t list, size_t idx, bool v);
+        void put(size_t list, size_t idx, string_ref v);
+        void put(size_t list, size_t idx, const std::string& v) { put(list, idx, string_ref(v)); }
+        void put(size_t list, size_t idx, const char* v) { put(list, idx, string_ref(v)); }
+        void put(size_t list, size_t idx, const value& v);
+        void put(size_t list, size_t idx, int v) { put(list, idx, static_cast<long long>(v)); }
+        void put(size_t list, size_t idx, long v) { put(list, idx, static_cast<long long>(v)); }
+        void put(size_t list, size_t idx, unsigned int v) { put(list, idx, static_cast<long long>(v)); }
+        void put(size_t list, size_t idx, unsigned long v) { put(list, idx, static_cast<long long>(v)); }
+        void put(size_t list, size_t idx, float v) { put(list, idx, static_cast<double>(v)); }
+    public:
+        parameters();
+        parameters(parameters&&) noexcept;
+        parameters& operator=(parameters&&) noexcept;
+        ~parameters();
+
+        parameters(const parameters&) = delete;
+        parameters& operator=(const parameters&) = delete;
+
+        // Setting a key again replaces its previous entry
+        parameters& set_null(string_ref key);
+        parameters& set(string_ref key, bool v);
+        parameters& set(string_ref key, int v) { return set(key, static_cast<long long>(v)); }
+        parameters& set(string_ref key, long v) { return set(key, static_cast<long long>(v)); }
+        parameters& set(string_ref key, long long v);
+        parameters& set(string_ref key, double v);
+        parameters& set(string_ref key, string_ref v);
+        parameters& set(string_ref key, const std::string& v) { return set(key, string_ref(v)); }
+        parameters& set(string_ref key, const char* v) { return set(key, string_ref(v)); }
+        parameters& set_bytes(string_ref key, const uint8_t* data, size_t len);
+        // References v, which may be an arbitrarily nested value
+        parameters& set(string_ref key, const value& v);
+
+        // Contiguous data such as std::vector<int64_t> or std::array<double, N>
+        template<typename T>
+        parameters& set_list(string_ref key, const T* data, size_t n) {
+            auto list = open_list(key, n);
+            for(size_t i = 0; i < n; i++) put(list, i, data[i]);
+            return *this;
+        }
+        template<typename Container>
+        parameters& set_list(string_ref key, const Container& c) {
+            return set_range(key, std::begin(c), std::end(c));
+        }
+        // Any forward range, e.g. std::set<std::string> or std::vector<bool>
+        template<typename Iterator>
+        parameters& set_range(string_ref key, Iterator first, Iterator last) {
+            auto list = open_list(key, static_cast<size_t>(std::distance(first, last)));
+            size_t i = 0;
+            for(; first != last; ++first) put(list, i++, *first);
+            return *this;
+        }
+
+        size_t size() const noexcept;
+        bool empty() const noexcept { return size() == 0; }
+
+        // The parameter map, referencing the storage of this object
+        struct neo4j_value get_value() const;
+        value_ref ref() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/params.h"
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+#include <iterator>
+#include "value_ref.h"
+
+namespace neo4j {
+    // Walks a path without allocating. Hop i is the node at position i, the
+    // relationship leaving it towards node i + 1 and whether that relationship
+    // points forward (from node i to node i + 1).
+    class path_view {
+        value_ref path;
+        unsigned int len;
+    public:
+        struct step {
+            value_ref node;
+            value_ref relationship;
+            bool forward;
+        };
+
+        class iterator {
+            const path_view* view = nullptr;
+            unsigned int hop = 0;
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = step;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const step*;
+            using reference = step;
+
+            iterator() noexcept = default;
+            iterator(const path_view* v, unsigned int h) noexcept : view(v), hop(h) {}
+
+            step operator*() const { return (*view)[hop]; }
+            iterator& operator++() noexcept { hop++; return *this; }
+            iterator operator++(int) noexcept { auto res = *this; hop++; return res; }
+            bool operator==(const iterator& other) const noexcept { return hop == other.hop && view == other.view; }
+            bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+            unsigned int index() const noexcept { return hop; }
+        };
+
+        // Throws if val is not a path
+        explicit path_view(const value_ref& val);
+
+        unsigned int length() const noexcept { return len; }
+        value_ref start_node() const { return node(0); }
+        value_ref end_node() const { return node(len); }
+        value_ref node(unsigned int hop) const;
+        value_ref relationship(unsigned int hop, bool& forward) const;
+        step operator[](unsigned int hop) const;
+
+        iterator begin() const noexcept { return iterator(this, 0); }
+        iterator end() const noexcept { return iterator(this, len); }
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/path.h"
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct neo4j_statement_plan;
+struct neo4j_statement_execution_step;
+
+namespace neo4j {
+    struct plan_step {
+        std::string operator_type;
+        std::vector<std::string> identifiers;
+        double estimated_rows;
+        // The following are only filled for PROFILE plans
+        unsigned long long rows;
+        unsigned long long db_hits;
+        unsigned long long page_cache_hits;
+        unsigned long long page_cache_misses;
+        std::vector<plan_step> sources;
+    };
+
+    struct statement_plan {
+        unsigned int version;
+        std::string planner;
+        std::string runtime;
+        bool is_profile;
+        plan_step output_step;
+
+        static statement_plan from_native(const struct neo4j_statement_plan* plan);
+    };
+
+    // The count most expensive operators of a plan, ordered by db hits for
+    // profiled plans and by estimated rows otherwise.
+    std::vector<const plan_step*> costliest_operators(const statement_plan& plan, size_t count = 5);
+    // Render the plan as an indented operator tree.
+    std::string to_string(const statement_plan& plan);
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/plan.h"
+#endif
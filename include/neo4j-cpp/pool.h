@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "connect_flags.h"
+#include "config.h"
+
+namespace neo4j {
+    class connection;
+    class buffer_tuner;
+    // Set of connections to a single server. A connection is handed out again
+    // once neither the caller nor any of its result streams reference it.
+    class connection_pool {
+        std::string uri;
+        shared_config cfg;
+        connect_flags flags;
+        size_t max_size;
+        mutable std::mutex mtx;
+        std::vector<std::shared_ptr<connection>> conns;
+        std::shared_ptr<buffer_tuner> tuner;
+    public:
+        connection_pool(const std::string& uri, connect_flags flags = connect_flags::none, size_t max_size = 16);
+        connection_pool(const std::string& uri, const config& conf, connect_flags flags = connect_flags::none, size_t max_size = 16);
+        // All connections reference conf, nullptr uses the defaults
+        connection_pool(const std::string& uri, shared_config conf, connect_flags flags = connect_flags::none, size_t max_size = 16);
+        ~connection_pool();
+
+        connection_pool(const connection_pool&) = delete;
+        connection_pool& operator=(const connection_pool&) = delete;
+
+        const std::string& get_uri() const noexcept { return uri; }
+        size_t get_max_size() const noexcept { return max_size; }
+        const shared_config& get_config() const noexcept { return cfg; }
+
+        // Connections opened from now on get their buffers sized by tuner.
+        // Existing connections keep theirs until they are cleared.
+        void set_buffer_tuner(std::shared_ptr<buffer_tuner> tuner);
+        std::shared_ptr<buffer_tuner> get_buffer_tuner() const;
+
+        // Reuses an idle connection or opens a new one. Throws if the pool is
+        // exhausted or the connection fails. Idle connections aborted by a
+        // statement deadline are closed instead of handed out.
+        std::shared_ptr<connection> acquire();
+
+        size_t size() const;
+        size_t in_use() const;
+        size_t idle() const;
+        // Close all idle connections, e.g. after the server went away.
+        void clear_idle();
+        // Drop a broken connection so it is not handed out again. It is
+        // closed once the caller and its streams released it.
+        void discard(const std::shared_ptr<connection>& con);
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/pool.h"
+#endif
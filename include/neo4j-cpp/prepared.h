@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "value.h"
+#include "string_ref.h"
+#include "result_stream.h"
+
+namespace neo4j {
+    class connection;
+    class connection_pool;
+
+    // A statement executed many times. The query text is shared by all of
+    // its streams, and the column schema is captured once, either by
+    // prepare() (EXPLAIN, which also yields the statement type) or by the
+    // first run(). Later runs check their columns against it and throw if
+    // the schema changed. Safe to share between threads.
+    class prepared_statement {
+        std::shared_ptr<const std::string> text;
+        std::vector<std::string> fields;
+        statement_type stype = statement_type::read_only;
+        std::atomic<bool> type_known{false};
+        std::atomic<bool> ready{false};
+        std::mutex mtx;
+        bool validate;
+
+        void capture(result_stream& stream);
+        void check(result_stream& stream) const;
+    public:
+        // Validation of later runs can be disabled, it waits for the server to accept the statement
+        explicit prepared_statement(std::string query, bool validate = true);
+
+        prepared_statement(const prepared_statement&) = delete;
+        prepared_statement& operator=(const prepared_statement&) = delete;
+
+        // Capture the schema with EXPLAIN, without executing the statement
+        void prepare(connection& con, const value& params = value());
+
+        std::shared_ptr<result_stream> run(connection& con, const value& params = value());
+        std::shared_ptr<result_stream> run(connection_pool& pool, const value& params = value());
+        // Discards the results, no schema is captured or checked
+        std::shared_ptr<result_stream> send(connection& con, const value& params = value());
+
+        const std::string& get_query() const noexcept { return *text; }
+        bool is_prepared() const noexcept { return ready; }
+        // Empty until the schema was captured
+        const std::vector<std::string>& fieldnames() const noexcept;
+        // Index of a column, throws if there is no such column
+        unsigned int column(string_ref name) const;
+        // Only known after prepare()
+        bool has_type() const noexcept { return ready && type_known; }
+        statement_type type() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/prepared.h"
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include "value.h"
+#include "exception.h"
+#include "connection.h"
+#include "result_stream.h"
+
+namespace neo4j {
+    // A named parameter slot of a query_template
+    template<typename T>
+    struct param {
+        const char* name;
+        constexpr explicit param(const char* n) noexcept : name(n) {}
+    };
+
+    // Encodes a bound argument, specialized for every supported slot type
+    template<typename T> struct param_traits;
+    template<> struct param_traits<bool> { static value encode(bool v) { return value(v); } };
+    template<> struct param_traits<long long> { static value encode(long long v) { return value(v); } };
+    template<> struct param_traits<double> { static value encode(double v) { return value(v); } };
+    template<> struct param_traits<std::string> { static value encode(const std::string& v) { return value(v); } };
+    template<> struct param_traits<value> { static value encode(const value& v) { return v; } };
+    template<typename U>
+    struct param_traits<std::vector<U>> {
+        static value encode(const std::vector<U>& v) {
+            list_builder res(v.size());
+            for(auto& e : v) res.push_back(param_traits<U>::encode(e));
+            return res.build();
+        }
+    };
+
+    // Whether an argument of type A may be bound to a slot of type T.
+    // Numbers never narrow silently and bools only bind to bool slots.
+    template<typename T, typename A>
+    struct param_accepts : std::is_convertible<A, T> {};
+    template<typename A>
+    struct param_accepts<bool, A> : std::is_same<typename std::decay<A>::type, bool> {};
+    template<typename A>
+    struct param_accepts<long long, A> : std::integral_constant<bool, std::is_integral<typename std::decay<A>::type>::value
+        && !std::is_same<typename std::decay<A>::type, bool>::value
+        && sizeof(typename std::decay<A>::type) <= sizeof(long long)
+        && !(std::is_unsigned<typename std::decay<A>::type>::value && sizeof(typename std::decay<A>::type) == sizeof(long long))> {};
+    template<typename A>
+    struct param_accepts<double, A> : std::integral_constant<bool, std::is_arithmetic<typename std::decay<A>::type>::value
+        && !std::is_same<typename std::decay<A>::type, bool>::value> {};
+
+    template<bool... B>
+    struct param_all : std::is_same<param_all<B...>, param_all<(B || true)...>> {};
+
+    // Scans Cypher text for $name parameters, skipping string literals
+    // and comments. Usable in constant expressions.
+    struct query_scanner {
+        static constexpr bool is_ident(char c) noexcept {
+            return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        }
+        // Index of the next $ that starts a parameter at or after pos, or the text length
+        static constexpr size_t next(const char* text, size_t pos) noexcept {
+            while(text[pos] != '\0') {
+                char c = text[pos];
+                if(c == '\'' || c == '"' || c == '`') {
+                    pos++;
+                    while(text[pos] != '\0' && text[pos] != c) pos += (text[pos] == '\\' && text[pos + 1] != '\0') ? 2 : 1;
+                    if(text[pos] != '\0') pos++;
+                } else if(c == '/' && text[pos + 1] == '/') {
+                    while(text[pos] != '\0' && text[pos] != '\n') pos++;
+                } else if(c == '$' && is_ident(text[pos + 1])) {
+                    return pos;
+                } else {
+                    pos++;
+                }
+            }
+            return pos;
+        }
+        static constexpr bool name_at(const char* text, size_t pos, const char* name) noexcept {
+            size_t i = 0;
+            for(; name[i] != '\0'; i++) {
+                if(text[pos + i] != name[i]) return false;
+            }
+            return !is_ident(text[pos + i]);
+        }
+        static constexpr bool uses(const char* text, const char* name) noexcept {
+            for(size_t pos = next(text, 0); text[pos] != '\0'; pos = next(text, pos + 1)) {
+                if(name_at(text, pos + 1, name)) return true;
+            }
+            return false;
+        }
+        // True if every parameter in text is one of the n names
+        static constexpr bool declared(const char* text, const char* const* names, size_t n) noexcept {
+            for(size_t pos = next(text, 0); text[pos] != '\0'; pos = next(text, pos + 1)) {
+                bool found = false;
+                for(size_t i = 0; i < n && !found; i++) found = name_at(text, pos + 1, names[i]);
+                if(!found) return false;
+            }
+            return true;
+        }
+    };
+
+    // Cypher text with typed parameter slots, checked when the template is
+    // created. Declared constexpr (see make_query) a slot missing from the
+    // text or an undeclared $parameter is a compile error, and bind()
+    // rejects arguments of the wrong number or type at compile time. The
+    // text is sent as is on every call, it must have static storage.
+    template<typename... T>
+    class query_template {
+        const char* query;
+        const char* names[sizeof...(T) + 1];
+
+        template<typename... A, size_t... I>
+        value bind_slots(std::index_sequence<I...>, A&&... args) const {
+            map_builder res;
+            int expand[] = { 0, (res.set(names[I], param_traits<T>::encode(T(std::forward<A>(args)))), 0)... };
+            (void)expand;
+            return res.build();
+        }
+    public:
+        constexpr query_template(const char* text, param<T>... slots)
+            : query(text), names{ slots.name..., nullptr }
+        {
+            for(size_t i = 0; i < sizeof...(T); i++) {
+                if(!query_scanner::uses(query, names[i])) throw exception("parameter slot is not used by the query");
+                for(size_t j = 0; j < i; j++) {
+                    if(query_scanner::name_at(names[j], 0, names[i]) && query_scanner::name_at(names[i], 0, names[j])) throw exception("duplicate parameter slot");
+                }
+            }
+            if(!query_scanner::declared(query, names, sizeof...(T))) throw exception("query uses an undeclared parameter");
+        }
+
+        constexpr const char* text() const noexcept { return query; }
+        constexpr size_t size() const noexcept { return sizeof...(T); }
+        constexpr const char* name(size_t idx) const noexcept { return names[idx]; }
+
+        // Arguments are given in slot order
+        template<typename... A>
+        value bind(A&&... args) const {
+            static_assert(sizeof...(A) == sizeof...(T), "wrong number of query parameters");
+            static_assert(param_all<param_accepts<T, A>::value...>::value, "query parameter of the wrong type");
+            return bind_slots(std::index_sequence_for<T...>(), std::forward<A>(args)...);
+        }
+
+        template<typename... A>
+        std::shared_ptr<result_stream> run(connection& con, A&&... args) const {
+            return con.run(static_query(query), bind(std::forward<A>(args)...));
+        }
+        template<typename... A>
+        std::shared_ptr<result_stream> send(connection& con, A&&... args) const {
+            return con.send(static_query(query), bind(std::forward<A>(args)...));
+        }
+    };
+
+    template<typename... T>
+    constexpr query_template<T...> make_query(const char* text, param<T>... slots) {
+        return query_template<T...>(text, slots...);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include "value.h"
+
+struct neo4j_connection_factory;
+
+namespace neo4j {
+    // Connection factory recording the raw Bolt bytes of every connection to
+    // a capture file. Install it with config::set_connection_factory; it must
+    // outlive all connections made with it. TLS is applied on top of the
+    // factory's streams, so record with connect_flags::insecure.
+    class recording_connection_factory {
+    public:
+        struct state;
+    private:
+        std::unique_ptr<state> st;
+    public:
+        // Inner is the factory actually connecting, nullptr uses libneo4j's TCP factory
+        explicit recording_connection_factory(const std::string& file, struct neo4j_connection_factory* inner = nullptr);
+        ~recording_connection_factory();
+
+        recording_connection_factory(const recording_connection_factory&) = delete;
+        recording_connection_factory& operator=(const recording_connection_factory&) = delete;
+
+        struct neo4j_connection_factory* get() const noexcept;
+
+        size_t sessions() const noexcept;
+        unsigned long long bytes_sent() const noexcept;
+        unsigned long long bytes_received() const noexcept;
+        void flush();
+    };
+
+    struct recorded_statement {
+        std::string query;
+        value params;
+    };
+
+    // Serves a capture back to connections: the n-th connection made with
+    // the factory receives the server bytes of the n-th recorded session,
+    // whatever it sends. Install it with config::set_connection_factory.
+    class replay_connection_factory {
+    public:
+        enum class pacing {
+            // Serve bytes as fast as they are read
+            full_speed,
+            // Deliver each read at the offset it was recorded at
+            recorded
+        };
+        struct state;
+    private:
+        std::unique_ptr<state> st;
+    public:
+        explicit replay_connection_factory(const std::string& file, pacing mode = pacing::full_speed);
+        ~replay_connection_factory();
+
+        replay_connection_factory(const replay_connection_factory&) = delete;
+        replay_connection_factory& operator=(const replay_connection_factory&) = delete;
+
+        struct neo4j_connection_factory* get() const noexcept;
+
+        size_t sessions() const noexcept;
+        // Statements the client sent in a session, to issue them again
+        std::vector<recorded_statement> statements(size_t session) const;
+        // Server bytes of all sessions
+        unsigned long long recorded_bytes() const noexcept;
+        unsigned long long bytes_replayed() const noexcept;
+        // Start again with the first session
+        void rewind() noexcept;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/replay.h"
+#endif
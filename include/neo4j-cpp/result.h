@@ -7,6 +7,7 @@ struct neo4j_result;
 
 namespace neo4j {
     class value;
+    class value_ref;
     class result {
         struct neo4j_result* res;
     public:
@@ -21,6 +22,8 @@ namespace neo4j {
         bool operator !() const noexcept { return !valid(); }
 
         value field(unsigned int idx) const;
+        // Borrow a field; the reference is only valid while this row is alive.
+        value_ref field_ref(unsigned int idx) const;
     };
 }
 #ifndef NEO4JPP_IMPL_FILE
@@ -1,22 +1,38 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <system_error>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
 #include "connect_flags.h"
+#include "error.h"
+#include "plan.h"
+#include "value.h"
+#include "result.h"
+#include "visit.h"
+#include "string_ref.h"
+#include "memory.h"
 
 struct neo4j_result_stream;
+struct neo4j_failure_details;
 
 namespace neo4j {
     class connection;
     class result;
-    struct failure_details {
-        std::string code;
-        std::string message;
-        std::string description;
-        unsigned int line;
-        unsigned int column;
-        unsigned int offset;
-        std::string context;
-        unsigned int context_offset;
+    class slow_query_log;
+    struct update_counts {
+        unsigned long long nodes_created;
+        unsigned long long nodes_deleted;
+        unsigned long long relationships_created;
+        unsigned long long relationships_deleted;
+        unsigned long long properties_set;
+        unsigned long long labels_added;
+        unsigned long long labels_removed;
+        unsigned long long indexes_added;
+        unsigned long long indexes_removed;
+        unsigned long long constraints_added;
+        unsigned long long constraints_removed;
     };
     enum class statement_type {
         read_only,
@@ -25,12 +41,72 @@ namespace neo4j {
         schema_update,
         control
     };
+    // Query text with static storage duration (e.g. a literal or a
+    // query_template), used by result_stream without copying it.
+    struct static_query {
+        const char* text;
+        constexpr explicit static_query(const char* t) noexcept : text(t) {}
+    };
+
     class result_stream : public std::enable_shared_from_this<result_stream> {
         std::shared_ptr<connection> con;
         struct neo4j_result_stream* result;
-        std::string query;
+        // Points into owned_query or shared_query, or at the text of a static_query
+        std::string owned_query;
+        std::shared_ptr<const std::string> shared_query;
+        const char* query;
+        // Kept alive until the statement was sent
+        value params;
+
+        // Slow query log bookkeeping, only maintained if a log is attached
+        std::shared_ptr<slow_query_log> slow_log;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::duration first_record{0};
+        unsigned long long rows = 0;
+        bool finished = false;
+
+        // Deadline timer on the global watchdog, 0 if none. Guarded by the
+        // connection's ctl, cancelled once this or a later statement on the
+        // connection completed.
+        mutable uint64_t deadline = 0;
+        // Position among the statements sent on the connection
+        uint64_t seq = 0;
+        std::atomic<bool> timed_out{false};
+
+        // Allocations of this stream, null without memory accounting
+        memory_counter* memory = nullptr;
+        bool memory_exceeded = false;
+
+        void start(bool results, std::chrono::milliseconds timeout, std::error_code& ec) noexcept;
+        void record_fetch(bool has_record) noexcept;
+        void finish() noexcept;
+        void complete() const noexcept;
+        void cancel_deadline_locked() const noexcept;
+        void check_timeout(std::error_code& ec) const noexcept;
+        void check_memory(std::error_code& ec) noexcept;
+        static struct failure_details to_failure_details(const struct neo4j_failure_details* ptr);
     public:
-        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query);
+        // A non zero timeout fails the statement with a timeout once it expires
+        // and resets the connection. A read blocked on a stalled server is
+        // aborted if the config enables set_interruptible_io(); libneo4j
+        // then closes the session and the connection has to be replaced.
+        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+        // Does not throw if the statement could not be sent; ec is set instead
+        // and the stream must not be used.
+        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query, std::error_code& ec);
+        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query,
+            std::chrono::milliseconds timeout, std::error_code& ec);
+        // Params must be a map (or null), its entries are bound to $name in the query.
+        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query, const value& params,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+        result_stream(std::shared_ptr<connection> con, bool results, const std::string& query, const value& params,
+            std::chrono::milliseconds timeout, std::error_code& ec);
+        result_stream(std::shared_ptr<connection> con, bool results, static_query query, const value& params,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+        // Shares the query text with other streams instead of copying it
+        result_stream(std::shared_ptr<connection> con, bool results, std::shared_ptr<const std::string> query, const value& params,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
         ~result_stream();
 
         result_stream(const result_stream&) = delete;
@@ -40,15 +116,49 @@ namespace neo4j {
         std::string error_code() const;
         std::string error_message() const;
         struct failure_details failure_details() const;
+        // Wait for the statement to be evaluated and return its failure, if any.
+        error failure() const;
+        bool is_timed_out() const noexcept { return timed_out; }
+        // Drop the timeout given at construction, the rest of the statement
+        // runs without one.
+        void cancel_deadline() noexcept;
+        bool is_memory_exceeded() const noexcept { return memory_exceeded; }
+
+        // Zero if the connection has no memory accounting
+        memory_usage get_memory_usage() const noexcept;
+        // True while the stream or connection is above its soft limit,
+        // peek with depth > 1 fails then instead of reading ahead.
+        bool memory_pressure() const noexcept;
 
         unsigned int nfields() const;
         std::string fieldname(unsigned int index) const;
+        // Valid as long as the stream
+        string_ref fieldname_ref(unsigned int index) const;
 
         statement_type type() const;
-        // update_counts() const;
-        // statement_plan() const;
+        // Both wait for the statement to complete
+        struct update_counts update_counts() const;
+        struct statement_plan statement_plan() const;
         neo4j::result fetch_next();
+        neo4j::result fetch_next(std::error_code& ec) noexcept;
         neo4j::result peek(unsigned int depth = 1);
+        neo4j::result peek(unsigned int depth, std::error_code& ec) noexcept;
+
+        // Fetch all remaining records and emit them as visitor events (see
+        // value_visitor), one begin_record/end_record pair per record.
+        // Returns the number of records.
+        template<typename Visitor>
+        unsigned long long for_each_event(Visitor&& v) {
+            auto n = nfields();
+            unsigned long long count = 0;
+            while(auto row = fetch_next()) {
+                v.begin_record(n);
+                for(unsigned int i = 0; i < n; i++) visit(row.field_ref(i), v);
+                v.end_record();
+                count++;
+            }
+            return count;
+        }
     };
 }
 #ifndef NEO4JPP_IMPL_FILE
@@ -0,0 +1,142 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "error.h"
+#include "string_ref.h"
+#include "result_stream.h"
+#include "routing.h"
+
+namespace neo4j {
+    class connection;
+    class connection_pool;
+    class value;
+
+    enum class failure_class {
+        none,
+        // Neo.TransientError.*, the statement was not applied
+        transient,
+        // The member cannot take the statement, e.g. it is no longer the
+        // leader. Only worth retrying on another member.
+        reroute,
+        // The connection broke, whether the statement ran is unknown
+        connection,
+        // Client or database errors, deadlines and anything unknown
+        permanent
+    };
+
+    failure_class classify_failure(string_ref code) noexcept;
+    failure_class classify_failure(const error& err) noexcept;
+
+    // Whether running a statement twice is harmless. Only read_only and
+    // idempotent statements are retried.
+    enum class idempotency {
+        read_only,
+        idempotent,
+        non_idempotent
+    };
+
+    inline idempotency idempotency_for(statement_type type) noexcept {
+        return type == statement_type::read_only ? idempotency::read_only : idempotency::non_idempotent;
+    }
+
+    struct retry_options {
+        // Including the first attempt
+        unsigned int max_attempts = 5;
+        // The n-th retry waits initial_backoff * multiplier^n, at most
+        // max_backoff, scaled by a random factor in [1 - jitter, 1 + jitter].
+        std::chrono::milliseconds initial_backoff{50};
+        std::chrono::milliseconds max_backoff{5000};
+        double multiplier = 2;
+        double jitter = 0.2;
+        // Overall budget of all attempts and waits. Starting a statement gets
+        // the remainder as its timeout, its records are read without one.
+        // Zero disables it.
+        std::chrono::milliseconds deadline{30000};
+    };
+
+    struct retry_stats {
+        // Calls to run or execute
+        unsigned long long operations;
+        unsigned long long attempts;
+        unsigned long long retries;
+        // Operations that succeeded after at least one retry
+        unsigned long long recovered;
+        // Retryable failures given up on after max_attempts
+        unsigned long long exhausted;
+        unsigned long long deadline_exceeded;
+        // Retryable failures of non idempotent statements, not retried
+        unsigned long long unsafe;
+        // Broken connections replaced by a fresh one
+        unsigned long long reconnects;
+        // Cluster members skipped after refusing a statement
+        unsigned long long reroutes;
+    };
+
+    // Retries statements failing with transient or connection errors, e.g.
+    // while a cluster member restarts or the leader moves. Thread safe, one
+    // policy can serve many threads and pools.
+    class retry_policy {
+        retry_options opts;
+        std::atomic<unsigned long long> operations{0};
+        std::atomic<unsigned long long> attempts{0};
+        std::atomic<unsigned long long> retries{0};
+        std::atomic<unsigned long long> recovered{0};
+        std::atomic<unsigned long long> exhausted{0};
+        std::atomic<unsigned long long> deadline_exceeded{0};
+        std::atomic<unsigned long long> unsafe{0};
+        std::atomic<unsigned long long> reconnects{0};
+        std::atomic<unsigned long long> reroutes{0};
+
+        // Attempts are called with the statement timeout left by the deadline.
+        // Reroute failures are only retried if the attempts are routed.
+        template<typename Attempt>
+        error retry_loop(idempotency mode, bool routed, Attempt&& attempt);
+        template<typename Fn>
+        error on_pool(connection_pool& pool, idempotency mode, Fn&& fn);
+        template<typename Fn>
+        error on_connection(std::shared_ptr<connection>& con, idempotency mode, Fn&& fn);
+        template<typename Fn>
+        error on_routing(routing_client& client, access_mode access, idempotency mode, Fn&& fn);
+    public:
+        explicit retry_policy(const retry_options& opts = retry_options());
+
+        retry_policy(const retry_policy&) = delete;
+        retry_policy& operator=(const retry_policy&) = delete;
+
+        const retry_options& get_options() const noexcept { return opts; }
+        // Reroute failures count only if routed, i.e. through a routing_client
+        bool is_retryable(const error& err, idempotency mode, bool routed = false) const noexcept;
+        // Jittered delay before the given retry, counting from zero
+        std::chrono::milliseconds backoff(unsigned int retry) const;
+
+        // Run fn on a pooled connection until it returns no error or a
+        // failure that is not retried. Connections that broke are discarded
+        // from the pool, so the next attempt gets a fresh one.
+        error execute(connection_pool& pool, idempotency mode, const std::function<error(connection&)>& fn);
+        // Same on a single connection. A broken connection is reset, or
+        // replaced through connection::reconnect() if that fails.
+        error execute(std::shared_ptr<connection>& con, idempotency mode, const std::function<error(connection&)>& fn);
+        // Same on a cluster member. A member that broke or refused the
+        // statement is marked down, so the next attempt goes to another one,
+        // after fetching a new routing table if it was the leader.
+        error execute(routing_client& client, access_mode access, idempotency mode, const std::function<error(connection&)>& fn);
+
+        // Run the statement until the server accepted it. Only starting the
+        // statement is retried: once records are fetched the caller owns them.
+        expected<std::shared_ptr<result_stream>> run_nothrow(connection_pool& pool, const std::string& query, const value& params, idempotency mode);
+        expected<std::shared_ptr<result_stream>> run_nothrow(std::shared_ptr<connection>& con, const std::string& query, const value& params, idempotency mode);
+        std::shared_ptr<result_stream> run(connection_pool& pool, const std::string& query, const value& params, idempotency mode);
+        std::shared_ptr<result_stream> run(std::shared_ptr<connection>& con, const std::string& query, const value& params, idempotency mode);
+        // Read only statements go to readers, all others to the leader
+        expected<std::shared_ptr<result_stream>> run_nothrow(routing_client& client, const std::string& query, const value& params, idempotency mode);
+        std::shared_ptr<result_stream> run(routing_client& client, const std::string& query, const value& params, idempotency mode);
+
+        retry_stats stats() const noexcept;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/retry.h"
+#endif
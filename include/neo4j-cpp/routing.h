@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include "connect_flags.h"
+#include "result_stream.h"
+#include "config.h"
+
+namespace neo4j {
+    class connection;
+    class connection_pool;
+
+    enum class access_mode {
+        read,
+        write
+    };
+
+    // Only read only statements may go to a read replica
+    inline access_mode access_mode_for(statement_type type) noexcept {
+        return type == statement_type::read_only ? access_mode::read : access_mode::write;
+    }
+
+    struct routing_options {
+        connect_flags flags = connect_flags::none;
+        // Connections kept per cluster member
+        size_t max_connections = 16;
+        // A failed member is skipped for min_backoff, doubling on each further
+        // failure up to max_backoff.
+        std::chrono::milliseconds min_backoff{1000};
+        std::chrono::milliseconds max_backoff{60000};
+        // Used if the routing table carries no ttl
+        std::chrono::seconds default_ttl{300};
+    };
+
+    // Client for a causal cluster. Writes go to the leader, reads are spread
+    // over the followers and read replicas by the least outstanding requests.
+    // The routing table is fetched from dbms.cluster.routing.getRoutingTable
+    // and refreshed once its ttl expired.
+    class routing_client {
+    public:
+        struct member_state {
+            std::string address;
+            size_t outstanding;
+            bool down;
+        };
+    private:
+        struct member {
+            std::string address;
+            std::unique_ptr<connection_pool> pool;
+            std::chrono::steady_clock::time_point down_until{};
+            std::chrono::milliseconds backoff{0};
+        };
+
+        shared_config cfg;
+        routing_options opts;
+        std::vector<std::string> seeds;
+
+        mutable std::mutex mtx;
+        // Held while fetching a routing table so only one thread does it
+        std::mutex refresh_mtx;
+        std::map<std::string, std::shared_ptr<member>> members;
+        std::vector<std::string> readers;
+        std::vector<std::string> writers;
+        std::vector<std::string> routers;
+        std::chrono::steady_clock::time_point expires{};
+        size_t next = 0;
+
+        std::shared_ptr<member> get_member(const std::string& address);
+        // Requires mtx to be held
+        std::shared_ptr<member> member_locked(const std::string& address);
+        bool is_down(const member& m, std::chrono::steady_clock::time_point now) const noexcept;
+        void mark_down(member& m);
+        bool refresh_from(const std::string& address);
+        // Requires refresh_mtx to be held
+        void refresh_locked();
+        void ensure_table();
+        std::vector<std::shared_ptr<member>> candidates(access_mode mode);
+        std::vector<member_state> states(const std::vector<std::string>& addresses) const;
+    public:
+        // Seeds are "host:port" addresses of cluster members used to fetch the
+        // first routing table.
+        routing_client(std::vector<std::string> seeds, const routing_options& opts = routing_options());
+        routing_client(std::vector<std::string> seeds, const config& conf, const routing_options& opts = routing_options());
+        routing_client(std::vector<std::string> seeds, shared_config conf, const routing_options& opts = routing_options());
+        ~routing_client();
+
+        routing_client(const routing_client&) = delete;
+        routing_client& operator=(const routing_client&) = delete;
+
+        // Fetch a new routing table now. Throws if no router answered.
+        void refresh();
+
+        // Connection to a member serving the given mode. Outstanding requests
+        // are the member's connections referenced by callers or result streams.
+        std::shared_ptr<connection> acquire(access_mode mode);
+        std::shared_ptr<connection> acquire(statement_type type) { return acquire(access_mode_for(type)); }
+
+        std::shared_ptr<result_stream> run(const std::string& query, access_mode mode);
+        std::shared_ptr<result_stream> send(const std::string& query, access_mode mode);
+
+        // Skip the member until its backoff passed, e.g. after a failed statement.
+        void mark_down(const std::string& address);
+        // Same for the member a connection of this client belongs to
+        void mark_down(const connection& con);
+        // Drop a broken connection from its member's pool and skip the member
+        void discard(const std::shared_ptr<connection>& con);
+
+        std::vector<member_state> get_readers() const;
+        std::vector<member_state> get_writers() const;
+        std::vector<member_state> get_routers() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/routing.h"
+#endif
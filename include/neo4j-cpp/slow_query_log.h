@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <fstream>
+#include "plan.h"
+
+namespace neo4j {
+    class connection;
+
+    struct slow_query_options {
+        // Streams taking at least this long from send to completion are recorded
+        std::chrono::milliseconds threshold{1000};
+        // Number of entries kept in memory, older ones are dropped
+        size_t capacity = 128;
+        // If not empty, every entry is also appended to this file
+        std::string file;
+        // Connection used to EXPLAIN slow queries. It is only used by the
+        // background worker, so it must not be shared with other threads.
+        std::function<std::shared_ptr<connection>()> plan_connection;
+    };
+
+    struct slow_query_entry {
+        std::string fingerprint;
+        std::string query;
+        std::chrono::system_clock::time_point started;
+        std::chrono::nanoseconds time_to_first_record;
+        std::chrono::nanoseconds total_time;
+        unsigned long long rows;
+        bool has_plan;
+        statement_plan plan;
+    };
+
+    // Records queries exceeding a threshold. Streams only take timestamps and
+    // count rows; fingerprinting, plan capture and file output happen on a
+    // background worker.
+    class slow_query_log {
+        struct pending_entry {
+            std::string query;
+            std::chrono::system_clock::time_point started;
+            std::chrono::nanoseconds time_to_first_record;
+            std::chrono::nanoseconds total_time;
+            unsigned long long rows;
+        };
+
+        const slow_query_options opts;
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<pending_entry> pending;
+        std::deque<slow_query_entry> ring;
+        size_t processing = 0;
+        bool stop = false;
+        std::shared_ptr<connection> plan_con;
+        // Only written by the worker
+        std::ofstream out;
+        std::thread worker;
+
+        void run();
+        slow_query_entry process(pending_entry e);
+        void write(const slow_query_entry& e);
+    public:
+        explicit slow_query_log(slow_query_options options = slow_query_options());
+        ~slow_query_log();
+
+        slow_query_log(const slow_query_log&) = delete;
+        slow_query_log& operator=(const slow_query_log&) = delete;
+
+        std::chrono::nanoseconds threshold() const noexcept { return opts.threshold; }
+
+        // Queue a finished query. Callers are expected to have checked the threshold.
+        void submit(std::string query, std::chrono::system_clock::time_point started,
+            std::chrono::nanoseconds time_to_first_record, std::chrono::nanoseconds total_time, unsigned long long rows);
+
+        std::vector<slow_query_entry> entries() const;
+        void clear();
+        // Wait until all submitted entries are processed.
+        void flush();
+    };
+
+    // Normalize a query so that queries differing only in literals or
+    // whitespace map to the same text.
+    std::string fingerprint(const std::string& query);
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/slow_query_log.h"
+#endif
@@ -0,0 +1,197 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include "value.h"
+#include "string_ref.h"
+#include "packstream.h"
+
+namespace neo4j {
+    class result;
+    class result_stream;
+
+    // Read only view of a value stored in a snapshot. Decodes the PackStream
+    // bytes in place on every access, so nothing is copied out of the mapped
+    // file. Must not outlive the snapshot it was obtained from.
+    class snapshot_value {
+        const uint8_t* ptr;
+        const uint8_t* stop;
+
+        packstream_reader reader() const noexcept { return packstream_reader(ptr, stop - ptr); }
+        // Reader positioned on the fields of a node or relationship
+        packstream_reader structure(uint8_t signature, const char* what) const;
+        snapshot_value entry(packstream_reader& r) const;
+    public:
+        snapshot_value() noexcept;
+        snapshot_value(const uint8_t* data, const uint8_t* end) noexcept : ptr(data), stop(end) {}
+
+        // Walks the entries of a list, or the values of a map, decoding each
+        // entry once. Indexed access re-skips from the start of the container,
+        // so use this to read all of them.
+        class iterator;
+        // Throws if this is neither a list nor a map
+        iterator begin() const;
+        iterator end() const noexcept;
+
+        value_type get_type() const;
+
+        bool is_null() const { return get_type() == value_type::type_null; }
+        bool is_bool() const { return get_type() == value_type::type_bool; }
+        bool is_int() const { return get_type() == value_type::type_int; }
+        bool is_float() const { return get_type() == value_type::type_float; }
+        bool is_string() const { return get_type() == value_type::type_string; }
+        bool is_bytes() const { return get_type() == value_type::type_bytes; }
+        bool is_list() const { return get_type() == value_type::type_list; }
+        bool is_map() const { return get_type() == value_type::type_map; }
+        bool is_node() const { return get_type() == value_type::type_node; }
+        bool is_relationship() const { return get_type() == value_type::type_relationship; }
+        bool is_path() const { return get_type() == value_type::type_path; }
+
+        bool to_bool() const;
+        long long to_int() const;
+        double to_float() const;
+        std::string to_string() const;
+        // Points into the mapped file
+        string_ref to_string_ref() const;
+        string_ref to_bytes_ref() const;
+
+        unsigned int list_size() const;
+        snapshot_value list_entry(unsigned int idx) const;
+
+        unsigned int map_size() const;
+        string_ref map_key(unsigned int idx) const;
+        snapshot_value map_value(unsigned int idx) const;
+        // Null if the key is missing
+        snapshot_value map_entry(string_ref key) const;
+
+        long long node_id() const;
+        unsigned int node_label_count() const;
+        string_ref node_label(unsigned int idx) const;
+        bool node_has_label(string_ref label) const;
+        snapshot_value node_properties_ref() const;
+
+        long long relationship_id() const;
+        long long relationship_start_node_id() const;
+        long long relationship_end_node_id() const;
+        string_ref relationship_type_ref() const;
+        snapshot_value relationship_properties_ref() const;
+
+        // Decode into an owned value, paths included
+        value to_owned() const;
+        // The encoded bytes of this value
+        string_ref raw() const;
+    };
+
+    class snapshot_value::iterator {
+        const uint8_t* pos = nullptr;
+        const uint8_t* next = nullptr;
+        const uint8_t* stop = nullptr;
+        size_t left = 0;
+        bool pairs = false;
+        string_ref k;
+        snapshot_value current;
+
+        void load();
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = snapshot_value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const snapshot_value*;
+        using reference = const snapshot_value&;
+
+        iterator() noexcept {}
+        // Count entries (key value pairs if pairs is set) starting at data
+        iterator(const uint8_t* data, const uint8_t* end, size_t count, bool pairs);
+
+        reference operator*() const noexcept { return current; }
+        pointer operator->() const noexcept { return &current; }
+        // Key of the current map entry
+        string_ref key() const noexcept { return k; }
+        iterator& operator++();
+        iterator operator++(int) { auto res = *this; ++*this; return res; }
+        bool operator==(const iterator& other) const noexcept { return left == other.left && (left == 0 || pos == other.pos); }
+        bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+    };
+
+    // Writes rows to a snapshot file: a header with the column names, one
+    // length prefixed PackStream record per row and a record index, so a
+    // snapshot can be reloaded with snapshot and read without the server.
+    class snapshot_writer {
+        FILE* file;
+        std::string path;
+        unsigned int fields;
+        packstream_writer buf;
+        std::vector<uint64_t> offsets;
+        uint64_t pos;
+
+        void put(const std::vector<uint8_t>& data);
+    public:
+        snapshot_writer(const std::string& path, const std::vector<std::string>& fieldnames);
+        // Takes the column names from stream, the rows still have to be written
+        snapshot_writer(const std::string& path, result_stream& stream);
+        // Finishes the file if close() was not called, errors are ignored
+        ~snapshot_writer();
+
+        snapshot_writer(const snapshot_writer&) = delete;
+        snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+        void write(const result& row);
+        // Write all remaining rows of stream, returns the number of rows
+        unsigned long long write_all(result_stream& stream);
+        // Write the index and the header. The file is unreadable before.
+        void close();
+
+        unsigned long long size() const noexcept { return offsets.size(); }
+    };
+
+    // A snapshot file mapped into memory.
+    class snapshot {
+        const uint8_t* data;
+        size_t len;
+        std::vector<std::string> names;
+        uint64_t records;
+        const uint8_t* index;
+    public:
+        explicit snapshot(const std::string& path);
+        ~snapshot();
+
+        snapshot(snapshot&& other) noexcept;
+        snapshot& operator=(snapshot&& other) noexcept;
+        snapshot(const snapshot&) = delete;
+        snapshot& operator=(const snapshot&) = delete;
+
+        unsigned int nfields() const noexcept { return static_cast<unsigned int>(names.size()); }
+        const std::string& fieldname(unsigned int idx) const;
+        unsigned long long size() const noexcept { return records; }
+        // Encoded fields of record idx
+        string_ref record(unsigned long long idx) const;
+    };
+
+    // Iterates a snapshot like result_cursor iterates a result_stream.
+    class snapshot_cursor {
+        const snapshot* snap;
+        unsigned long long rows = 0;
+        bool on_row = false;
+        std::vector<snapshot_value> current;
+    public:
+        explicit snapshot_cursor(const snapshot& snap) noexcept;
+
+        bool next();
+        // Position the cursor so the following next() returns record idx
+        void seek(unsigned long long idx) noexcept;
+
+        bool valid() const noexcept { return on_row; }
+        unsigned int nfields() const noexcept { return snap->nfields(); }
+        unsigned long long position() const noexcept { return rows; }
+
+        const snapshot_value& field(unsigned int idx) const;
+        value copy_field(unsigned int idx) const;
+        std::vector<value> copy_row() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/snapshot.h"
+#endif
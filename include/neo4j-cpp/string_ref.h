@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <ostream>
+
+namespace neo4j {
+    // Non-owning, not null terminated view of string data inside a result row.
+    class string_ref {
+        const char* ptr = nullptr;
+        size_t len = 0;
+    public:
+        string_ref() noexcept = default;
+        string_ref(const char* data, size_t size) noexcept : ptr(data), len(size) {}
+        string_ref(const char* str) noexcept : ptr(str), len(str == nullptr ? 0 : strlen(str)) {}
+        string_ref(const std::string& str) noexcept : ptr(str.data()), len(str.size()) {}
+
+        const char* data() const noexcept { return ptr; }
+        size_t size() const noexcept { return len; }
+        bool empty() const noexcept { return len == 0; }
+        const char* begin() const noexcept { return ptr; }
+        const char* end() const noexcept { return ptr + len; }
+        char operator[](size_t idx) const noexcept { return ptr[idx]; }
+
+        std::string str() const { return std::string(ptr, len); }
+
+        int compare(string_ref other) const noexcept {
+            size_t n = len < other.len ? len : other.len;
+            int res = n == 0 ? 0 : memcmp(ptr, other.ptr, n);
+            if(res != 0) return res;
+            return len < other.len ? -1 : len > other.len;
+        }
+        bool operator==(string_ref other) const noexcept { return len == other.len && (len == 0 || memcmp(ptr, other.ptr, len) == 0); }
+        bool operator!=(string_ref other) const noexcept { return !(*this == other); }
+        bool operator<(string_ref other) const noexcept { return compare(other) < 0; }
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, string_ref str) {
+        return os.write(str.data(), str.size());
+    }
+}
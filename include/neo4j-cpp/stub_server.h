@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "value.h"
+
+namespace neo4j {
+    // Minimal Bolt (v1) server answering statements from a callback. It listens
+    // on a loopback port and is meant as a stand-in for a database in tests
+    // and benchmarks, it does not evaluate Cypher. Not part of neo4j-cpp.h,
+    // include it explicitly (and impl/stub_server.h once with NEO4JPP_IMPL_FILE).
+    class stub_server {
+    public:
+        struct response {
+            std::vector<std::string> fields;
+            std::vector<std::vector<value>> records;
+            // A non empty code answers the statement with a FAILURE
+            std::string failure_code;
+            std::string failure_message;
+            // Statement type reported in the summary: "r", "w", "rw" or "s"
+            std::string type = "r";
+            // Delay before the records are streamed
+            std::chrono::milliseconds delay{0};
+        };
+        // Params is the parameter map sent with the statement
+        using handler = std::function<response(const std::string& query, const value& params)>;
+    private:
+        handler fn;
+        int listen_fd = -1;
+        uint16_t port_no = 0;
+        std::atomic<bool> stopping{false};
+        std::atomic<size_t> nstatements{0};
+        std::atomic<size_t> nconnections{0};
+        std::mutex mtx;
+        std::vector<int> client_fds;
+        std::vector<std::thread> clients;
+        std::thread acceptor;
+
+        void accept_loop();
+        void serve(int fd);
+    public:
+        // Port 0 picks a free port
+        explicit stub_server(handler h, uint16_t port = 0);
+        ~stub_server();
+
+        stub_server(const stub_server&) = delete;
+        stub_server& operator=(const stub_server&) = delete;
+
+        uint16_t port() const noexcept { return port_no; }
+        std::string address() const { return "127.0.0.1:" + std::to_string(port_no); }
+        std::string uri() const { return "neo4j://" + address(); }
+
+        size_t statements() const noexcept { return nstatements; }
+        size_t connections() const noexcept { return nconnections; }
+
+        void stop();
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/stub_server.h"
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <memory>
+#include <atomic>
+
+struct neo4j_connection_factory;
+
+namespace neo4j {
+    // Interrupt handle of one socket made by interruptible_tcp_factory(),
+    // shared between the socket and the connection using it.
+    class transport_interrupt {
+        std::atomic<bool> flag{false};
+        // Self pipe waking a read or write blocked in poll()
+        int pipe_fds[2];
+    public:
+        transport_interrupt();
+        ~transport_interrupt();
+
+        transport_interrupt(const transport_interrupt&) = delete;
+        transport_interrupt& operator=(const transport_interrupt&) = delete;
+
+        // Safe to call from any thread. Blocked and later reads and writes on
+        // the socket fail with ECANCELED until clear() is called.
+        void interrupt() noexcept;
+        void clear() noexcept;
+        // Read pending wakeups without touching the flag, e.g. a byte an
+        // interrupt() racing clear() left behind.
+        void drain() noexcept;
+        bool is_interrupted() const noexcept { return flag; }
+        int wait_fd() const noexcept { return pipe_fds[0]; }
+
+        // While a capture exists, sockets made on the same thread hand their
+        // handle to it. Connections use this to find the socket beneath
+        // wrapping factories like buffer_tuner.
+        class capture {
+            std::shared_ptr<transport_interrupt>* prev;
+        public:
+            explicit capture(std::shared_ptr<transport_interrupt>& target) noexcept;
+            ~capture();
+
+            capture(const capture&) = delete;
+            capture& operator=(const capture&) = delete;
+
+            static void offer(const std::shared_ptr<transport_interrupt>& handle) noexcept;
+        };
+    };
+
+    // TCP connection factory whose blocking socket reads and writes can be
+    // aborted from another thread, POSIX only. Enable it with
+    // config::set_interruptible_io to let a statement deadline wake a fetch
+    // stuck on a stalled server.
+    struct neo4j_connection_factory* interruptible_tcp_factory() noexcept;
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/transport.h"
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include <memory>
+#include <cstddef>
+
+struct neo4j_connection_factory;
+
+namespace neo4j {
+    class config;
+
+    struct buffer_tuning_options {
+        size_t min_size = 4096;
+        size_t max_size = 1024 * 1024;
+        // Starting point for the libneo4j read and write buffers
+        size_t initial_rcvbuf = 4096;
+        size_t initial_sndbuf = 4096;
+        // Reads (or writes) observed per sizing decision
+        unsigned int window = 64;
+        // Also size the kernel socket buffers once the buffers grew past
+        // socket_threshold. Below it the kernel's autotuning is kept.
+        bool tune_socket = true;
+        size_t socket_threshold = 64 * 1024;
+    };
+
+    struct traffic_stats {
+        unsigned long long connections;
+        unsigned long long bytes_received;
+        unsigned long long bytes_sent;
+        unsigned long long reads;
+        // Reads that filled the whole buffer, i.e. more data was waiting
+        unsigned long long full_reads;
+        unsigned long long writes;
+        // Nanoseconds spent in socket reads, bytes_received over this is
+        // the read throughput
+        unsigned long long read_ns;
+        size_t rcvbuf_size;
+        size_t sndbuf_size;
+        unsigned long long adjustments;
+    };
+
+    // Observes the traffic of connections made through its factory and sizes
+    // the buffers for new connections: bulk reads that keep filling the
+    // read buffer grow it, point lookups using a fraction of it shrink it.
+    // Writes size the send buffer the same way. Use it with
+    // connection_pool::set_buffer_tuner or apply it to a config yourself.
+    class buffer_tuner {
+    public:
+        struct state;
+    private:
+        std::shared_ptr<state> st;
+    public:
+        // Inner is the factory actually connecting, nullptr uses libneo4j's TCP factory
+        explicit buffer_tuner(const buffer_tuning_options& opts = buffer_tuning_options(), struct neo4j_connection_factory* inner = nullptr);
+        ~buffer_tuner();
+
+        buffer_tuner(const buffer_tuner&) = delete;
+        buffer_tuner& operator=(const buffer_tuner&) = delete;
+
+        // Installs the factory and the current buffer sizes in conf
+        void apply(config& conf) const;
+        struct neo4j_connection_factory* get() const noexcept;
+
+        size_t rcvbuf_size() const noexcept;
+        size_t sndbuf_size() const noexcept;
+        traffic_stats stats() const noexcept;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/tuning.h"
+#endif
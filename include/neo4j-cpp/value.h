@@ -3,11 +3,14 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <memory>
+#include "error.h"
 
 struct neo4j_result;
 struct neo4j_value;
 
 namespace neo4j {
+    class value_ref;
     enum class value_type {
         type_null,
         type_bool,
@@ -49,9 +52,17 @@ namespace neo4j {
         class bytes_data;
         class list_data;
         class map_data;
-        struct neo4j_result* result;
+        class struct_data;
+        struct neo4j_result* result = nullptr;
         std::unique_ptr<struct neo4j_value> val;
-        std::unique_ptr<data_base> data;
+        // User built values are immutable and shared between copies.
+        std::shared_ptr<const data_base> data;
+
+        static value from_struct(value_type type, std::vector<value> fields);
+        // Part of this value, keeping its row or user built data alive
+        value child(struct neo4j_value part) const;
+        friend class value_ref;
+        friend class packstream_reader;
     public:
         value();
         value(bool b);
@@ -64,10 +75,15 @@ namespace neo4j {
 
         value(struct neo4j_result* parent, struct neo4j_value val);
         value(const value&);
+        // Leaves other null
+        value(value&&) noexcept;
         value& operator=(const value&);
+        value& operator=(value&&) noexcept;
         ~value();
 
         struct neo4j_value get_value() const;
+        // Borrow this value without touching the reference count of its row.
+        value_ref ref() const noexcept;
 
         value_type get_type() const noexcept;
 
@@ -91,6 +107,11 @@ namespace neo4j {
         std::vector<uint8_t> to_bytes() const;
         long long to_identity() const;
 
+        expected<bool> try_to_bool() const noexcept;
+        expected<long long> try_to_int() const noexcept;
+        expected<double> try_to_float() const noexcept;
+        expected<std::string> try_to_string() const;
+        expected<long long> try_to_identity() const noexcept;
 
         unsigned int list_size() const;
         value list_entry(unsigned int idx) const;
@@ -116,7 +137,43 @@ namespace neo4j {
 
         std::string dump() const;
     };
+
+    // Mutable builders for composite values. build() moves the collected entries
+    // into an immutable value, copies of which are O(1).
+    class list_builder {
+        std::vector<value> items;
+    public:
+        list_builder() = default;
+        explicit list_builder(size_t capacity) { items.reserve(capacity); }
+
+        list_builder& reserve(size_t capacity) { items.reserve(capacity); return *this; }
+        list_builder& push_back(value v) { items.push_back(std::move(v)); return *this; }
+        size_t size() const noexcept { return items.size(); }
+        bool empty() const noexcept { return items.empty(); }
+
+        value build() {
+            value res(std::move(items));
+            items.clear();
+            return res;
+        }
+    };
+
+    class map_builder {
+        std::map<std::string, value> items;
+    public:
+        map_builder& set(std::string key, value v) { items[std::move(key)] = std::move(v); return *this; }
+        map_builder& erase(const std::string& key) { items.erase(key); return *this; }
+        size_t size() const noexcept { return items.size(); }
+        bool empty() const noexcept { return items.empty(); }
+
+        value build() {
+            value res(std::move(items));
+            items.clear();
+            return res;
+        }
+    };
 }
+#include "value_ref.h"
 #ifndef NEO4JPP_IMPL_FILE
 #include "impl/value.h"
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include "value.h"
+#include "error.h"
+#include "string_ref.h"
+
+struct neo4j_result;
+struct neo4j_value;
+
+namespace neo4j {
+    // Non-owning view of a value inside a result row (or a user built value).
+    // Unlike value it never retains the row, so it must not outlive the
+    // neo4j::result or neo4j::value it was obtained from. Use to_owned() to
+    // keep a copy beyond that.
+    class value_ref {
+        struct neo4j_result* result;
+        alignas(8) unsigned char raw[16];
+
+        const struct neo4j_value& get() const noexcept;
+        static long long identity_value(struct neo4j_value id);
+        static std::string string_value(struct neo4j_value str);
+    public:
+        value_ref() noexcept;
+        value_ref(struct neo4j_result* parent, struct neo4j_value val) noexcept;
+
+        struct neo4j_value get_value() const noexcept;
+        struct neo4j_result* get_result() const noexcept { return result; }
+
+        value_type get_type() const noexcept;
+
+        bool is_null() const noexcept { return get_type() == value_type::type_null; }
+        bool is_bool() const noexcept { return get_type() == value_type::type_bool; }
+        bool is_int() const noexcept { return get_type() == value_type::type_int; }
+        bool is_float() const noexcept { return get_type() == value_type::type_float; }
+        bool is_string() const noexcept { return get_type() == value_type::type_string; }
+        bool is_bytes() const noexcept { return get_type() == value_type::type_bytes; }
+        bool is_list() const noexcept { return get_type() == value_type::type_list; }
+        bool is_map() const noexcept { return get_type() == value_type::type_map; }
+        bool is_node() const noexcept { return get_type() == value_type::type_node; }
+        bool is_relationship() const noexcept { return get_type() == value_type::type_relationship; }
+        bool is_path() const noexcept { return get_type() == value_type::type_path; }
+        bool is_identity() const noexcept { return get_type() == value_type::type_identity; }
+
+        bool to_bool() const;
+        long long to_int() const;
+        double to_float() const;
+        std::string to_string() const;
+        // Points into the row, no copy is made
+        string_ref to_string_ref() const;
+        std::vector<uint8_t> to_bytes() const;
+        string_ref to_bytes_ref() const;
+        long long to_identity() const;
+
+        // Non throwing accessors, a type mismatch is reported as std::errc::invalid_argument.
+        expected<bool> try_to_bool() const noexcept;
+        expected<long long> try_to_int() const noexcept;
+        expected<double> try_to_float() const noexcept;
+        expected<std::string> try_to_string() const;
+        expected<long long> try_to_identity() const noexcept;
+
+        unsigned int list_size() const;
+        value_ref list_entry(unsigned int idx) const;
+        expected<value_ref> try_list_entry(unsigned int idx) const noexcept;
+
+        std::map<std::string, value_ref> to_map() const;
+        std::set<std::string> map_keys() const;
+        value_ref map_entry(const std::string& key) const;
+        // Entries by position, in wire order
+        unsigned int map_size() const;
+        string_ref map_key(unsigned int idx) const;
+        value_ref map_value(unsigned int idx) const;
+
+        long long node_id() const;
+        std::set<std::string> node_labels() const;
+        unsigned int node_label_count() const;
+        string_ref node_label(unsigned int idx) const;
+        bool node_has_label(string_ref label) const;
+        std::map<std::string, value_ref> node_properties() const;
+        value_ref node_properties_ref() const;
+
+        long long relationship_id() const;
+        long long relationship_start_node_id() const;
+        long long relationship_end_node_id() const;
+        std::string relationship_type() const;
+        string_ref relationship_type_ref() const;
+        std::map<std::string, value_ref> relationship_properties() const;
+        value_ref relationship_properties_ref() const;
+
+        unsigned int path_length() const;
+        value_ref path_node(unsigned int hops) const;
+        value_ref path_relationship(unsigned int hops, bool& forward) const;
+        value_ref path_relationship(unsigned int hops) const;
+
+        // Copy the referenced value out of its row, the copy never retains
+        // it. Throws for types that can not be rebuilt client side.
+        value to_owned() const;
+
+        std::string dump() const;
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/value_ref.h"
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include "value.h"
+#include "value_ref.h"
+#include "path.h"
+#include "string_ref.h"
+
+namespace neo4j {
+    // No-op callbacks for visit(). Derive from it and hide the callbacks of
+    // interest; dispatch is static, nothing is virtual.
+    struct value_visitor {
+        void on_null() {}
+        void on_bool(bool) {}
+        void on_int(long long) {}
+        void on_float(double) {}
+        void on_string(string_ref) {}
+        void on_bytes(string_ref) {}
+        void on_identity(long long) {}
+        void begin_list(unsigned int /*size*/) {}
+        void end_list() {}
+        // Each entry is an on_key followed by the value's events
+        void begin_map(unsigned int /*size*/) {}
+        void on_key(string_ref) {}
+        void end_map() {}
+        // Followed by an on_label per label and the properties as a map
+        void begin_node(long long /*id*/) {}
+        void on_label(string_ref) {}
+        void end_node() {}
+        // Followed by the properties as a map
+        void begin_relationship(long long /*id*/, long long /*start*/, long long /*end*/, string_ref /*type*/) {}
+        void end_relationship() {}
+        // Nodes and relationships in path order, starting and ending with a node
+        void begin_path(unsigned int /*length*/) {}
+        void end_path() {}
+        // Only emitted by result_stream::for_each_event
+        void begin_record(unsigned int /*nfields*/) {}
+        void end_record() {}
+    };
+
+    // Emit the events for val and everything nested inside it, reading
+    // straight from the row without building values.
+    template<typename Visitor>
+    void visit(const value_ref& val, Visitor&& v) {
+        switch(val.get_type()) {
+            case value_type::type_null: v.on_null(); break;
+            case value_type::type_bool: v.on_bool(val.to_bool()); break;
+            case value_type::type_int: v.on_int(val.to_int()); break;
+            case value_type::type_float: v.on_float(val.to_float()); break;
+            case value_type::type_string: v.on_string(val.to_string_ref()); break;
+            case value_type::type_bytes: v.on_bytes(val.to_bytes_ref()); break;
+            case value_type::type_identity: v.on_identity(val.to_identity()); break;
+            case value_type::type_list: {
+                auto size = val.list_size();
+                v.begin_list(size);
+                for(unsigned int i = 0; i < size; i++) visit(val.list_entry(i), v);
+                v.end_list();
+                break;
+            }
+            case value_type::type_map: {
+                auto size = val.map_size();
+                v.begin_map(size);
+                for(unsigned int i = 0; i < size; i++) {
+                    v.on_key(val.map_key(i));
+                    visit(val.map_value(i), v);
+                }
+                v.end_map();
+                break;
+            }
+            case value_type::type_node: {
+                v.begin_node(val.node_id());
+                auto labels = val.node_label_count();
+                for(unsigned int i = 0; i < labels; i++) v.on_label(val.node_label(i));
+                visit(val.node_properties_ref(), v);
+                v.end_node();
+                break;
+            }
+            case value_type::type_relationship: {
+                v.begin_relationship(val.relationship_id(), val.relationship_start_node_id(),
+                    val.relationship_end_node_id(), val.relationship_type_ref());
+                visit(val.relationship_properties_ref(), v);
+                v.end_relationship();
+                break;
+            }
+            case value_type::type_path: {
+                path_view path(val);
+                v.begin_path(path.length());
+                visit(path.start_node(), v);
+                for(auto it = path.begin(); it != path.end(); ++it) {
+                    // Relationships inside a path may be unbound, the hop gives their endpoints
+                    auto step = *it;
+                    auto next = path.node(it.index() + 1);
+                    auto a = step.node.node_id(), b = next.node_id();
+                    v.begin_relationship(step.relationship.relationship_id(), step.forward ? a : b,
+                        step.forward ? b : a, step.relationship.relationship_type_ref());
+                    visit(step.relationship.relationship_properties_ref(), v);
+                    v.end_relationship();
+                    visit(next, v);
+                }
+                v.end_path();
+                break;
+            }
+            default:
+                v.on_null();
+                break;
+        }
+    }
+
+    template<typename Visitor>
+    void visit(const value& val, Visitor&& v) {
+        visit(val.ref(), v);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace neo4j {
+    // Single thread running timers on a hashed timer wheel. Used to enforce
+    // statement deadlines without a thread per query.
+    class watchdog {
+    public:
+        using clock = std::chrono::steady_clock;
+        using timer_id = uint64_t;
+    private:
+        struct timer {
+            timer_id id;
+            clock::time_point deadline;
+            std::function<void()> fn;
+        };
+        using slot = std::list<timer>;
+
+        const clock::duration tick;
+        const clock::time_point epoch;
+        std::vector<slot> wheel;
+        std::unordered_map<timer_id, std::pair<size_t, slot::iterator>> index;
+        uint64_t current_tick = 0;
+        timer_id next_id = 1;
+        timer_id running = 0;
+        bool stop = false;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::thread worker;
+
+        uint64_t tick_of(clock::time_point t) const noexcept;
+        void run();
+    public:
+        explicit watchdog(std::chrono::milliseconds tick = std::chrono::milliseconds(10), size_t slots = 512);
+        ~watchdog();
+
+        watchdog(const watchdog&) = delete;
+        watchdog& operator=(const watchdog&) = delete;
+
+        // Run fn on the watchdog thread once deadline passed (with tick resolution).
+        timer_id schedule(clock::time_point deadline, std::function<void()> fn);
+        timer_id schedule(clock::duration timeout, std::function<void()> fn) { return schedule(clock::now() + timeout, std::move(fn)); }
+        // Returns false if the timer already fired. If its callback is running
+        // right now, waits for it to complete.
+        bool cancel(timer_id id);
+        size_t pending() noexcept;
+
+        // Shared instance used for statement deadlines.
+        static watchdog& global();
+    };
+}
+#ifndef NEO4JPP_IMPL_FILE
+#include "impl/watchdog.h"
+#endif
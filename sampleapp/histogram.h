@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Log-linear histogram in the style of HdrHistogram: values are grouped by
+// their highest bit, each group is split into 2^precision linear buckets.
+// With precision 11 the relative error stays below 0.05% (3 significant digits).
+class histogram {
+    unsigned int precision;
+    uint64_t sub_count;
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+    uint64_t min_value = UINT64_MAX;
+    double sum = 0;
+
+    size_t index_of(uint64_t v) const noexcept {
+        if(v < sub_count) return static_cast<size_t>(v);
+        // v >> shift lies in [sub_count / 2, sub_count)
+        unsigned int shift = 63 - __builtin_clzll(v) - (precision - 1);
+        uint64_t half = sub_count / 2;
+        return static_cast<size_t>(sub_count + (shift - 1) * half + ((v >> shift) - half));
+    }
+
+    uint64_t value_of(size_t idx) const noexcept {
+        if(idx < sub_count) return idx;
+        uint64_t half = sub_count / 2;
+        uint64_t k = idx - sub_count;
+        unsigned int shift = static_cast<unsigned int>(k / half + 1);
+        uint64_t sub = k % half + half;
+        // Upper end of the bucket
+        return ((sub + 1) << shift) - 1;
+    }
+public:
+    explicit histogram(unsigned int precision_bits = 11)
+        : precision(precision_bits), sub_count(1ull << precision_bits), counts(index_of(UINT64_MAX) + 1, 0)
+    {}
+
+    void record(uint64_t v) noexcept {
+        counts[index_of(v)]++;
+        total++;
+        sum += static_cast<double>(v);
+        max_value = std::max(max_value, v);
+        min_value = std::min(min_value, v);
+    }
+
+    void merge(const histogram& other) {
+        for(size_t i = 0; i < counts.size() && i < other.counts.size(); i++) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        max_value = std::max(max_value, other.max_value);
+        min_value = std::min(min_value, other.min_value);
+    }
+
+    uint64_t count() const noexcept { return total; }
+    uint64_t max() const noexcept { return max_value; }
+    uint64_t min() const noexcept { return total == 0 ? 0 : min_value; }
+    double mean() const noexcept { return total == 0 ? 0 : sum / total; }
+
+    // Value below which the given percentage (0-100) of the recorded values fall
+    uint64_t percentile(double p) const noexcept {
+        if(total == 0) return 0;
+        auto rank = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+        if(rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for(size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if(seen >= rank) return std::min(value_of(i), max_value);
+        }
+        return max_value;
+    }
+};
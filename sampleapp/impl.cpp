@@ -1 +1,5 @@
-#include <neo4j-cpp/impl/impl-all.h>
\ No newline at end of file
+#include <neo4j-cpp/impl/impl-all.h>
+#ifdef NEO4JPP_IMPL_FILE
+// Not part of impl-all.h, see stub_server.h
+#include <neo4j-cpp/impl/stub_server.h>
+#endif
\ No newline at end of file
@@ -1,32 +1,275 @@
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <chrono>
 #include <neo4j-cpp/neo4j-cpp.h>
+#include <neo4j-cpp/stub_server.h>
+#include "histogram.h"
+#include "workload.h"
+
+using steady = std::chrono::steady_clock;
+
+namespace {
+    struct options {
+        std::string uri;
+        std::string workload_file;
+        std::string query = "RETURN 1";
+        std::string params;
+        unsigned int concurrency = 1;
+        unsigned int connections = 0;
+        double qps = 0;
+        double duration = 10;
+        std::string csv;
+        long long stub_rows = -1;
+        bool insecure = false;
+        bool adaptive_buffers = false;
+        double warmup = 2;
+    };
+
+    // Latencies in nanoseconds, measured from the intended start of a request
+    struct statement_stats {
+        histogram first_record;
+        histogram full_stream;
+        unsigned long long errors = 0;
+        unsigned long long records = 0;
+
+        void merge(const statement_stats& other) {
+            first_record.merge(other.first_record);
+            full_stream.merge(other.full_stream);
+            errors += other.errors;
+            records += other.records;
+        }
+    };
+
+    struct shared_connection {
+        std::mutex mtx;
+        std::shared_ptr<neo4j::connection> con;
+    };
+
+    void usage(const char* name) {
+        std::cerr << "Usage: " << name << " [options] <uri>\n"
+            << "       " << name << " [options] --stub <rows>\n\n"
+            << "  --workload <file>     weighted statements, see sampleapp/workload.h\n"
+            << "  --query <cypher>      single statement workload (default RETURN 1)\n"
+            << "  --params <specs>      parameters of --query, e.g. \"id=1..1000, limit=10\"\n"
+            << "  --concurrency <n>     concurrent requests (default 1)\n"
+            << "  --connections <n>     connections shared by the workers (default concurrency)\n"
+            << "  --qps <n>             open loop target rate, 0 runs closed loop (default 0)\n"
+            << "  --duration <seconds>  (default 10)\n"
+            << "  --csv <file>          write the results as CSV\n"
+            << "  --stub <rows>         benchmark against an in-process stub server returning rows per statement\n"
+            << "  --insecure            connect without TLS\n"
+            << "  --adaptive-buffers    size the socket buffers from the traffic seen during warmup\n"
+            << "  --warmup <seconds>    warmup before reconnecting with the adapted buffers (default 2)\n";
+    }
+
+    bool parse_args(int argc, const char** argv, options& opts) {
+        for(int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if(arg == "--insecure") opts.insecure = true;
+            else if(arg == "--adaptive-buffers") opts.adaptive_buffers = true;
+            else if(arg.compare(0, 2, "--") != 0 && opts.uri.empty()) opts.uri = arg;
+            else if(!has_value) return false;
+            else if(arg == "--workload") opts.workload_file = argv[++i];
+            else if(arg == "--query") opts.query = argv[++i];
+            else if(arg == "--params") opts.params = argv[++i];
+            else if(arg == "--concurrency") opts.concurrency = std::stoul(argv[++i]);
+            else if(arg == "--connections") opts.connections = std::stoul(argv[++i]);
+            else if(arg == "--qps") opts.qps = std::stod(argv[++i]);
+            else if(arg == "--duration") opts.duration = std::stod(argv[++i]);
+            else if(arg == "--csv") opts.csv = argv[++i];
+            else if(arg == "--stub") opts.stub_rows = std::stoll(argv[++i]);
+            else if(arg == "--warmup") opts.warmup = std::stod(argv[++i]);
+            else return false;
+        }
+        if(opts.concurrency == 0) opts.concurrency = 1;
+        if(opts.connections == 0 || opts.connections > opts.concurrency) opts.connections = opts.concurrency;
+        return !opts.uri.empty() || opts.stub_rows >= 0;
+    }
+
+    void run_worker(unsigned int id, const options& opts, const workload& wl, std::vector<std::unique_ptr<shared_connection>>& cons,
+        steady::time_point start, steady::time_point end, std::vector<statement_stats>& stats) {
+        std::mt19937_64 rng(id * 7919 + 1);
+        auto& shared = *cons[id % cons.size()];
+        // Each worker owns every concurrency-th slot of the open loop schedule
+        auto interval = opts.qps > 0 ? std::chrono::duration<double>(opts.concurrency / opts.qps) : std::chrono::duration<double>(0);
+        auto offset = opts.qps > 0 ? std::chrono::duration<double>(id / opts.qps) : std::chrono::duration<double>(0);
+        for(unsigned long long i = 0;; i++) {
+            steady::time_point intended;
+            if(opts.qps > 0) {
+                intended = start + std::chrono::duration_cast<steady::duration>(offset + interval * static_cast<double>(i));
+                if(intended >= end) break;
+                std::this_thread::sleep_until(intended);
+            } else {
+                intended = steady::now();
+                if(intended >= end) break;
+            }
+            auto idx = wl.pick(rng);
+            auto& stmt = wl.statements()[idx];
+            auto& st = stats[idx];
+            auto params = stmt.make_params(rng);
+            std::lock_guard<std::mutex> lck(shared.mtx);
+            try {
+                auto stream = shared.con->run(stmt.query, params);
+                auto rec = stream->fetch_next();
+                st.first_record.record((steady::now() - intended).count());
+                unsigned long long rows = rec ? 1 : 0;
+                while(stream->fetch_next()) rows++;
+                st.full_stream.record((steady::now() - intended).count());
+                st.records += rows;
+            } catch(const std::exception&) {
+                st.errors++;
+                std::error_code ec;
+                shared.con->reset(ec);
+            }
+        }
+    }
+
+    std::string shorten(const std::string& query, size_t len) {
+        if(query.size() <= len) return query;
+        return query.substr(0, len - 3) + "...";
+    }
+
+    void print_row(std::ostream& os, const std::string& name, const char* metric, const histogram& h, unsigned long long errors, double seconds) {
+        auto ms = [](uint64_t ns) { return ns / 1e6; };
+        os << std::left << std::setw(32) << shorten(name, 31) << std::setw(7) << metric << std::right
+            << std::setw(10) << h.count() << std::setw(8) << errors
+            << std::setw(11) << std::fixed << std::setprecision(1) << h.count() / seconds
+            << std::setprecision(3)
+            << std::setw(10) << ms(h.percentile(50)) << std::setw(10) << ms(h.percentile(99))
+            << std::setw(10) << ms(h.percentile(99.9)) << std::setw(10) << ms(h.max()) << "\n";
+    }
+
+    std::string csv_quote(const std::string& str) {
+        std::string res = "\"";
+        for(auto c : str) {
+            if(c == '"') res += '"';
+            res += c;
+        }
+        return res + "\"";
+    }
+
+    void csv_row(std::ostream& os, const std::string& name, const char* metric, const histogram& h, unsigned long long errors, double seconds) {
+        auto us = [](uint64_t ns) { return ns / 1e3; };
+        os << csv_quote(name) << "," << metric << "," << h.count() << "," << errors << "," << h.count() / seconds << ","
+            << us(h.mean()) << "," << us(h.percentile(50)) << "," << us(h.percentile(90)) << "," << us(h.percentile(99)) << ","
+            << us(h.percentile(99.9)) << "," << us(h.max()) << "\n";
+    }
+}
 
 int main(int argc, const char** argv) {
-    if(argc < 2) {
-        std::cerr << argv[0] << " <host>" << std::endl;
+    options opts;
+    try {
+        if(!parse_args(argc, argv, opts)) {
+            usage(argv[0]);
+            return -1;
+        }
+    } catch(const std::exception&) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    try {
+        neo4j::client::init();
+        auto wl = opts.workload_file.empty() ? workload::single(opts.query, opts.params) : workload::load(opts.workload_file);
+
+        std::unique_ptr<neo4j::stub_server> stub;
+        if(opts.stub_rows >= 0) {
+            auto rows = opts.stub_rows;
+            stub.reset(new neo4j::stub_server([rows](const std::string&, const neo4j::value&) {
+                neo4j::stub_server::response res;
+                res.fields = { "id", "name" };
+                for(long long i = 0; i < rows; i++) res.records.push_back({ neo4j::value(i), neo4j::value(std::string("row ") + std::to_string(i)) });
+                return res;
+            }));
+            opts.uri = stub->uri();
+            opts.insecure = true;
+        }
+
+        std::unique_ptr<neo4j::buffer_tuner> tuner;
+        if(opts.adaptive_buffers) tuner.reset(new neo4j::buffer_tuner());
+        std::vector<std::unique_ptr<shared_connection>> cons;
+        auto connect_all = [&]() {
+            cons.clear();
+            neo4j::config conf;
+            if(tuner) tuner->apply(conf);
+            auto shared = conf.freeze();
+            for(unsigned int i = 0; i < opts.connections; i++) {
+                cons.emplace_back(new shared_connection());
+                cons.back()->con = neo4j::client::connect(opts.uri, shared, opts.insecure ? neo4j::connect_flags::insecure : neo4j::connect_flags::none);
+            }
+        };
+        auto run_all = [&](double duration, std::vector<std::vector<statement_stats>>& stats) {
+            auto start = steady::now() + std::chrono::milliseconds(10);
+            auto end = start + std::chrono::duration_cast<steady::duration>(std::chrono::duration<double>(duration));
+            std::vector<std::thread> workers;
+            for(unsigned int i = 0; i < opts.concurrency; i++)
+                workers.emplace_back([&, i]() { run_worker(i, opts, wl, cons, start, end, stats[i]); });
+            for(auto& t : workers) t.join();
+            return std::chrono::duration<double>(steady::now() - start).count();
+        };
+
+        connect_all();
+        if(tuner && opts.warmup > 0) {
+            // libneo4j sizes its buffers at connect time, so the measured run reconnects
+            std::vector<std::vector<statement_stats>> warmup(opts.concurrency, std::vector<statement_stats>(wl.statements().size()));
+            run_all(opts.warmup, warmup);
+            connect_all();
+        }
+        std::vector<std::vector<statement_stats>> stats(opts.concurrency, std::vector<statement_stats>(wl.statements().size()));
+        double seconds = run_all(opts.duration, stats);
+
+        std::vector<statement_stats> merged(wl.statements().size());
+        statement_stats all;
+        for(auto& worker : stats) {
+            for(size_t i = 0; i < worker.size(); i++) merged[i].merge(worker[i]);
+        }
+        for(auto& s : merged) all.merge(s);
+
+        std::cout << "target " << opts.uri << ", " << opts.concurrency << " workers on " << opts.connections << " connections, "
+            << (opts.qps > 0 ? std::to_string(opts.qps) + " qps open loop" : std::string("closed loop")) << ", "
+            << std::fixed << std::setprecision(1) << seconds << " s, " << all.records << " records\n";
+        if(tuner) {
+            auto ts = tuner->stats();
+            std::cout << "adaptive buffers: rcvbuf " << ts.rcvbuf_size << ", sndbuf " << ts.sndbuf_size << " after " << ts.adjustments << " adjustments, "
+                << std::setprecision(1) << (ts.reads ? 100.0 * ts.full_reads / ts.reads : 0.0) << "% full reads\n";
+        }
+        std::cout << "\n";
+        std::cout << std::left << std::setw(32) << "statement" << std::setw(7) << "metric" << std::right
+            << std::setw(10) << "count" << std::setw(8) << "errors" << std::setw(11) << "per sec"
+            << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p999 ms" << std::setw(10) << "max ms" << "\n";
+        for(size_t i = 0; i < merged.size(); i++) {
+            auto& name = wl.statements()[i].query;
+            print_row(std::cout, name, "first", merged[i].first_record, merged[i].errors, seconds);
+            print_row(std::cout, name, "full", merged[i].full_stream, merged[i].errors, seconds);
+        }
+        if(merged.size() > 1) {
+            print_row(std::cout, "all", "first", all.first_record, all.errors, seconds);
+            print_row(std::cout, "all", "full", all.full_stream, all.errors, seconds);
+        }
+
+        if(!opts.csv.empty()) {
+            std::ofstream csv(opts.csv);
+            csv << "statement,metric,count,errors,per_sec,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+            for(size_t i = 0; i < merged.size(); i++) {
+                auto& name = wl.statements()[i].query;
+                csv_row(csv, name, "first", merged[i].first_record, merged[i].errors, seconds);
+                csv_row(csv, name, "full", merged[i].full_stream, merged[i].errors, seconds);
+            }
+            csv_row(csv, "all", "first", all.first_record, all.errors, seconds);
+            csv_row(csv, "all", "full", all.full_stream, all.errors, seconds);
+        }
+        cons.clear();
+        neo4j::client::cleanup();
+    } catch(const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
         return -1;
     }
-    
-    neo4j::client::init();
-    auto con = neo4j::client::connect(argv[1], neo4j::connect_flags::insecure);
-    std::cout << "Username: " << con->get_username() << "\n";
-    std::cout << "Hostname: " << con->get_hostname() << "\n";
-    std::cout << "Port    : " << con->get_port() << "\n";
-    std::cout << "ServerID: " << con->get_server_id() << "\n";
-    std::cout << "Secure  : " << (con->is_secure()?"true":"false") << "\n";
-    std::cout << "CredExp : " << (con->is_credentials_expired()?"true":"false") << "\n";
-    std::cout.flush();
-
-    auto stream = con->run("MATCH path=shortestPath((:Person{name:\"James Thompson\"})-[:FOLLOWS*]-(:Person{name:\"Angela Scope\"})) RETURN path;");
-    if(stream->check_failure()) {
-        std::cerr << "Failed to execute statement:\n";
-        std::cerr << stream->failure_details().message << "\n";
-        std::cerr.flush();
-    }
-    auto res = stream->fetch_next();
-    while(res) {
-        std::cout << res.field(0).dump() << std::endl;
-        
-        res = stream->fetch_next();
-    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,123 @@
+#include "workload.h"
+#include <fstream>
+#include <sstream>
+#include <neo4j-cpp/exception.h>
+
+static std::string trim(const std::string& str)
+{
+    auto b = str.find_first_not_of(" \t\r\n");
+    if(b == std::string::npos) return "";
+    auto e = str.find_last_not_of(" \t\r\n");
+    return str.substr(b, e - b + 1);
+}
+
+static workload_param parse_param(const std::string& spec, size_t line)
+{
+    auto eq = spec.find('=');
+    if(eq == std::string::npos) throw neo4j::exception("line " + std::to_string(line) + ": expected name=value");
+    workload_param p;
+    p.name = trim(spec.substr(0, eq));
+    auto val = trim(spec.substr(eq + 1));
+    auto range = val.find("..");
+    try {
+        if(range != std::string::npos) {
+            p.type = workload_param::kind::int_range;
+            p.lo = std::stoll(val.substr(0, range));
+            p.hi = std::stoll(val.substr(range + 2));
+            if(p.hi < p.lo) throw neo4j::exception("empty range");
+        } else if(val.size() >= 2 && val.front() == '"' && val.back() == '"') {
+            p.constant = neo4j::value(val.substr(1, val.size() - 2));
+        } else if(val == "true" || val == "false") {
+            p.constant = neo4j::value(val == "true");
+        } else if(val.find_first_of(".eE") != std::string::npos) {
+            p.constant = neo4j::value(std::stod(val));
+        } else {
+            p.constant = neo4j::value(std::stoll(val));
+        }
+    } catch(const std::exception& e) {
+        throw neo4j::exception("line " + std::to_string(line) + ": invalid value for " + p.name + ": " + e.what());
+    }
+    return p;
+}
+
+static void parse_params(const std::string& specs, size_t line, std::vector<workload_param>& params)
+{
+    std::stringstream in(specs);
+    std::string spec;
+    while(std::getline(in, spec, ',')) {
+        if(!trim(spec).empty()) params.push_back(parse_param(spec, line));
+    }
+}
+
+neo4j::value workload_statement::make_params(std::mt19937_64& rng) const
+{
+    if(params.empty()) return neo4j::value();
+    neo4j::map_builder builder;
+    for(auto& p : params) {
+        if(p.type == workload_param::kind::int_range) {
+            std::uniform_int_distribution<long long> dist(p.lo, p.hi);
+            builder.set(p.name, neo4j::value(dist(rng)));
+        } else {
+            builder.set(p.name, p.constant);
+        }
+    }
+    return builder.build();
+}
+
+workload workload::parse(std::istream& in)
+{
+    workload res;
+    std::string line;
+    size_t lineno = 0;
+    unsigned int total = 0;
+    while(std::getline(in, line)) {
+        lineno++;
+        line = trim(line);
+        if(line.empty() || line[0] == '#') continue;
+        auto first = line.find('|');
+        if(first == std::string::npos) throw neo4j::exception("line " + std::to_string(lineno) + ": expected weight | query");
+        auto second = line.rfind("//");
+        if(second != std::string::npos && second < first) second = std::string::npos;
+        workload_statement stmt;
+        try {
+            stmt.weight = std::stoul(trim(line.substr(0, first)));
+        } catch(const std::exception&) {
+            throw neo4j::exception("line " + std::to_string(lineno) + ": invalid weight");
+        }
+        stmt.query = trim(line.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1));
+        if(second != std::string::npos) parse_params(line.substr(second + 2), lineno, stmt.params);
+        if(stmt.weight == 0) continue;
+        total += stmt.weight;
+        res.cumulative.push_back(total);
+        res.stmts.push_back(std::move(stmt));
+    }
+    if(res.stmts.empty()) throw neo4j::exception("workload has no statements");
+    return res;
+}
+
+workload workload::load(const std::string& file)
+{
+    std::ifstream in(file);
+    if(!in) throw neo4j::exception("failed to open " + file);
+    return parse(in);
+}
+
+workload workload::single(const std::string& query, const std::string& params)
+{
+    // Taken as is, a // in the query is not a parameter separator here
+    workload res;
+    workload_statement stmt;
+    stmt.query = trim(query);
+    if(stmt.query.empty()) throw neo4j::exception("empty query");
+    parse_params(params, 1, stmt.params);
+    res.cumulative.push_back(stmt.weight);
+    res.stmts.push_back(std::move(stmt));
+    return res;
+}
+
+size_t workload::pick(std::mt19937_64& rng) const
+{
+    std::uniform_int_distribution<unsigned int> dist(1, cumulative.back());
+    auto r = dist(rng);
+    return std::lower_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+}
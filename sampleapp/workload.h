@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <random>
+#include <neo4j-cpp/value.h>
+
+// A workload file has one statement per line:
+//
+//   weight | query // name=spec, name=spec, ...
+//
+// The parameters follow the last "//", which Cypher reads as a comment.
+// Spec is an int range "lo..hi" (uniform), an int, a float, a quoted string
+// or true/false. Empty lines and lines starting with # are ignored.
+struct workload_param {
+    enum class kind { constant, int_range };
+    std::string name;
+    kind type = kind::constant;
+    neo4j::value constant;
+    long long lo = 0;
+    long long hi = 0;
+};
+
+struct workload_statement {
+    std::string query;
+    unsigned int weight = 1;
+    std::vector<workload_param> params;
+
+    neo4j::value make_params(std::mt19937_64& rng) const;
+};
+
+class workload {
+    std::vector<workload_statement> stmts;
+    std::vector<unsigned int> cumulative;
+public:
+    static workload parse(std::istream& in);
+    static workload load(const std::string& file);
+    // Params uses the spec syntax of a workload line: name=spec, name=spec, ...
+    static workload single(const std::string& query, const std::string& params = "");
+
+    const std::vector<workload_statement>& statements() const noexcept { return stmts; }
+    // Weighted random statement index
+    size_t pick(std::mt19937_64& rng) const;
+};
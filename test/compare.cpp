@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/compare.h>
+#include <neo4j-cpp/packstream.h>
+#include <unordered_set>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    neo4j::value node(long long id) {
+        neo4j::packstream_writer w;
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(0);
+        w.write_map_header(0);
+        return neo4j::packstream_reader(w.data().data(), w.data().size()).read_value();
+    }
+
+    neo4j::value str(const std::string& s) { return neo4j::value(s); }
+}
+
+TEST(Compare, Equality) {
+    ASSERT_EQ(neo4j::value(1ll), neo4j::value(1.0));
+    ASSERT_NE(neo4j::value(1ll), neo4j::value(1.5));
+    ASSERT_NE(neo4j::value(true), neo4j::value(1ll));
+    ASSERT_EQ(neo4j::value(), neo4j::value());
+    ASSERT_EQ(neo4j::value(std::nan("")), neo4j::value(std::nan("")));
+    ASSERT_EQ(str("abc"), str("abc"));
+    ASSERT_NE(str("abc"), str("abd"));
+    ASSERT_NE(str("abc"), neo4j::value(std::string("abc"), true));
+    neo4j::value a(std::map<std::string, neo4j::value>{ { "x", neo4j::value(1ll) }, { "y", neo4j::value() } });
+    neo4j::value b(std::map<std::string, neo4j::value>{ { "x", neo4j::value(1.0) }, { "y", neo4j::value() } });
+    neo4j::value c(std::map<std::string, neo4j::value>{ { "x", neo4j::value(1ll) }, { "z", neo4j::value() } });
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, c);
+    ASSERT_EQ(neo4j::value(std::vector<neo4j::value>{ str("a"), neo4j::value(2ll) }),
+        neo4j::value(std::vector<neo4j::value>{ str("a"), neo4j::value(2.0) }));
+    ASSERT_EQ(node(7), node(7));
+    ASSERT_NE(node(7), node(8));
+}
+
+TEST(Compare, Ordering) {
+    std::vector<neo4j::value> values = {
+        neo4j::value(), neo4j::value(2.5), str("b"), neo4j::value(true), neo4j::value(1ll), node(3),
+        neo4j::value(std::vector<neo4j::value>{ neo4j::value(1ll) }), str("a"), neo4j::value(std::nan("")),
+        neo4j::value(std::map<std::string, neo4j::value>{}), neo4j::value(false), neo4j::value(9007199254740993ll)
+    };
+    std::sort(values.begin(), values.end());
+    ASSERT_TRUE(values[0].is_map());
+    ASSERT_TRUE(values[1].is_node());
+    ASSERT_TRUE(values[2].is_list());
+    ASSERT_EQ("a", values[3].to_string());
+    ASSERT_EQ("b", values[4].to_string());
+    ASSERT_FALSE(values[5].to_bool());
+    ASSERT_TRUE(values[6].to_bool());
+    ASSERT_EQ(1, values[7].to_int());
+    ASSERT_EQ(2.5, values[8].to_float());
+    ASSERT_EQ(9007199254740993ll, values[9].to_int());
+    ASSERT_TRUE(std::isnan(values[10].to_float()));
+    ASSERT_TRUE(values[11].is_null());
+    ASSERT_LT(neo4j::compare(neo4j::value(9007199254740992.0), neo4j::value(9007199254740993ll)), 0);
+}
+
+TEST(Compare, Hash) {
+    ASSERT_EQ(neo4j::hash_value(neo4j::value(3ll)), neo4j::hash_value(neo4j::value(3.0)));
+    ASSERT_EQ(neo4j::hash_value(node(5)), neo4j::hash_value(node(5)));
+    neo4j::value a(std::map<std::string, neo4j::value>{ { "x", neo4j::value(1ll) }, { "y", str("v") } });
+    neo4j::value b(std::map<std::string, neo4j::value>{ { "y", str("v") }, { "x", neo4j::value(1.0) } });
+    ASSERT_EQ(neo4j::hash_value(a), neo4j::hash_value(b));
+    std::string long_str(100, 'q');
+    std::string other = long_str;
+    other[57] = 'r';
+    ASSERT_NE(neo4j::hash_value(str(long_str)), neo4j::hash_value(str(other)));
+
+    std::unordered_set<neo4j::value> seen;
+    for(long long i = 0; i < 100; i++) seen.insert(neo4j::value(i % 10));
+    for(long long i = 0; i < 10; i++) seen.insert(neo4j::value(static_cast<double>(i)));
+    seen.insert(node(1));
+    seen.insert(node(1));
+    ASSERT_EQ(11u, seen.size());
+}
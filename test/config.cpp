@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <neo4j-cpp/config.h>
+#include <neo4j-cpp/pool.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std::string_literals;
 
@@ -8,4 +11,24 @@ TEST(Config, CreateCopy) {
     neo4j::config cfg;
     auto cfg2 = cfg;
     neo4j::config cfg3(cfg);
-}
\ No newline at end of file
+}
+TEST(Config, Freeze) {
+    neo4j::config cfg;
+    cfg.set_username("alice");
+    cfg.set_rcvbuf_size(8192);
+    auto shared = cfg.freeze();
+    cfg.set_username("bob");
+    ASSERT_EQ("alice", shared->get_username());
+    ASSERT_EQ(8192u, shared->get_rcvbuf_size());
+
+    // Pools reference the frozen config instead of copying it
+    neo4j::connection_pool pool("neo4j://localhost:7687", shared);
+    ASSERT_EQ(shared, pool.get_config());
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            for(int j = 0; j < 1000; j++) ASSERT_EQ(8192u, pool.get_config()->get_rcvbuf_size());
+        });
+    }
+    for(auto& t : readers) t.join();
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/cursor.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/stub_server.h>
+#include <neo4j-cpp/packstream.h>
+#include <neo4j-cpp/path.h>
+
+namespace {
+    neo4j::stub_server::response rows(long long n) {
+        neo4j::stub_server::response res;
+        res.fields = { "i", "name" };
+        for(long long i = 0; i < n; i++) res.records.push_back({ neo4j::value(i), neo4j::value("row " + std::to_string(i)) });
+        return res;
+    }
+}
+
+TEST(Cursor, Stream) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) { return rows(1000); });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    neo4j::result_cursor cursor(con->run("UNWIND range(0, 999) AS i RETURN i, 'row ' + i AS name"), 16);
+    ASSERT_EQ(2u, cursor.nfields());
+    ASSERT_FALSE(cursor.valid());
+    std::vector<neo4j::value> kept;
+    long long expected = 0;
+    while(cursor.next()) {
+        ASSERT_EQ(expected, cursor.field(0).to_int());
+        if(expected % 100 == 0) kept.push_back(cursor.copy_field(1));
+        expected++;
+    }
+    ASSERT_EQ(1000, expected);
+    ASSERT_EQ(1000u, cursor.position());
+    ASSERT_FALSE(cursor.valid());
+    ASSERT_EQ(10u, kept.size());
+    // Copies do not depend on the recycled rows
+    ASSERT_EQ("row 900", kept.back().to_string());
+}
+
+TEST(Cursor, CopyRow) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) { return rows(3); });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    neo4j::result_cursor cursor(con->run("RETURN 1"), 1);
+    ASSERT_THROW(cursor.field(0), neo4j::exception);
+    ASSERT_TRUE(cursor.next());
+    auto row = cursor.copy_row();
+    ASSERT_EQ(2u, row.size());
+    ASSERT_EQ("row 0", row[1].to_string());
+    ASSERT_THROW(cursor.field(2), neo4j::exception);
+}
+
+TEST(Cursor, CopyPath) {
+    // (1)-[10:KNOWS]->(2)
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x50);
+    w.write_list_header(2);
+    for(long long id : { 1, 2 }) {
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(0);
+        w.write_map_header(0);
+    }
+    w.write_list_header(1);
+    w.write_struct_header(3, 0x72);
+    w.write_int(10);
+    w.write_string("KNOWS");
+    w.write_map_header(0);
+    w.write_list_header(2);
+    w.write_int(1);
+    w.write_int(1);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto path = r.read_value();
+    neo4j::stub_server server([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "p" };
+        for(int i = 0; i < 3; i++) res.records.push_back({ path });
+        return res;
+    });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    neo4j::value copy;
+    {
+        neo4j::result_cursor cursor(con->run("MATCH p = ()-->() RETURN p"), 1);
+        ASSERT_TRUE(cursor.next());
+        copy = cursor.copy_field(0);
+        while(cursor.next()) {}
+    }
+    // The copy does not pin the row, which is gone with the stream
+    neo4j::path_view view(copy.ref());
+    ASSERT_EQ(1u, view.length());
+    ASSERT_EQ(2, view.end_node().node_id());
+    bool forward;
+    ASSERT_EQ(10, view.relationship(0, forward).relationship_id());
+    ASSERT_TRUE(forward);
+}
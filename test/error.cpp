@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/error.h>
+#include <string>
+
+using namespace std::string_literals;
+
+TEST(Error, Default) {
+    neo4j::error e;
+    ASSERT_FALSE(e);
+    ASSERT_FALSE(e.has_failure_details());
+}
+
+TEST(Error, FailureDetails) {
+    neo4j::failure_details details{};
+    details.code = "Neo.ClientError.Statement.SyntaxError";
+    details.message = "Invalid input";
+    neo4j::error e(neo4j::make_client_error(-1), details);
+    ASSERT_TRUE(e);
+    ASSERT_EQ(&neo4j::client_category(), &e.code().category());
+    ASSERT_EQ("Invalid input"s, e.message());
+    ASSERT_EQ(details.code, e.failure_details().code);
+}
+
+TEST(Error, Expected) {
+    neo4j::expected<long long> ok(42);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(42, ok.value());
+
+    neo4j::expected<long long> failed(std::make_error_code(std::errc::invalid_argument));
+    ASSERT_FALSE(failed);
+    ASSERT_EQ(std::errc::invalid_argument, failed.get_error().code());
+    ASSERT_EQ(7, failed.value_or(7));
+    ASSERT_THROW(failed.value(), neo4j::exception);
+}
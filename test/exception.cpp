@@ -7,4 +7,14 @@ using namespace std::string_literals;
 TEST(Exception, Create) {
     neo4j::exception e("Hello");
     ASSERT_EQ(e.what(), "Hello"s);
-}
\ No newline at end of file
+}
+TEST(Exception, Timeout) {
+    neo4j::timeout_error e("Deadline");
+    const neo4j::exception& base = e;
+    ASSERT_EQ(base.what(), "Deadline"s);
+}
+TEST(Exception, MemoryLimit) {
+    neo4j::memory_limit_error e("Limit");
+    const neo4j::exception& base = e;
+    ASSERT_EQ(base.what(), "Limit"s);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/executor.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/stub_server.h>
+#include <future>
+#include <thread>
+
+namespace {
+    struct numbered_task : neo4j::executor_task {
+        int producer;
+        int seq;
+    };
+}
+
+TEST(ExecutorQueue, MultiProducer) {
+    neo4j::executor_queue queue;
+    const int producers = 4, per_producer = 10000;
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for(int i = 0; i < per_producer; i++) {
+                auto t = new numbered_task();
+                t->producer = p;
+                t->seq = i;
+                queue.push(t);
+            }
+        });
+    }
+    std::vector<int> last(producers, -1);
+    int received = 0;
+    while(received < producers * per_producer) {
+        auto t = static_cast<numbered_task*>(queue.try_pop());
+        if(t == nullptr) continue;
+        // Each producer's tasks arrive in order
+        ASSERT_EQ(last[t->producer] + 1, t->seq);
+        last[t->producer] = t->seq;
+        received++;
+        delete t;
+    }
+    for(auto& t : threads) t.join();
+    ASSERT_EQ(nullptr, queue.try_pop());
+    ASSERT_EQ(0u, queue.size());
+}
+
+TEST(Executor, Submit) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ params.map_entry("n") });
+        return res;
+    });
+    neo4j::executor_options opts;
+    opts.workers = 3;
+    {
+        neo4j::sharded_executor executor(server.uri(), opts);
+        ASSERT_EQ(3u, executor.nworkers());
+        std::vector<std::future<long long>> results;
+        for(long long i = 0; i < 30; i++) {
+            results.push_back(executor.submit([i](neo4j::connection& con) {
+                auto stream = con.run("RETURN $n AS n", neo4j::value(std::map<std::string, neo4j::value>{ { "n", neo4j::value(i) } }));
+                return stream->fetch_next().field_ref(0).to_int();
+            }));
+        }
+        for(long long i = 0; i < 30; i++) ASSERT_EQ(i, results[i].get());
+        auto failed = executor.submit(0, [](neo4j::connection&) { throw neo4j::exception("task failed"); });
+        ASSERT_THROW(failed.get(), neo4j::exception);
+        unsigned long long executed = 0;
+        for(auto& s : executor.stats()) executed += s.executed;
+        ASSERT_EQ(31u, executed);
+    }
+    ASSERT_EQ(3u, server.connections());
+}
+
+TEST(Executor, StealBehindRunning) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        return neo4j::stub_server::response();
+    });
+    neo4j::executor_options opts;
+    opts.workers = 2;
+    neo4j::sharded_executor executor(server.uri(), opts);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    auto slow = executor.submit(0, [released](neo4j::connection&) { released.wait(); });
+    // A single task queued behind a long running one goes to the idle worker
+    auto quick = executor.submit(0, [](neo4j::connection&) { return 1; });
+    ASSERT_EQ(std::future_status::ready, quick.wait_for(std::chrono::seconds(5)));
+    ASSERT_EQ(1, quick.get());
+    release.set_value();
+    slow.get();
+    auto st = executor.stats();
+    ASSERT_EQ(1u, st[1].stolen);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/fanout.h>
+#include <neo4j-cpp/pool.h>
+#include <neo4j-cpp/stub_server.h>
+#include <neo4j-cpp/exception.h>
+
+namespace {
+    // Shard i returns the keys i, i + step, i + 2 * step, ... below limit
+    neo4j::stub_server::response range_rows(const neo4j::value& params) {
+        neo4j::stub_server::response res;
+        res.fields = { "k" };
+        auto start = params.map_entry("start").to_int();
+        auto step = params.map_entry("step").to_int();
+        for(long long k = start; k < 100; k += step) res.records.push_back({ neo4j::value(k) });
+        return res;
+    }
+
+    std::vector<neo4j::value> partitions(long long n) {
+        std::vector<neo4j::value> res;
+        for(long long i = 0; i < n; i++)
+            res.emplace_back(std::map<std::string, neo4j::value>{ { "start", neo4j::value(i) }, { "step", neo4j::value(n) } });
+        return res;
+    }
+}
+
+TEST(Fanout, Unordered) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) { return range_rows(params); });
+    auto pool = std::make_shared<neo4j::connection_pool>(server.uri(), neo4j::connect_flags::none, 3);
+    neo4j::fanout_executor executor(pool);
+    auto stream = executor.run("MATCH (n) RETURN n.k AS k", partitions(4));
+    std::vector<bool> seen(100);
+    size_t count = 0;
+    while(auto rec = stream->fetch_next()) {
+        auto k = rec.fields.at(0).to_int();
+        ASSERT_EQ(static_cast<size_t>(k % 4), rec.shard);
+        seen.at(k) = true;
+        count++;
+    }
+    ASSERT_EQ(100, count);
+    ASSERT_EQ(std::vector<bool>(100, true), seen);
+    ASSERT_EQ(std::vector<std::string>{ "k" }, stream->fieldnames());
+    for(auto& p : stream->progress()) {
+        ASSERT_EQ(neo4j::shard_state::done, p.state);
+        ASSERT_EQ(25, p.rows_consumed);
+    }
+    ASSERT_EQ(4, server.statements());
+}
+
+TEST(Fanout, OrderedMerge) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) { return range_rows(params); });
+    auto pool = std::make_shared<neo4j::connection_pool>(server.uri());
+    neo4j::fanout_options opts;
+    opts.order = neo4j::merge_order::ordered;
+    opts.shard_buffer = 2;
+    auto stream = neo4j::fanout_executor(pool, opts).run("MATCH (n) RETURN n.k AS k ORDER BY k", partitions(3));
+    long long expected = 0;
+    while(auto rec = stream->fetch_next()) {
+        ASSERT_EQ(expected++, rec.fields.at(0).to_int());
+    }
+    ASSERT_EQ(100, expected);
+}
+
+TEST(Fanout, ShardFailure) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) {
+        auto res = range_rows(params);
+        if(params.map_entry("start").to_int() == 1) {
+            res.failure_code = "Neo.ClientError.Statement.SyntaxError";
+            res.failure_message = "broken";
+        }
+        return res;
+    });
+    auto pool = std::make_shared<neo4j::connection_pool>(server.uri());
+    auto stream = neo4j::fanout_executor(pool).run("RETURN 1", partitions(2));
+    ASSERT_THROW({ while(stream->fetch_next()) {} }, neo4j::exception);
+}
+
+TEST(Fanout, Stragglers) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) {
+        auto res = range_rows(params);
+        if(params.map_entry("start").to_int() == 0) res.delay = std::chrono::milliseconds(300);
+        return res;
+    });
+    auto pool = std::make_shared<neo4j::connection_pool>(server.uri());
+    auto stream = neo4j::fanout_executor(pool).run("RETURN 1", partitions(4));
+    // The fast shards finish while shard 0 still waits
+    for(int i = 0; i < 75; i++) ASSERT_TRUE(stream->fetch_next());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(std::vector<size_t>{ 0 }, stream->stragglers(2.0));
+    stream->cancel();
+    ASSERT_FALSE(stream->fetch_next());
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/graph.h>
+#include <neo4j-cpp/value.h>
+#include <neo4j-cpp/value_ref.h>
+#include <neo4j-cpp/packstream.h>
+
+TEST(Graph, Csr) {
+    neo4j::graph_builder builder;
+    ASSERT_TRUE(builder.add_relationship(100, 1, 2, "KNOWS"));
+    ASSERT_TRUE(builder.add_relationship(101, 2, 3, "LIKES"));
+    ASSERT_TRUE(builder.add_relationship(102, 1, 3, "KNOWS"));
+    ASSERT_FALSE(builder.add_relationship(100, 1, 2, "KNOWS"));
+    builder.add_node(4);
+    builder.add_node(1);
+    ASSERT_EQ(4, builder.node_count());
+    ASSERT_EQ(3, builder.relationship_count());
+
+    auto g = builder.build();
+    ASSERT_EQ(0, builder.node_count());
+    ASSERT_EQ(4, g.node_count());
+    ASSERT_EQ(3, g.relationship_count());
+    ASSERT_EQ((std::vector<std::string>{ "KNOWS", "LIKES" }), g.type_names);
+    ASSERT_EQ(1u, g.find_type("LIKES"));
+    ASSERT_EQ(2u, g.find_type("HATES"));
+
+    uint32_t n1, n2, n3, n4;
+    ASSERT_TRUE(g.find_node(1, n1));
+    ASSERT_TRUE(g.find_node(2, n2));
+    ASSERT_TRUE(g.find_node(3, n3));
+    ASSERT_TRUE(g.find_node(4, n4));
+    ASSERT_FALSE(g.find_node(5, n4));
+    ASSERT_EQ(2u, g.out_degree(n1));
+    ASSERT_EQ(1u, g.out_degree(n2));
+    ASSERT_EQ(0u, g.out_degree(n3));
+    ASSERT_EQ(n2, g.targets[g.offsets[n1]]);
+    ASSERT_EQ(n3, g.targets[g.offsets[n1] + 1]);
+    ASSERT_EQ(102, g.relationship_ids[g.offsets[n1] + 1]);
+    ASSERT_EQ(1u, g.types[g.offsets[n2]]);
+    ASSERT_TRUE(g.in_offsets.empty());
+}
+
+TEST(Graph, Incoming) {
+    neo4j::graph_builder_options opts;
+    opts.incoming = true;
+    neo4j::graph_builder builder(opts);
+    builder.add_relationship(1, 10, 30, "R");
+    builder.add_relationship(2, 20, 30, "R");
+    auto g = builder.build();
+    uint32_t n30;
+    ASSERT_TRUE(g.find_node(30, n30));
+    ASSERT_EQ(2u, g.in_offsets[n30 + 1] - g.in_offsets[n30]);
+    for(auto i = g.in_offsets[n30]; i < g.in_offsets[n30 + 1]; i++) ASSERT_EQ(n30, g.targets[g.in_edges[i]]);
+}
+
+TEST(Graph, FromValues) {
+    // Node and relationship values as a server would send them
+    neo4j::packstream_writer w;
+    w.write_list_header(3);
+    for(long long id : { 1, 2 }) {
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(1);
+        w.write_string("Person");
+        w.write_map_header(1);
+        w.write_string("age");
+        w.write_int(40 + id);
+    }
+    w.write_struct_header(5, 0x52);
+    w.write_int(7);
+    w.write_int(2);
+    w.write_int(1);
+    w.write_string("KNOWS");
+    w.write_map_header(1);
+    w.write_string("since");
+    w.write_int(2001);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto rows = r.read_value();
+
+    neo4j::graph_builder_options opts;
+    opts.node_properties = { "age", "missing" };
+    opts.relationship_properties = { "since" };
+    neo4j::graph_builder builder(opts);
+    builder.add(rows.ref());
+    builder.add(rows.ref());
+    auto g = builder.build();
+    ASSERT_EQ(2, g.node_count());
+    ASSERT_EQ(1, g.relationship_count());
+    uint32_t n1, n2;
+    ASSERT_TRUE(g.find_node(1, n1));
+    ASSERT_TRUE(g.find_node(2, n2));
+    ASSERT_EQ(n1, g.targets[g.offsets[n2]]);
+    ASSERT_EQ(42, g.node_properties["age"][n2].to_int());
+    ASSERT_TRUE(g.node_properties["missing"][n1].is_null());
+    ASSERT_EQ(2001, g.relationship_properties["since"][0].to_int());
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/intern.h>
+#include <neo4j-cpp/packstream.h>
+#include <algorithm>
+
+namespace {
+    neo4j::value node(long long id, std::vector<std::string> labels, const std::string& name) {
+        neo4j::packstream_writer w;
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(labels.size());
+        for(auto& l : labels) w.write_string(l);
+        w.write_map_header(2);
+        w.write_string("name");
+        w.write_string(name);
+        w.write_string("id");
+        w.write_int(id);
+        return neo4j::packstream_reader(w.data().data(), w.data().size()).read_value();
+    }
+}
+
+TEST(Intern, Table) {
+    neo4j::intern_table table;
+    auto a = table.intern("Person");
+    auto b = table.intern(std::string("Movie"));
+    ASSERT_NE(a, b);
+    ASSERT_EQ(a, table.intern(std::string("Person")));
+    ASSERT_EQ(2u, table.size());
+    ASSERT_EQ("Movie", table.name(b).str());
+    neo4j::symbol found;
+    ASSERT_TRUE(table.find("Person", found));
+    ASSERT_EQ(a, found);
+    ASSERT_FALSE(table.find("Actor", found));
+    ASSERT_THROW(table.name(5), neo4j::exception);
+}
+
+TEST(Intern, LabelSet) {
+    neo4j::label_set set;
+    ASSERT_TRUE(set.empty());
+    set.insert(3);
+    set.insert(63);
+    set.insert(200);
+    ASSERT_EQ(3u, set.size());
+    ASSERT_TRUE(set.contains(200));
+    ASSERT_FALSE(set.contains(64));
+    neo4j::label_set sub;
+    sub.insert(63);
+    ASSERT_TRUE(set.contains_all(sub));
+    ASSERT_FALSE(sub.contains_all(set));
+    std::vector<neo4j::symbol> all;
+    set.for_each([&](neo4j::symbol s) { all.push_back(s); });
+    ASSERT_EQ((std::vector<neo4j::symbol>{ 3, 63, 200 }), all);
+}
+
+TEST(Intern, Accessors) {
+    neo4j::intern_table table;
+    auto a = node(1, { "Person", "Actor" }, "Keanu");
+    auto b = node(2, { "Person" }, "Carrie");
+    auto la = table.labels(a.ref());
+    auto lb = table.labels(b.ref());
+    ASSERT_EQ(2u, la.size());
+    ASSERT_TRUE(la.contains_all(lb));
+    neo4j::symbol person;
+    ASSERT_TRUE(table.find("Person", person));
+    ASSERT_TRUE(lb.contains(person));
+    auto props = table.properties(a.ref());
+    ASSERT_EQ(2u, props.size());
+    neo4j::symbol name;
+    ASSERT_TRUE(table.find("name", name));
+    auto it = std::find_if(props.begin(), props.end(), [&](const neo4j::property_ref& p) { return p.key == name; });
+    ASSERT_NE(props.end(), it);
+    ASSERT_EQ("Keanu", it->value.to_string());
+    auto size = table.size();
+    table.properties(b.ref());
+    ASSERT_EQ(size, table.size());
+}
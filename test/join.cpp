@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/join.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/stub_server.h>
+
+TEST(Join, InnerAndLeft) {
+    neo4j::stub_server server([](const std::string& query, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        if(query.find("Person") != std::string::npos) {
+            res.fields = { "id", "name" };
+            res.records = { { neo4j::value(1ll), neo4j::value(std::string("a")) }, { neo4j::value(2ll), neo4j::value(std::string("b")) } };
+        } else {
+            res.fields = { "owner", "item" };
+            res.records = { { neo4j::value(1ll), neo4j::value(std::string("x")) }, { neo4j::value(1.0), neo4j::value(std::string("y")) },
+                { neo4j::value(3ll), neo4j::value(std::string("z")) }, { neo4j::value(), neo4j::value(std::string("n")) } };
+        }
+        return res;
+    });
+    for(auto type : { neo4j::join_type::inner, neo4j::join_type::left }) {
+        auto con = std::make_shared<neo4j::connection>(server.uri());
+        neo4j::hash_join join(con->run("MATCH (p:Person) RETURN p.id AS id, p.name AS name"), 0,
+            con->run("MATCH (i:Item) RETURN i.owner AS owner, i.item AS item"), 0, type);
+        ASSERT_EQ(2u, join.build_rows());
+        std::vector<std::string> rows;
+        while(auto rec = join.fetch_next()) {
+            rows.push_back(rec.probe[1].to_string() + (rec.build.empty() ? "-" : rec.build[1].to_string()));
+        }
+        if(type == neo4j::join_type::inner) ASSERT_EQ((std::vector<std::string>{ "xa", "ya" }), rows);
+        else ASSERT_EQ((std::vector<std::string>{ "xa", "ya", "z-", "n-" }), rows);
+    }
+}
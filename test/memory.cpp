@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/memory.h>
+#include <neo4j-cpp/config.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/exception.h>
+#include <neo4j-cpp/stub_server.h>
+#include <neo4j-client.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    struct counting_allocator {
+        struct neo4j_memory_allocator base;
+        int live;
+    };
+
+    counting_allocator make_inner() {
+        counting_allocator res;
+        res.base.alloc = [](struct neo4j_memory_allocator* a, void*, size_t size) -> void* {
+            reinterpret_cast<counting_allocator*>(a)->live++;
+            return malloc(size);
+        };
+        res.base.calloc = [](struct neo4j_memory_allocator* a, void*, size_t count, size_t size) -> void* {
+            reinterpret_cast<counting_allocator*>(a)->live++;
+            return calloc(count, size);
+        };
+        res.base.free = [](struct neo4j_memory_allocator* a, void* ptr) {
+            reinterpret_cast<counting_allocator*>(a)->live--;
+            free(ptr);
+        };
+        res.base.vfree = nullptr;
+        res.live = 0;
+        return res;
+    }
+}
+
+TEST(Memory, Account) {
+    auto inner = make_inner();
+    neo4j::memory_account account(neo4j::memory_limits{}, &inner.base);
+    auto alloc = account.allocator();
+    void* a = alloc->alloc(alloc, nullptr, 100);
+    void* b = alloc->calloc(alloc, nullptr, 10, 5);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % 16, 0u);
+    ASSERT_EQ(static_cast<char*>(b)[49], 0);
+    auto usage = account.usage();
+    ASSERT_EQ(usage.live, 150u);
+    ASSERT_EQ(usage.allocations, 2u);
+    ASSERT_EQ(inner.live, 2);
+    alloc->free(alloc, a);
+    void* ptrs[] = { b };
+    alloc->vfree(alloc, ptrs, 1);
+    usage = account.usage();
+    ASSERT_EQ(usage.live, 0u);
+    ASSERT_EQ(usage.peak, 150u);
+    ASSERT_EQ(usage.allocated_bytes, 150u);
+    ASSERT_EQ(inner.live, 0);
+}
+
+TEST(Memory, StreamCounter) {
+    auto inner = make_inner();
+    neo4j::memory_account account(neo4j::memory_limits{}, &inner.base);
+    auto alloc = account.allocator();
+    auto counter = new neo4j::memory_counter();
+    void* a;
+    {
+        neo4j::memory_account::scope guard(counter);
+        a = alloc->alloc(alloc, nullptr, 64);
+    }
+    void* b = alloc->alloc(alloc, nullptr, 32);
+    ASSERT_EQ(counter->usage().live, 64u);
+    ASSERT_EQ(account.usage().live, 96u);
+    // The allocation keeps the counter alive past the stream
+    counter->release();
+    alloc->free(alloc, a);
+    alloc->free(alloc, b);
+    ASSERT_EQ(account.usage().live, 0u);
+}
+
+TEST(Memory, Limits) {
+    auto inner = make_inner();
+    neo4j::memory_limits limits;
+    limits.stream_soft = 50;
+    limits.stream_hard = 100;
+    neo4j::memory_account account(limits, &inner.base);
+    auto alloc = account.allocator();
+    neo4j::memory_counter counter;
+    neo4j::memory_account::scope guard(&counter);
+    void* a = alloc->alloc(alloc, nullptr, 60);
+    ASSERT_NE(a, nullptr);
+    ASSERT_TRUE(account.over_soft_limit(&counter));
+    ASSERT_FALSE(account.over_soft_limit());
+    ASSERT_FALSE(counter.limit_exceeded());
+    ASSERT_EQ(alloc->alloc(alloc, nullptr, 60), nullptr);
+    ASSERT_TRUE(counter.limit_exceeded());
+    ASSERT_EQ(counter.usage().live, 60u);
+    alloc->free(alloc, a);
+    ASSERT_FALSE(account.over_soft_limit(&counter));
+}
+
+TEST(Memory, Config) {
+    neo4j::config cfg;
+    ASSERT_FALSE(cfg.get_memory_accounting());
+    neo4j::memory_limits limits;
+    limits.connection_hard = 1024;
+    cfg.set_memory_limits(limits);
+    neo4j::config copy(cfg);
+    ASSERT_TRUE(copy.get_memory_accounting());
+    ASSERT_EQ(copy.get_memory_limits().connection_hard, 1024u);
+}
+
+TEST(Memory, HardLimitStream) {
+    neo4j::stub_server server([](const std::string& query, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "v" };
+        if(query == "BIG") res.records.push_back({ neo4j::value(std::string(256 * 1024, 'x')) });
+        else res.records.push_back({ neo4j::value(1ll) });
+        return res;
+    });
+    neo4j::config cfg;
+    neo4j::memory_limits limits;
+    limits.stream_hard = 16 * 1024;
+    cfg.set_memory_limits(limits);
+    auto con = std::make_shared<neo4j::connection>(server.uri(), cfg, neo4j::connect_flags::insecure);
+    {
+        auto stream = con->run("BIG");
+        ASSERT_THROW(stream->fetch_next(), neo4j::memory_limit_error);
+        ASSERT_TRUE(stream->is_memory_exceeded());
+        ASSERT_THROW(stream->fetch_next(), neo4j::memory_limit_error);
+    }
+    // libneo4j may fail the session after a refused allocation, but the
+    // connection must answer, either with the record or an error
+    try {
+        auto stream = con->run("SMALL");
+        auto row = stream->fetch_next();
+        ASSERT_TRUE(row);
+        ASSERT_EQ(1, row.field(0).to_int());
+    } catch(const neo4j::memory_limit_error&) {
+        FAIL() << "limit of the aborted stream applied to the next one";
+    } catch(const neo4j::exception&) {
+        auto fresh = std::make_shared<neo4j::connection>(server.uri(), cfg, neo4j::connect_flags::insecure);
+        auto row = fresh->run("SMALL")->fetch_next();
+        ASSERT_TRUE(row);
+    }
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/packstream.h>
+#include <neo4j-cpp/value.h>
+#include <neo4j-cpp/value_ref.h>
+#include <neo4j-cpp/exception.h>
+
+TEST(Packstream, Scalars) {
+    neo4j::packstream_writer w;
+    w.write_null();
+    w.write_bool(true);
+    w.write_int(-16);
+    w.write_int(-17);
+    w.write_int(1000);
+    w.write_int(1ll << 40);
+    w.write_float(1.5);
+    w.write_string("hello");
+    w.write_string(std::string(300, 'x'));
+
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    ASSERT_EQ(neo4j::packstream_reader::marker::null, r.peek());
+    r.read_null();
+    ASSERT_TRUE(r.read_bool());
+    ASSERT_EQ(-16, r.read_int());
+    ASSERT_EQ(-17, r.read_int());
+    ASSERT_EQ(1000, r.read_int());
+    ASSERT_EQ(1ll << 40, r.read_int());
+    ASSERT_EQ(1.5, r.read_float());
+    ASSERT_EQ("hello", r.read_string());
+    ASSERT_EQ(std::string(300, 'x'), r.read_string());
+    ASSERT_EQ(0, r.remaining());
+    ASSERT_THROW(r.read_int(), neo4j::exception);
+}
+
+TEST(Packstream, Containers) {
+    neo4j::packstream_writer w;
+    w.write(neo4j::value(std::vector<neo4j::value>{ neo4j::value(1ll), neo4j::value(std::string("a")) }).ref());
+    w.write(neo4j::value(std::map<std::string, neo4j::value>{ { "k", neo4j::value(true) } }).ref());
+    w.write_struct_header(1, 0x71);
+    w.write_int(7);
+
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    ASSERT_EQ(2, r.read_list_header());
+    ASSERT_EQ(1, r.read_int());
+    ASSERT_EQ("a", r.read_string());
+    ASSERT_EQ(neo4j::packstream_reader::marker::map, r.peek());
+    ASSERT_EQ(1, r.read_map_header());
+    ASSERT_EQ("k", r.read_string());
+    ASSERT_TRUE(r.read_bool());
+    uint8_t signature = 0;
+    ASSERT_EQ(1, r.read_struct_header(signature));
+    ASSERT_EQ(0x71, signature);
+    r.skip();
+    ASSERT_EQ(0, r.remaining());
+}
+
+TEST(Packstream, ReadValue) {
+    neo4j::map_builder props;
+    props.set("name", neo4j::value(std::string("x")));
+    props.set("tags", neo4j::value(std::vector<neo4j::value>{ neo4j::value(1.5), neo4j::value() }));
+    auto in = props.build();
+    neo4j::packstream_writer w;
+    w.write(in.ref());
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto out = r.read_value();
+    ASSERT_EQ(0, r.remaining());
+    ASSERT_EQ(in.dump(), out.dump());
+    ASSERT_EQ("x", out.map_entry("name").to_string());
+    ASSERT_TRUE(out.map_entry("tags").list_entry(1).is_null());
+}
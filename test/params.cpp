@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/params.h>
+#include <neo4j-cpp/packstream.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/stub_server.h>
+#include <cstdint>
+#include <set>
+
+TEST(Params, Scalars) {
+    std::string name = "Alice";
+    neo4j::parameters params;
+    params.set("name", name).set("age", 42).set("score", 1.5).set("active", true).set_null("none");
+    params.set("age", 43);
+    ASSERT_EQ(5u, params.size());
+    auto ref = params.ref();
+    ASSERT_TRUE(ref.is_map());
+    ASSERT_EQ("Alice", ref.map_entry("name").to_string());
+    ASSERT_EQ(43, ref.map_entry("age").to_int());
+    ASSERT_EQ(1.5, ref.map_entry("score").to_float());
+    ASSERT_TRUE(ref.map_entry("active").to_bool());
+    ASSERT_TRUE(ref.map_entry("none").is_null());
+    // Strings are referenced, not copied
+    ASSERT_EQ(name.data(), ref.map_entry("name").to_string_ref().data());
+}
+
+TEST(Params, Lists) {
+    std::vector<int64_t> ids = { 1, 2, 3, 4 };
+    std::vector<std::string> names = { "a", "bb" };
+    std::set<std::string> tags = { "x", "y", "z" };
+    std::vector<bool> flags = { true, false };
+    neo4j::parameters params;
+    params.set_list("ids", ids.data(), ids.size()).set_list("names", names).set_list("tags", tags).set_list("flags", flags);
+    auto ref = params.ref();
+    auto list = ref.map_entry("ids");
+    ASSERT_EQ(4u, list.list_size());
+    ASSERT_EQ(3, list.list_entry(2).to_int());
+    ASSERT_EQ("bb", ref.map_entry("names").list_entry(1).to_string());
+    ASSERT_EQ("z", ref.map_entry("tags").list_entry(2).to_string());
+    ASSERT_FALSE(ref.map_entry("flags").list_entry(1).to_bool());
+}
+
+TEST(Params, Encode) {
+    std::vector<long long> ids(1000);
+    for(size_t i = 0; i < ids.size(); i++) ids[i] = static_cast<long long>(i) * 7;
+    neo4j::value nested(std::vector<neo4j::value>{ neo4j::value(std::string("v")) });
+    neo4j::parameters params;
+    params.set_list("ids", ids).set("nested", nested);
+    neo4j::packstream_writer w;
+    w.write(params.ref());
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto decoded = r.read_value();
+    ASSERT_EQ(1000u, decoded.map_entry("ids").list_size());
+    ASSERT_EQ(999 * 7, decoded.map_entry("ids").list_entry(999).to_int());
+    ASSERT_EQ("v", decoded.map_entry("nested").list_entry(0).to_string());
+}
+
+TEST(Params, Send) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value& params) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(static_cast<long long>(params.map_entry("ids").list_size())) });
+        return res;
+    });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    std::vector<int64_t> ids(50000, 1);
+    neo4j::parameters params;
+    params.set_list("ids", ids);
+    auto stream = con->run("UNWIND $ids AS id RETURN count(id) AS n", params);
+    auto row = stream->fetch_next();
+    ASSERT_TRUE(row);
+    ASSERT_EQ(50000, row.field_ref(0).to_int());
+}
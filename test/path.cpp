@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/path.h>
+#include <neo4j-cpp/value.h>
+#include <neo4j-cpp/exception.h>
+#include <neo4j-cpp/graph.h>
+#include <neo4j-cpp/packstream.h>
+#include <tuple>
+#include <vector>
+
+TEST(Path, NotAPath) {
+    neo4j::value v(1ll);
+    ASSERT_THROW(neo4j::path_view(v.ref()), neo4j::exception);
+}
+
+// (1)-[10:KNOWS]->(2)<-[11:LIKES]-(3) as a server would send it
+static neo4j::value make_path()
+{
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x50);
+    w.write_list_header(3);
+    for(long long id : { 1, 2, 3 }) {
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(0);
+        w.write_map_header(0);
+    }
+    w.write_list_header(2);
+    w.write_struct_header(3, 0x72);
+    w.write_int(10);
+    w.write_string("KNOWS");
+    w.write_map_header(0);
+    w.write_struct_header(3, 0x72);
+    w.write_int(11);
+    w.write_string("LIKES");
+    w.write_map_header(0);
+    w.write_list_header(4);
+    for(long long i : { 1, 1, -2, 2 }) w.write_int(i);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    return r.read_value();
+}
+
+TEST(Path, Steps) {
+    auto v = make_path();
+    ASSERT_TRUE(v.is_path());
+    neo4j::path_view path(v.ref());
+    ASSERT_EQ(2u, path.length());
+    ASSERT_EQ(1, path.start_node().node_id());
+    ASSERT_EQ(3, path.end_node().node_id());
+
+    std::vector<std::tuple<long long, long long, bool>> steps;
+    for(auto step : path) steps.emplace_back(step.node.node_id(), step.relationship.relationship_id(), step.forward);
+    ASSERT_EQ((std::vector<std::tuple<long long, long long, bool>>{ std::make_tuple(1, 10, true), std::make_tuple(2, 11, false) }), steps);
+
+    // Relationships are bound to the nodes of the path again
+    bool forward;
+    auto rel = path.relationship(1, forward);
+    ASSERT_EQ(3, rel.relationship_start_node_id());
+    ASSERT_EQ(2, rel.relationship_end_node_id());
+    ASSERT_EQ(neo4j::string_ref("LIKES"), rel.relationship_type_ref());
+    ASSERT_THROW(path.node(3), neo4j::exception);
+}
+
+TEST(Path, Graph) {
+    auto v = make_path();
+    neo4j::graph_builder builder;
+    builder.add(v.ref());
+    auto g = builder.build();
+    ASSERT_EQ(3, g.node_count());
+    ASSERT_EQ(2, g.relationship_count());
+    uint32_t n1, n2, n3;
+    ASSERT_TRUE(g.find_node(1, n1));
+    ASSERT_TRUE(g.find_node(2, n2));
+    ASSERT_TRUE(g.find_node(3, n3));
+    ASSERT_EQ(1u, g.out_degree(n1));
+    ASSERT_EQ(0u, g.out_degree(n2));
+    ASSERT_EQ(1u, g.out_degree(n3));
+    ASSERT_EQ(n2, g.targets[g.offsets[n1]]);
+    ASSERT_EQ(n2, g.targets[g.offsets[n3]]);
+    ASSERT_EQ(11, g.relationship_ids[g.offsets[n3]]);
+    ASSERT_EQ(1u, g.types[g.offsets[n3]]);
+}
+
+TEST(Path, Malformed) {
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x50);
+    w.write_list_header(1);
+    w.write_struct_header(3, 0x4E);
+    w.write_int(1);
+    w.write_list_header(0);
+    w.write_map_header(0);
+    w.write_list_header(0);
+    w.write_list_header(2);
+    w.write_int(1);
+    w.write_int(0);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    ASSERT_THROW(r.read_value(), neo4j::exception);
+}
+
+TEST(Path, Owned) {
+    auto v = make_path();
+    auto copy = v.ref().to_owned();
+    v = neo4j::value();
+    neo4j::path_view path(copy.ref());
+    ASSERT_EQ(2u, path.length());
+    ASSERT_EQ(3, path.end_node().node_id());
+    auto step = path[1];
+    ASSERT_EQ(2, step.node.node_id());
+    ASSERT_EQ(11, step.relationship.relationship_id());
+    ASSERT_FALSE(step.forward);
+    ASSERT_EQ(3, step.relationship.relationship_start_node_id());
+    ASSERT_EQ(neo4j::string_ref("LIKES"), step.relationship.relationship_type_ref());
+}
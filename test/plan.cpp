@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/plan.h>
+#include <string>
+
+using namespace std::string_literals;
+
+static neo4j::plan_step make_step(const std::string& op, double estimated, unsigned long long hits) {
+    neo4j::plan_step step{};
+    step.operator_type = op;
+    step.estimated_rows = estimated;
+    step.db_hits = hits;
+    return step;
+}
+
+TEST(Plan, CostliestOperators) {
+    neo4j::statement_plan plan{};
+    plan.is_profile = true;
+    plan.output_step = make_step("ProduceResults", 10, 0);
+    auto expand = make_step("Expand(All)", 100, 500);
+    expand.sources.push_back(make_step("NodeByLabelScan", 1000, 1001));
+    plan.output_step.sources.push_back(expand);
+
+    auto top = neo4j::costliest_operators(plan, 2);
+    ASSERT_EQ(2, top.size());
+    ASSERT_EQ("NodeByLabelScan"s, top[0]->operator_type);
+    ASSERT_EQ("Expand(All)"s, top[1]->operator_type);
+
+    plan.is_profile = false;
+    plan.output_step.sources[0].sources[0].estimated_rows = 1;
+    top = neo4j::costliest_operators(plan, 10);
+    ASSERT_EQ(3, top.size());
+    ASSERT_EQ("Expand(All)"s, top[0]->operator_type);
+}
+
+TEST(Plan, ToString) {
+    neo4j::statement_plan plan{};
+    plan.planner = "COST";
+    plan.output_step = make_step("ProduceResults", 1, 0);
+    auto str = neo4j::to_string(plan);
+    ASSERT_NE(std::string::npos, str.find("ProduceResults"));
+}
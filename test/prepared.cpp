@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/prepared.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/stub_server.h>
+#include <atomic>
+
+TEST(Prepared, Unprepared) {
+    neo4j::prepared_statement stmt("MATCH (p:Person) RETURN p.name AS name, p.age AS age");
+    ASSERT_FALSE(stmt.is_prepared());
+    ASSERT_FALSE(stmt.has_type());
+    ASSERT_TRUE(stmt.fieldnames().empty());
+    ASSERT_THROW(stmt.column("name"), neo4j::exception);
+    ASSERT_THROW(stmt.type(), neo4j::exception);
+    ASSERT_EQ("MATCH (p:Person) RETURN p.name AS name, p.age AS age", stmt.get_query());
+}
+
+TEST(Prepared, SchemaCapture) {
+    std::atomic<int> calls{0};
+    neo4j::stub_server server([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        // The third execution returns a different schema
+        res.fields = { "name", ++calls < 3 ? "age" : "born" };
+        res.records.push_back({ neo4j::value(std::string("a")), neo4j::value(1ll) });
+        return res;
+    });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    neo4j::prepared_statement stmt("MATCH (p:Person) RETURN p.name AS name, p.age AS age");
+    auto first = stmt.run(*con);
+    ASSERT_TRUE(stmt.is_prepared());
+    ASSERT_EQ((std::vector<std::string>{ "name", "age" }), stmt.fieldnames());
+    ASSERT_EQ(1u, stmt.column("age"));
+    while(first->fetch_next()) {}
+    auto second = stmt.run(*con);
+    while(second->fetch_next()) {}
+    ASSERT_THROW(stmt.run(*con), neo4j::exception);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/query.h>
+#include <neo4j-cpp/stub_server.h>
+
+namespace {
+    constexpr auto find_person = neo4j::make_query(
+        "MATCH (p:Person) WHERE p.age > $age AND p.name STARTS WITH $prefix RETURN p.name AS name, '$literal' AS tag",
+        neo4j::param<long long>("age"), neo4j::param<std::string>("prefix"));
+
+    static_assert(find_person.size() == 2, "two slots");
+    static_assert(neo4j::param_accepts<long long, int>::value, "ints widen");
+    static_assert(!neo4j::param_accepts<long long, double>::value, "no narrowing");
+    static_assert(!neo4j::param_accepts<long long, bool>::value, "bools are not numbers");
+    static_assert(!neo4j::param_accepts<long long, unsigned long long>::value, "no sign change");
+    static_assert(neo4j::param_accepts<std::string, const char(&)[4]>::value, "literals bind to strings");
+    static_assert(!neo4j::param_accepts<std::string, long long>::value, "numbers are not strings");
+    static_assert(neo4j::query_scanner::uses("RETURN $id", "id"), "used");
+    static_assert(!neo4j::query_scanner::uses("RETURN $identity", "id"), "whole names only");
+    static_assert(!neo4j::query_scanner::uses("RETURN '$id'", "id"), "literals are skipped");
+}
+
+TEST(Query, Bind) {
+    auto params = find_person.bind(30, "A");
+    ASSERT_TRUE(params.is_map());
+    ASSERT_EQ(30, params.map_entry("age").to_int());
+    ASSERT_EQ("A", params.map_entry("prefix").to_string());
+    ASSERT_STREQ("age", find_person.name(0));
+
+    auto ids = neo4j::make_query("MATCH (n) WHERE id(n) IN $ids RETURN n", neo4j::param<std::vector<long long>>("ids"));
+    auto list = ids.bind(std::vector<long long>{ 1, 2, 3 });
+    ASSERT_EQ(3u, list.map_entry("ids").list_size());
+}
+
+TEST(Query, Validation) {
+    // Evaluated at run time these throw, declared constexpr they fail to compile
+    ASSERT_THROW(neo4j::make_query("RETURN $a", neo4j::param<long long>("b")), neo4j::exception);
+    ASSERT_THROW(neo4j::make_query("RETURN $a, $b", neo4j::param<long long>("a")), neo4j::exception);
+    ASSERT_THROW(neo4j::make_query("RETURN $a", neo4j::param<long long>("a"), neo4j::param<double>("a")), neo4j::exception);
+    ASSERT_NO_THROW(neo4j::make_query("RETURN 1 // $comment"));
+}
+
+TEST(Query, Run) {
+    neo4j::stub_server server([](const std::string& query, const neo4j::value& params) {
+        neo4j::stub_server::response res;
+        res.fields = { "name" };
+        res.records.push_back({ neo4j::value(query == find_person.text() ? params.map_entry("prefix").to_string() : std::string()) });
+        return res;
+    });
+    auto con = std::make_shared<neo4j::connection>(server.uri());
+    auto stream = find_person.run(*con, 40, std::string("Bo"));
+    auto row = stream->fetch_next();
+    ASSERT_TRUE(row);
+    ASSERT_EQ("Bo", row.field_ref(0).to_string());
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <neo4j-client.h>
+#include <neo4j-cpp/replay.h>
+#include <neo4j-cpp/packstream.h>
+#include <cstdio>
+#include <string>
+
+namespace {
+    // In memory server: reads return the scripted bytes, writes are dropped
+    struct scripted_stream {
+        struct neo4j_iostream base;
+        std::string data;
+        size_t pos = 0;
+    };
+
+    ssize_t scripted_read(struct neo4j_iostream* self, void* buf, size_t nbyte) {
+        auto s = reinterpret_cast<scripted_stream*>(self);
+        // Deliver at most 3 bytes per read to get several recorded chunks
+        size_t n = std::min<size_t>(std::min<size_t>(nbyte, 3), s->data.size() - s->pos);
+        memcpy(buf, s->data.data() + s->pos, n);
+        s->pos += n;
+        return n;
+    }
+    ssize_t scripted_readv(struct neo4j_iostream*, const struct iovec*, unsigned int) { return -1; }
+    ssize_t scripted_write(struct neo4j_iostream*, const void*, size_t nbyte) { return nbyte; }
+    ssize_t scripted_writev(struct neo4j_iostream*, const struct iovec*, unsigned int) { return -1; }
+    int scripted_flush(struct neo4j_iostream*) { return 0; }
+    int scripted_close(struct neo4j_iostream* self) { delete reinterpret_cast<scripted_stream*>(self); return 0; }
+
+    struct neo4j_iostream* scripted_connect(struct neo4j_connection_factory*, const char*, unsigned int,
+        neo4j_config_t*, uint_fast32_t, struct neo4j_logger*) {
+        auto s = new scripted_stream();
+        s->base = { scripted_read, scripted_readv, scripted_write, scripted_writev, scripted_flush, scripted_close };
+        s->data = std::string("\x00\x00\x00\x01", 4) + "server bytes";
+        return &s->base;
+    }
+
+    std::string read_all(struct neo4j_iostream* ios) {
+        std::string res;
+        char buf[5];
+        ssize_t n;
+        while((n = ios->read(ios, buf, sizeof(buf))) > 0) res.append(buf, n);
+        return res;
+    }
+}
+
+TEST(Replay, RecordAndReplay) {
+    std::string file = testing::TempDir() + "neo4jpp_replay_test.rec";
+    struct neo4j_connection_factory scripted = { scripted_connect };
+    {
+        neo4j::recording_connection_factory rec(file, &scripted);
+        auto ios = rec.get()->tcp_connect(rec.get(), "localhost", 7687, nullptr, 0, nullptr);
+        ASSERT_NE(nullptr, ios);
+        const uint8_t hello[20] = { 0x60, 0x60, 0xB0, 0x17, 0, 0, 0, 1 };
+        ASSERT_EQ(20, ios->write(ios, hello, sizeof(hello)));
+        neo4j::packstream_writer w;
+        w.write_struct_header(2, 0x10);
+        w.write_string("RETURN $x");
+        w.write_map_header(1);
+        w.write_string("x");
+        w.write_int(42);
+        uint8_t len[2] = { 0, static_cast<uint8_t>(w.data().size()) };
+        ios->write(ios, len, 2);
+        ios->write(ios, w.data().data(), w.data().size());
+        ios->write(ios, "\0\0", 2);
+        ASSERT_EQ(std::string("\x00\x00\x00\x01", 4) + "server bytes", read_all(ios));
+        ios->close(ios);
+        ASSERT_EQ(1, rec.sessions());
+        ASSERT_EQ(16, rec.bytes_received());
+    }
+
+    neo4j::replay_connection_factory replay(file);
+    ASSERT_EQ(1, replay.sessions());
+    ASSERT_EQ(16, replay.recorded_bytes());
+    auto stmts = replay.statements(0);
+    ASSERT_EQ(1, stmts.size());
+    ASSERT_EQ("RETURN $x", stmts[0].query);
+    ASSERT_EQ(42, stmts[0].params.map_entry("x").to_int());
+
+    for(int i = 0; i < 2; i++) {
+        auto ios = replay.get()->tcp_connect(replay.get(), "ignored", 1, nullptr, 0, nullptr);
+        ASSERT_NE(nullptr, ios);
+        ASSERT_EQ(std::string("\x00\x00\x00\x01", 4) + "server bytes", read_all(ios));
+        ios->close(ios);
+        // Only one session was recorded
+        ASSERT_EQ(nullptr, replay.get()->tcp_connect(replay.get(), "ignored", 1, nullptr, 0, nullptr));
+        replay.rewind();
+    }
+    ASSERT_EQ(32, replay.bytes_replayed());
+    std::remove(file.c_str());
+}
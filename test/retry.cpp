@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <neo4j-client.h>
+#include <neo4j-cpp/retry.h>
+#include <neo4j-cpp/pool.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/routing.h>
+#include <neo4j-cpp/stub_server.h>
+#include <atomic>
+#include <thread>
+
+namespace {
+    neo4j::value routing_table(const std::string& writer, const std::string& router) {
+        std::vector<neo4j::value> servers;
+        servers.emplace_back(std::map<std::string, neo4j::value>{
+            { "role", neo4j::value(std::string("WRITE")) },
+            { "addresses", neo4j::value(std::vector<neo4j::value>{ neo4j::value(writer) }) } });
+        servers.emplace_back(std::map<std::string, neo4j::value>{
+            { "role", neo4j::value(std::string("ROUTE")) },
+            { "addresses", neo4j::value(std::vector<neo4j::value>{ neo4j::value(router) }) } });
+        return neo4j::value(servers);
+    }
+}
+
+TEST(Retry, Classify) {
+    using neo4j::failure_class;
+    ASSERT_EQ(failure_class::transient, neo4j::classify_failure("Neo.TransientError.Transaction.DeadlockDetected"));
+    ASSERT_EQ(failure_class::reroute, neo4j::classify_failure("Neo.ClientError.Cluster.NotALeader"));
+    ASSERT_EQ(failure_class::permanent, neo4j::classify_failure("Neo.TransientError.Transaction.Terminated"));
+    ASSERT_EQ(failure_class::permanent, neo4j::classify_failure("Neo.ClientError.Statement.SyntaxError"));
+    ASSERT_EQ(failure_class::none, neo4j::classify_failure(neo4j::error()));
+    ASSERT_EQ(failure_class::connection, neo4j::classify_failure(neo4j::error(neo4j::make_client_error(NEO4J_CONNECTION_CLOSED))));
+    // A statement deadline is the caller's limit
+    ASSERT_EQ(failure_class::permanent, neo4j::classify_failure(neo4j::error(std::make_error_code(std::errc::timed_out))));
+
+    neo4j::failure_details details{};
+    details.code = "Neo.TransientError.General.DatabaseUnavailable";
+    neo4j::error transient(neo4j::make_client_error(NEO4J_STATEMENT_EVALUATION_FAILED), details);
+    ASSERT_EQ(failure_class::transient, neo4j::classify_failure(transient));
+
+    neo4j::retry_policy policy;
+    ASSERT_TRUE(policy.is_retryable(transient, neo4j::idempotency::read_only));
+    ASSERT_TRUE(policy.is_retryable(transient, neo4j::idempotency::idempotent));
+    ASSERT_FALSE(policy.is_retryable(transient, neo4j::idempotency::non_idempotent));
+
+    // Only worth retrying where the next attempt can go to another member
+    details.code = "Neo.ClientError.Cluster.NotALeader";
+    neo4j::error follower(neo4j::make_client_error(NEO4J_STATEMENT_EVALUATION_FAILED), details);
+    ASSERT_FALSE(policy.is_retryable(follower, neo4j::idempotency::idempotent));
+    ASSERT_TRUE(policy.is_retryable(follower, neo4j::idempotency::idempotent, true));
+    ASSERT_EQ(neo4j::idempotency::read_only, neo4j::idempotency_for(neo4j::statement_type::read_only));
+    ASSERT_EQ(neo4j::idempotency::non_idempotent, neo4j::idempotency_for(neo4j::statement_type::read_write));
+}
+
+TEST(Retry, Backoff) {
+    neo4j::retry_options opts;
+    opts.initial_backoff = std::chrono::milliseconds(100);
+    opts.max_backoff = std::chrono::milliseconds(1000);
+    opts.jitter = 0.5;
+    neo4j::retry_policy policy(opts);
+    for(int i = 0; i < 100; i++) {
+        auto first = policy.backoff(0).count();
+        ASSERT_GE(first, 50);
+        ASSERT_LE(first, 150);
+        auto capped = policy.backoff(10).count();
+        ASSERT_GE(capped, 500);
+        ASSERT_LE(capped, 1500);
+    }
+}
+
+TEST(Retry, Exhausted) {
+    neo4j::retry_options opts;
+    opts.max_attempts = 3;
+    opts.initial_backoff = std::chrono::milliseconds(1);
+    neo4j::retry_policy policy(opts);
+    // Nothing listens there, every attempt fails to connect
+    neo4j::connection_pool pool("neo4j://127.0.0.1:1", neo4j::connect_flags::insecure);
+    int calls = 0;
+    auto err = policy.execute(pool, neo4j::idempotency::read_only, [&](neo4j::connection&) { calls++; return neo4j::error(); });
+    ASSERT_TRUE(err);
+    ASSERT_EQ(neo4j::failure_class::connection, neo4j::classify_failure(err));
+    ASSERT_EQ(0, calls);
+    auto st = policy.stats();
+    ASSERT_EQ(1u, st.operations);
+    ASSERT_EQ(3u, st.attempts);
+    ASSERT_EQ(2u, st.retries);
+    ASSERT_EQ(1u, st.exhausted);
+
+    // Writes are not repeated
+    err = policy.execute(pool, neo4j::idempotency::non_idempotent, [&](neo4j::connection&) { return neo4j::error(); });
+    ASSERT_TRUE(err);
+    st = policy.stats();
+    ASSERT_EQ(4u, st.attempts);
+    ASSERT_EQ(1u, st.unsafe);
+}
+
+TEST(Retry, Failover) {
+    std::atomic<int> runs{0};
+    neo4j::stub_server server([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        if(runs++ < 2) {
+            res.failure_code = "Neo.TransientError.General.DatabaseUnavailable";
+            res.failure_message = "database is starting";
+            return res;
+        }
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(42ll) });
+        return res;
+    });
+    neo4j::retry_options opts;
+    opts.initial_backoff = std::chrono::milliseconds(1);
+    neo4j::retry_policy policy(opts);
+    neo4j::connection_pool pool(server.uri());
+    auto stream = policy.run(pool, "RETURN 42 AS n", neo4j::value(), neo4j::idempotency::read_only);
+    auto row = stream->fetch_next();
+    ASSERT_TRUE(row);
+    ASSERT_EQ(42, row.field(0).to_int());
+    auto st = policy.stats();
+    ASSERT_EQ(3u, st.attempts);
+    ASSERT_EQ(1u, st.recovered);
+}
+
+TEST(Retry, NotALeaderOnPool) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.failure_code = "Neo.ClientError.Cluster.NotALeader";
+        res.failure_message = "not the leader";
+        return res;
+    });
+    neo4j::retry_options opts;
+    opts.initial_backoff = std::chrono::milliseconds(1);
+    neo4j::retry_policy policy(opts);
+    neo4j::connection_pool pool(server.uri());
+    // The same follower would refuse every retry
+    auto res = policy.run_nothrow(pool, "CREATE (n)", neo4j::value(), neo4j::idempotency::idempotent);
+    ASSERT_FALSE(res);
+    ASSERT_EQ(neo4j::failure_class::reroute, neo4j::classify_failure(res.get_error()));
+    ASSERT_EQ(1, server.statements());
+    ASSERT_EQ(1u, policy.stats().attempts);
+}
+
+TEST(Retry, RoutedFailover) {
+    neo4j::stub_server follower([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.failure_code = "Neo.ClientError.Cluster.NotALeader";
+        res.failure_message = "not the leader";
+        return res;
+    });
+    neo4j::stub_server leader([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.type = "w";
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(42ll) });
+        return res;
+    });
+    std::atomic<int> tables{0};
+    neo4j::stub_server router([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        // The first table still names the old leader
+        auto writer = tables++ == 0 ? follower.address() : leader.address();
+        res.fields = { "ttl", "servers" };
+        res.records.push_back({ neo4j::value(300ll), routing_table(writer, router.address()) });
+        return res;
+    });
+    neo4j::retry_options opts;
+    opts.initial_backoff = std::chrono::milliseconds(1);
+    neo4j::retry_policy policy(opts);
+    neo4j::routing_client client({ router.address() });
+    auto stream = policy.run(client, "MERGE (n:Counter) RETURN 42 AS n", neo4j::value(), neo4j::idempotency::idempotent);
+    auto row = stream->fetch_next();
+    ASSERT_TRUE(row);
+    ASSERT_EQ(42, row.field(0).to_int());
+    ASSERT_EQ(1, follower.statements());
+    ASSERT_EQ(2, tables.load());
+    auto st = policy.stats();
+    ASSERT_EQ(2u, st.attempts);
+    ASSERT_EQ(1u, st.reroutes);
+    ASSERT_EQ(leader.address(), client.get_writers().at(0).address);
+}
+
+TEST(Retry, DeadlineOnlyWhileStarting) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(1ll) });
+        res.records.push_back({ neo4j::value(2ll) });
+        return res;
+    });
+    neo4j::retry_options opts;
+    opts.deadline = std::chrono::milliseconds(100);
+    neo4j::retry_policy policy(opts);
+    neo4j::connection_pool pool(server.uri());
+    auto stream = policy.run(pool, "UNWIND [1, 2] AS n RETURN n", neo4j::value(), neo4j::idempotency::read_only);
+    // Reading past the budget must not reset the connection
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(stream->fetch_next());
+    ASSERT_TRUE(stream->fetch_next());
+    ASSERT_FALSE(stream->fetch_next());
+    ASSERT_FALSE(stream->is_timed_out());
+}
+
+TEST(Retry, ReconnectKeepsUri) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        return neo4j::stub_server::response();
+    });
+    // Replacing a broken connection must not drop the credentials in the uri
+    auto con = std::make_shared<neo4j::connection>("neo4j://alice:secret@" + server.address(), neo4j::connect_flags::insecure);
+    auto fresh = con->reconnect();
+    ASSERT_NE(con, fresh);
+    ASSERT_EQ("alice", fresh->get_username());
+    ASSERT_EQ(server.port(), fresh->get_port());
+    ASSERT_FALSE(fresh->is_secure());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/routing.h>
+#include <neo4j-cpp/stub_server.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result.h>
+#include <neo4j-cpp/value.h>
+#include <atomic>
+
+namespace {
+    neo4j::value routing_servers(const std::string& writer, const std::vector<std::string>& readers) {
+        std::vector<neo4j::value> read_addresses;
+        for(auto& r : readers) read_addresses.emplace_back(r);
+        std::vector<neo4j::value> servers;
+        servers.emplace_back(std::map<std::string, neo4j::value>{
+            { "role", neo4j::value(std::string("WRITE")) },
+            { "addresses", neo4j::value(std::vector<neo4j::value>{ neo4j::value(writer) }) } });
+        servers.emplace_back(std::map<std::string, neo4j::value>{
+            { "role", neo4j::value(std::string("READ")) },
+            { "addresses", neo4j::value(read_addresses) } });
+        servers.emplace_back(std::map<std::string, neo4j::value>{
+            { "role", neo4j::value(std::string("ROUTE")) },
+            { "addresses", neo4j::value(std::vector<neo4j::value>{ neo4j::value(writer) }) } });
+        return neo4j::value(servers);
+    }
+}
+
+TEST(Routing, AccessMode) {
+    ASSERT_EQ(neo4j::access_mode::read, neo4j::access_mode_for(neo4j::statement_type::read_only));
+    ASSERT_EQ(neo4j::access_mode::write, neo4j::access_mode_for(neo4j::statement_type::read_write));
+    ASSERT_EQ(neo4j::access_mode::write, neo4j::access_mode_for(neo4j::statement_type::schema_update));
+}
+
+TEST(Routing, ReadsBalancedWritesToLeader) {
+    auto answer = [](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records = { { neo4j::value(1ll) } };
+        return res;
+    };
+    neo4j::stub_server reader1(answer), reader2(answer);
+    std::string routing_query;
+    neo4j::stub_server leader([&](const std::string& query, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        if(query.find("getRoutingTable") != std::string::npos) {
+            routing_query = query;
+            res.fields = { "ttl", "servers" };
+            res.records = { { neo4j::value(300ll), routing_servers(leader.address(), { reader1.address(), reader2.address() }) } };
+        } else {
+            res.type = "w";
+        }
+        return res;
+    });
+
+    neo4j::routing_client client({ leader.address() });
+    client.refresh();
+    ASSERT_EQ(2, client.get_readers().size());
+    ASSERT_EQ(leader.address(), client.get_writers().at(0).address);
+
+    // Holding on to the connections keeps the readers busy, so they alternate
+    std::vector<std::shared_ptr<neo4j::connection>> held;
+    for(int i = 0; i < 4; i++) {
+        held.push_back(client.acquire(neo4j::access_mode::read));
+        held.back()->run("RETURN 1")->fetch_next();
+    }
+    ASSERT_EQ(2, reader1.statements());
+    ASSERT_EQ(2, reader2.statements());
+
+    auto before = leader.statements();
+    client.run("CREATE (n)", neo4j::access_mode::write)->fetch_next();
+    ASSERT_EQ(before + 1, leader.statements());
+}
+
+TEST(Routing, FailedReaderMarkedDown) {
+    auto answer = [](const std::string&, const neo4j::value&) { return neo4j::stub_server::response{}; };
+    neo4j::stub_server reader(answer);
+    std::string gone;
+    {
+        neo4j::stub_server dead(answer);
+        gone = dead.address();
+    }
+    neo4j::stub_server leader([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "ttl", "servers" };
+        res.records = { { neo4j::value(300ll), routing_servers(leader.address(), { gone, reader.address() }) } };
+        return res;
+    });
+
+    neo4j::routing_options opts;
+    opts.min_backoff = std::chrono::milliseconds(60000);
+    neo4j::routing_client client({ leader.address() }, opts);
+    for(int i = 0; i < 3; i++) client.run("RETURN 1", neo4j::access_mode::read);
+    ASSERT_EQ(3, reader.statements());
+    for(auto& r : client.get_readers()) {
+        ASSERT_EQ(r.address == gone, r.down);
+    }
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/slow_query_log.h>
+#include <string>
+#include <fstream>
+#include <cstdio>
+
+using namespace std::string_literals;
+
+TEST(SlowQueryLog, Fingerprint) {
+    ASSERT_EQ("MATCH (n {name: ?}) WHERE n.age > ? RETURN n LIMIT ?"s,
+        neo4j::fingerprint("MATCH (n {name: 'Tom \\'T\\''})\n  WHERE n.age > 42.5   RETURN n LIMIT 10"));
+    ASSERT_EQ("MATCH (n:Label2) WHERE n.x = ? AND n.y = $p1 RETURN `a 1`"s,
+        neo4j::fingerprint("MATCH (n:Label2) WHERE n.x = -3 AND n.y = $p1 RETURN `a 1`"));
+    ASSERT_EQ(neo4j::fingerprint("RETURN \"a\""), neo4j::fingerprint("RETURN   'b'"));
+    ASSERT_EQ("RETURN ? + ?"s, neo4j::fingerprint("RETURN 1e-5 + 2.5E+10"));
+    ASSERT_EQ(neo4j::fingerprint("RETURN 1e-5"), neo4j::fingerprint("RETURN 3"));
+    ASSERT_EQ("RETURN ?-n"s, neo4j::fingerprint("RETURN 0x1E-n"));
+}
+
+TEST(SlowQueryLog, Ring) {
+    neo4j::slow_query_options opts;
+    opts.capacity = 2;
+    neo4j::slow_query_log log(opts);
+    for(int i = 0; i < 3; i++) {
+        log.submit("RETURN " + std::to_string(i), std::chrono::system_clock::now(),
+            std::chrono::milliseconds(1), std::chrono::milliseconds(2), 1);
+        log.flush();
+    }
+    auto entries = log.entries();
+    ASSERT_EQ(2, entries.size());
+    ASSERT_EQ("RETURN 2"s, entries[1].query);
+    ASSERT_EQ("RETURN ?"s, entries[1].fingerprint);
+    ASSERT_FALSE(entries[1].has_plan);
+}
+
+TEST(SlowQueryLog, File) {
+    neo4j::slow_query_options opts;
+    opts.file = testing::TempDir() + "neo4jpp_slow_query.log";
+    remove(opts.file.c_str());
+    {
+        neo4j::slow_query_log log(opts);
+        for(int i = 0; i < 3; i++) {
+            log.submit("RETURN " + std::to_string(i), std::chrono::system_clock::now(),
+                std::chrono::milliseconds(1), std::chrono::milliseconds(2), 1);
+        }
+        log.flush();
+        // Flushed entries are readable while the log keeps the file open
+        std::ifstream in(opts.file);
+        std::string line;
+        int lines = 0;
+        while(std::getline(in, line)) {
+            ASSERT_NE(std::string::npos, line.find("\tRETURN ?"));
+            lines++;
+        }
+        ASSERT_EQ(3, lines);
+    }
+    remove(opts.file.c_str());
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/snapshot.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/stub_server.h>
+#include <neo4j-cpp/exception.h>
+#include <neo4j-cpp/path.h>
+#include <cstdio>
+
+TEST(Snapshot, Value) {
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x4E);
+    w.write_int(7);
+    w.write_list_header(2);
+    w.write_string("Person");
+    w.write_string("Admin");
+    w.write_map_header(2);
+    w.write_string("name");
+    w.write_string("alice");
+    w.write_string("tags");
+    w.write_list_header(3);
+    w.write_int(1);
+    w.write_float(2.5);
+    w.write_null();
+    auto& buf = w.data();
+    neo4j::snapshot_value node(buf.data(), buf.data() + buf.size());
+    ASSERT_TRUE(node.is_node());
+    ASSERT_EQ(7, node.node_id());
+    ASSERT_EQ(2u, node.node_label_count());
+    ASSERT_EQ(neo4j::string_ref("Admin"), node.node_label(1));
+    ASSERT_TRUE(node.node_has_label("Person"));
+    ASSERT_FALSE(node.node_has_label("Robot"));
+    auto props = node.node_properties_ref();
+    ASSERT_EQ(2u, props.map_size());
+    ASSERT_EQ(neo4j::string_ref("tags"), props.map_key(1));
+    ASSERT_EQ(neo4j::string_ref("alice"), props.map_entry("name").to_string_ref());
+    ASSERT_TRUE(props.map_entry("missing").is_null());
+    auto tags = props.map_value(1);
+    ASSERT_EQ(3u, tags.list_size());
+    ASSERT_EQ(2.5, tags.list_entry(1).to_float());
+    ASSERT_TRUE(tags.list_entry(2).is_null());
+    ASSERT_THROW(tags.list_entry(3), neo4j::exception);
+    std::vector<std::string> keys;
+    for(auto it = props.begin(); it != props.end(); ++it) keys.push_back(it.key().str());
+    ASSERT_EQ((std::vector<std::string>{ "name", "tags" }), keys);
+    ASSERT_EQ(neo4j::string_ref("alice"), props.begin()->to_string_ref());
+    std::vector<bool> nulls;
+    for(auto& tag : tags) nulls.push_back(tag.is_null());
+    ASSERT_EQ((std::vector<bool>{ false, false, true }), nulls);
+    ASSERT_THROW(node.begin(), neo4j::exception);
+    ASSERT_THROW(node.relationship_id(), neo4j::exception);
+    ASSERT_THROW(tags.to_int(), neo4j::exception);
+    // Views point into the encoded bytes
+    ASSERT_EQ(reinterpret_cast<const char*>(buf.data()), node.raw().data());
+
+    auto owned = node.to_owned();
+    ASSERT_TRUE(owned.is_node());
+    ASSERT_EQ(7, owned.node_id());
+}
+
+TEST(Snapshot, Path) {
+    // (1)-[10:KNOWS]->(2)<-[11:LIKES]-(3)
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x50);
+    w.write_list_header(3);
+    for(long long id : { 1, 2, 3 }) {
+        w.write_struct_header(3, 0x4E);
+        w.write_int(id);
+        w.write_list_header(0);
+        w.write_map_header(0);
+    }
+    w.write_list_header(2);
+    w.write_struct_header(3, 0x72);
+    w.write_int(10);
+    w.write_string("KNOWS");
+    w.write_map_header(0);
+    w.write_struct_header(3, 0x72);
+    w.write_int(11);
+    w.write_string("LIKES");
+    w.write_map_header(0);
+    w.write_list_header(4);
+    for(long long i : { 1, 1, -2, 2 }) w.write_int(i);
+    auto& buf = w.data();
+    neo4j::snapshot_value snap(buf.data(), buf.data() + buf.size());
+    ASSERT_TRUE(snap.is_path());
+
+    auto owned = snap.to_owned();
+    neo4j::path_view path(owned.ref());
+    ASSERT_EQ(2u, path.length());
+    ASSERT_EQ(1, path.start_node().node_id());
+    ASSERT_EQ(3, path.end_node().node_id());
+    ASSERT_EQ(11, path[1].relationship.relationship_id());
+    ASSERT_FALSE(path[1].forward);
+
+    // Encoded again it matches the stored bytes
+    neo4j::packstream_writer again;
+    again.write(owned.ref());
+    ASSERT_EQ(buf, again.data());
+}
+
+TEST(Snapshot, Empty) {
+    std::string file = testing::TempDir() + "neo4jpp_snapshot_empty.snap";
+    {
+        neo4j::snapshot_writer writer(file, { "a", "b" });
+        writer.close();
+        ASSERT_EQ(0u, writer.size());
+    }
+    neo4j::snapshot snap(file);
+    ASSERT_EQ(2u, snap.nfields());
+    ASSERT_EQ("b", snap.fieldname(1));
+    ASSERT_EQ(0u, snap.size());
+    neo4j::snapshot_cursor cursor(snap);
+    ASSERT_FALSE(cursor.next());
+    ASSERT_FALSE(cursor.valid());
+    ASSERT_THROW(cursor.field(0), neo4j::exception);
+    remove(file.c_str());
+}
+
+TEST(Snapshot, Invalid) {
+    std::string file = testing::TempDir() + "neo4jpp_snapshot_invalid.snap";
+    ASSERT_THROW(neo4j::snapshot(file + ".missing"), neo4j::exception);
+    FILE* f = fopen(file.c_str(), "wb");
+    ASSERT_NE(nullptr, f);
+    fputs("this is not a snapshot file at all", f);
+    fclose(f);
+    ASSERT_THROW(neo4j::snapshot snap(file), neo4j::exception);
+    remove(file.c_str());
+}
+
+TEST(Snapshot, RoundTrip) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "i", "name" };
+        for(long long i = 0; i < 100; i++) res.records.push_back({ neo4j::value(i), neo4j::value("row " + std::to_string(i)) });
+        return res;
+    });
+    std::string file = testing::TempDir() + "neo4jpp_snapshot_roundtrip.snap";
+    {
+        auto con = std::make_shared<neo4j::connection>(server.uri());
+        auto stream = con->run("UNWIND range(0, 99) AS i RETURN i, 'row ' + i AS name");
+        neo4j::snapshot_writer writer(file, *stream);
+        ASSERT_EQ(100u, writer.write_all(*stream));
+        writer.close();
+    }
+    neo4j::snapshot snap(file);
+    ASSERT_EQ(2u, snap.nfields());
+    ASSERT_EQ("name", snap.fieldname(1));
+    ASSERT_EQ(100u, snap.size());
+    neo4j::snapshot_cursor cursor(snap);
+    long long expected = 0;
+    while(cursor.next()) {
+        ASSERT_EQ(expected, cursor.field(0).to_int());
+        ASSERT_EQ("row " + std::to_string(expected), cursor.field(1).to_string());
+        expected++;
+    }
+    ASSERT_EQ(100, expected);
+    cursor.seek(42);
+    ASSERT_TRUE(cursor.next());
+    ASSERT_EQ(43u, cursor.position());
+    auto row = cursor.copy_row();
+    ASSERT_EQ("row 42", row[1].to_string());
+    remove(file.c_str());
+}
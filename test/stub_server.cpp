@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/stub_server.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+TEST(StubServer, Handshake) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) { return neo4j::stub_server::response{}; });
+    ASSERT_NE(0, server.port());
+    ASSERT_EQ("neo4j://127.0.0.1:" + std::to_string(server.port()), server.uri());
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(server.port());
+    ASSERT_EQ(0, ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    const uint8_t hello[20] = { 0x60, 0x60, 0xB0, 0x17, 0, 0, 0, 1 };
+    ASSERT_EQ(20, ::send(fd, hello, sizeof(hello), 0));
+    uint8_t version[4] = { 0xff, 0xff, 0xff, 0xff };
+    ASSERT_EQ(4, ::recv(fd, version, sizeof(version), MSG_WAITALL));
+    ASSERT_EQ(0, version[0] | version[1] | version[2]);
+    ASSERT_EQ(1, version[3]);
+    ::close(fd);
+    server.stop();
+    ASSERT_EQ(1, server.connections());
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <neo4j-client.h>
+#include <neo4j-cpp/transport.h>
+#include <neo4j-cpp/connection.h>
+#include <neo4j-cpp/pool.h>
+#include <neo4j-cpp/result_stream.h>
+#include <neo4j-cpp/exception.h>
+#include <neo4j-cpp/stub_server.h>
+#include <atomic>
+#include <cerrno>
+#include <future>
+#include <thread>
+
+TEST(Transport, InterruptRead) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        return neo4j::stub_server::response();
+    });
+    auto cfg = neo4j_new_config();
+    ASSERT_NE(nullptr, cfg);
+    std::shared_ptr<neo4j::transport_interrupt> handle;
+    struct neo4j_iostream* ios;
+    {
+        neo4j::transport_interrupt::capture capture(handle);
+        auto factory = neo4j::interruptible_tcp_factory();
+        ios = factory->tcp_connect(factory, "127.0.0.1", server.port(), cfg, 0, nullptr);
+    }
+    ASSERT_NE(nullptr, ios);
+    ASSERT_NE(nullptr, handle);
+
+    // The server waits for the handshake, so this read blocks until interrupted
+    auto reader = std::async(std::launch::async, [&](){
+        char buf[4];
+        auto res = ios->read(ios, buf, sizeof(buf));
+        return std::make_pair(res, errno);
+    });
+    ASSERT_EQ(std::future_status::timeout, reader.wait_for(std::chrono::milliseconds(50)));
+    handle->interrupt();
+    ASSERT_EQ(std::future_status::ready, reader.wait_for(std::chrono::seconds(5)));
+    auto res = reader.get();
+    ASSERT_EQ(-1, res.first);
+    ASSERT_EQ(ECANCELED, res.second);
+
+    handle->clear();
+    ASSERT_FALSE(handle->is_interrupted());
+    const char magic[] = { '\x60', '\x60', '\xB0', '\x17' };
+    ASSERT_EQ(4, ios->write(ios, magic, sizeof(magic)));
+    ios->close(ios);
+    neo4j_config_free(cfg);
+}
+
+TEST(Transport, StalledRead) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(1ll) });
+        res.delay = std::chrono::seconds(3);
+        return res;
+    });
+    neo4j::config cfg;
+    cfg.set_interruptible_io(true);
+    auto con = std::make_shared<neo4j::connection>(server.uri(), cfg, neo4j::connect_flags::insecure);
+    auto start = std::chrono::steady_clock::now();
+    auto stream = con->run("RETURN 1", std::chrono::milliseconds(100));
+    ASSERT_THROW(stream->fetch_next(), neo4j::timeout_error);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    ASSERT_TRUE(stream->is_timed_out());
+    ASSERT_TRUE(con->is_aborted());
+}
+
+TEST(Transport, DeadlineEndsWithStatement) {
+    neo4j::stub_server server([](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(1ll) });
+        return res;
+    });
+    auto con = std::make_shared<neo4j::connection>(server.uri(), neo4j::connect_flags::insecure);
+    // Responses arrive in order, completing the later statement completes the earlier one
+    auto sent = con->send("CREATE ()", std::chrono::milliseconds(100));
+    auto stream = con->run("RETURN 1");
+    ASSERT_TRUE(stream->fetch_next());
+    ASSERT_FALSE(stream->fetch_next());
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_FALSE(sent->is_timed_out());
+    ASSERT_TRUE(con->run("RETURN 1")->fetch_next());
+}
+
+TEST(Transport, EarlierDeadlineKept) {
+    std::atomic<int> runs{0};
+    neo4j::stub_server server([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(1ll) });
+        if(runs++ == 0) res.delay = std::chrono::seconds(3);
+        return res;
+    });
+    neo4j::config cfg;
+    cfg.set_interruptible_io(true);
+    auto con = std::make_shared<neo4j::connection>(server.uri(), cfg, neo4j::connect_flags::insecure);
+    auto start = std::chrono::steady_clock::now();
+    // Sending another statement must not drop the deadline of the first
+    auto sent = con->send("CREATE ()", std::chrono::milliseconds(100));
+    auto stream = con->run("RETURN 1");
+    ASSERT_ANY_THROW(stream->fetch_next());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    ASSERT_TRUE(sent->is_timed_out());
+}
+
+TEST(Transport, PoolReplacesAborted) {
+    std::atomic<int> runs{0};
+    neo4j::stub_server server([&](const std::string&, const neo4j::value&) {
+        neo4j::stub_server::response res;
+        res.fields = { "n" };
+        res.records.push_back({ neo4j::value(1ll) });
+        if(runs++ == 0) res.delay = std::chrono::seconds(3);
+        return res;
+    });
+    neo4j::config cfg;
+    cfg.set_interruptible_io(true);
+    neo4j::connection_pool pool(server.uri(), cfg, neo4j::connect_flags::insecure);
+    std::weak_ptr<neo4j::connection> first;
+    {
+        auto con = pool.acquire();
+        first = con;
+        ASSERT_THROW(con->run("RETURN 1", std::chrono::milliseconds(100))->fetch_next(), neo4j::timeout_error);
+        ASSERT_TRUE(con->is_aborted());
+    }
+    auto con = pool.acquire();
+    ASSERT_TRUE(first.expired());
+    ASSERT_EQ(1u, pool.size());
+    ASSERT_TRUE(con->run("RETURN 1")->fetch_next());
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <neo4j-client.h>
+#include <neo4j-cpp/tuning.h>
+#include <neo4j-cpp/config.h>
+#include <cstring>
+
+namespace {
+    // Endless server: every read delivers chunk bytes (at most what was asked for)
+    struct chunked_stream {
+        struct neo4j_iostream base;
+        size_t chunk;
+    };
+
+    size_t next_chunk = 0;
+
+    ssize_t chunked_read(struct neo4j_iostream* self, void* buf, size_t nbyte) {
+        auto n = std::min(nbyte, reinterpret_cast<chunked_stream*>(self)->chunk);
+        memset(buf, 0, n);
+        return n;
+    }
+    ssize_t chunked_readv(struct neo4j_iostream*, const struct iovec*, unsigned int) { return -1; }
+    ssize_t chunked_write(struct neo4j_iostream*, const void*, size_t nbyte) { return nbyte; }
+    ssize_t chunked_writev(struct neo4j_iostream*, const struct iovec*, unsigned int) { return -1; }
+    int chunked_flush(struct neo4j_iostream*) { return 0; }
+    int chunked_close(struct neo4j_iostream* self) { delete reinterpret_cast<chunked_stream*>(self); return 0; }
+
+    struct neo4j_iostream* chunked_connect(struct neo4j_connection_factory*, const char*, unsigned int,
+        neo4j_config_t*, uint_fast32_t, struct neo4j_logger*) {
+        auto s = new chunked_stream();
+        s->base = { chunked_read, chunked_readv, chunked_write, chunked_writev, chunked_flush, chunked_close };
+        s->chunk = next_chunk;
+        return &s->base;
+    }
+
+    // Reads like libneo4j does: up to the current buffer size
+    void read_n(neo4j::buffer_tuner& tuner, struct neo4j_iostream* ios, int n) {
+        std::vector<char> buf;
+        for(int i = 0; i < n; i++) {
+            buf.resize(tuner.rcvbuf_size());
+            ios->read(ios, buf.data(), buf.size());
+        }
+    }
+}
+
+TEST(Tuning, GrowsOnBulkReads) {
+    struct neo4j_connection_factory chunked = { chunked_connect };
+    neo4j::buffer_tuning_options opts;
+    opts.max_size = 64 * 1024;
+    neo4j::buffer_tuner tuner(opts, &chunked);
+    next_chunk = 1024 * 1024;
+    auto ios = tuner.get()->tcp_connect(tuner.get(), "localhost", 7687, nullptr, 0, nullptr);
+    ASSERT_NE(nullptr, ios);
+    read_n(tuner, ios, 64);
+    ASSERT_EQ(8192u, tuner.rcvbuf_size());
+    read_n(tuner, ios, 64 * 8);
+    // Capped at max_size
+    ASSERT_EQ(64u * 1024, tuner.rcvbuf_size());
+    ios->close(ios);
+
+    auto stats = tuner.stats();
+    ASSERT_EQ(1u, stats.connections);
+    ASSERT_EQ(64u * 9, stats.reads);
+    ASSERT_EQ(stats.reads, stats.full_reads);
+    ASSERT_EQ(4u, stats.adjustments);
+}
+
+TEST(Tuning, ShrinksOnSmallReads) {
+    struct neo4j_connection_factory chunked = { chunked_connect };
+    neo4j::buffer_tuning_options opts;
+    opts.initial_rcvbuf = 64 * 1024;
+    neo4j::buffer_tuner tuner(opts, &chunked);
+    next_chunk = 100;
+    auto ios = tuner.get()->tcp_connect(tuner.get(), "localhost", 7687, nullptr, 0, nullptr);
+    ASSERT_NE(nullptr, ios);
+    read_n(tuner, ios, 64);
+    ASSERT_EQ(32u * 1024, tuner.rcvbuf_size());
+    read_n(tuner, ios, 64 * 10);
+    ASSERT_EQ(opts.min_size, tuner.rcvbuf_size());
+    ios->close(ios);
+}
+
+TEST(Tuning, Apply) {
+    struct neo4j_connection_factory chunked = { chunked_connect };
+    neo4j::buffer_tuning_options opts;
+    opts.initial_rcvbuf = 128 * 1024;
+    neo4j::buffer_tuner tuner(opts, &chunked);
+    neo4j::config cfg;
+    tuner.apply(cfg);
+    ASSERT_EQ(128u * 1024, cfg.get_rcvbuf_size());
+    ASSERT_EQ(4096u, cfg.get_sndbuf_size());
+    // Small buffers keep the kernel's autotuning
+    ASSERT_EQ(512u * 1024, cfg.get_so_rcvbuf_size());
+    ASSERT_EQ(0u, cfg.get_so_sndbuf_size());
+}
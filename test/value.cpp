@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/value.h>
+#include <neo4j-cpp/exception.h>
+#include <neo4j-cpp/packstream.h>
+#include <string>
+
+using namespace std::string_literals;
+
+TEST(Value, Scalars) {
+    ASSERT_TRUE(neo4j::value().is_null());
+    ASSERT_EQ(true, neo4j::value(true).to_bool());
+    ASSERT_EQ(42, neo4j::value(42ll).to_int());
+    ASSERT_EQ(1.5, neo4j::value(1.5).to_float());
+    ASSERT_EQ("Hello"s, neo4j::value("Hello"s).to_string());
+    ASSERT_THROW(neo4j::value(42ll).to_string(), neo4j::exception);
+}
+
+TEST(Value, ListBuilder) {
+    neo4j::list_builder builder(3);
+    builder.push_back(neo4j::value(1ll)).push_back(neo4j::value(2ll)).push_back(neo4j::value("three"s));
+    auto list = builder.build();
+    ASSERT_TRUE(builder.empty());
+    ASSERT_TRUE(list.is_list());
+    ASSERT_EQ(3, list.list_size());
+
+    auto copy = list;
+    ASSERT_EQ(3, copy.list_size());
+    ASSERT_EQ(2, copy.list_entry(1).to_int());
+    ASSERT_EQ("three"s, copy.list_entry(2).to_string());
+}
+
+TEST(Value, MapBuilder) {
+    neo4j::map_builder builder;
+    builder.set("a", neo4j::value(1ll)).set("b", neo4j::value("b"s));
+    auto map = builder.build();
+    ASSERT_TRUE(map.is_map());
+    ASSERT_EQ(std::set<std::string>({"a", "b"}), map.map_keys());
+
+    neo4j::value copy;
+    copy = map;
+    ASSERT_EQ(std::set<std::string>({"a", "b"}), copy.map_keys());
+}
+
+TEST(Value, MovedFrom) {
+    neo4j::value list(std::vector<neo4j::value>{ neo4j::value(1ll) });
+    auto moved = std::move(list);
+    ASSERT_TRUE(moved.is_list());
+    ASSERT_TRUE(list.is_null());
+    neo4j::value copy(list);
+    ASSERT_TRUE(copy.is_null());
+    copy = moved;
+    moved = std::move(copy);
+    ASSERT_TRUE(copy.is_null());
+    copy = moved;
+    ASSERT_EQ(1, copy.list_entry(0).to_int());
+    // Reusing a moved-from slot
+    list = neo4j::value(2ll);
+    ASSERT_EQ(2, list.to_int());
+}
+
+TEST(Value, ChildOutlivesParent) {
+    neo4j::value entry, nested;
+    {
+        auto inner = neo4j::list_builder().push_back(neo4j::value("deep"s)).build();
+        auto list = neo4j::list_builder().push_back(neo4j::value("kept"s)).push_back(inner).build();
+        entry = list.list_entry(0);
+        nested = list.list_entry(1);
+    }
+    ASSERT_EQ("kept"s, entry.to_string());
+    ASSERT_EQ("deep"s, nested.list_entry(0).to_string());
+
+    neo4j::value prop;
+    {
+        std::map<std::string, neo4j::value> m;
+        m["name"] = neo4j::value("alice"s);
+        prop = neo4j::value(m).map_entry("name");
+    }
+    ASSERT_EQ("alice"s, prop.to_string());
+}
+
+TEST(Value, Ref) {
+    auto list = neo4j::list_builder().push_back(neo4j::value(1ll)).push_back(neo4j::value("two"s)).build();
+    auto ref = list.ref();
+    ASSERT_TRUE(ref.is_list());
+    ASSERT_EQ(2, ref.list_size());
+    ASSERT_EQ(1, ref.list_entry(0).to_int());
+    ASSERT_EQ("two"s, ref.list_entry(1).to_string());
+    ASSERT_THROW(ref.list_entry(2), std::out_of_range);
+}
+
+TEST(Value, RefToOwned) {
+    neo4j::value owned;
+    {
+        auto map = neo4j::map_builder().set("key", neo4j::value("value"s)).build();
+        owned = map.ref().map_entry("key").to_owned();
+    }
+    ASSERT_EQ("value"s, owned.to_string());
+
+    auto list = neo4j::list_builder().push_back(neo4j::value(1.5)).build();
+    auto copy = list.ref().to_owned();
+    ASSERT_EQ(1.5, copy.list_entry(0).to_float());
+}
+
+TEST(Value, TryTo) {
+    neo4j::value v(42ll);
+    ASSERT_EQ(42, v.try_to_int().value());
+    ASSERT_FALSE(v.try_to_string());
+    ASSERT_EQ(std::errc::invalid_argument, v.try_to_float().get_error().code());
+
+    auto list = neo4j::list_builder().push_back(v).build();
+    ASSERT_TRUE(list.ref().try_list_entry(0));
+    ASSERT_EQ(std::errc::result_out_of_range, list.ref().try_list_entry(1).get_error().code());
+}
+
+TEST(Value, StringRef) {
+    neo4j::value str(std::string("hello"));
+    auto ref = str.ref().to_string_ref();
+    ASSERT_EQ(5, ref.size());
+    ASSERT_EQ(neo4j::string_ref("hello"), ref);
+    ASSERT_NE(neo4j::string_ref("hell"), ref);
+    ASSERT_LT(neo4j::string_ref("hell"), ref);
+    ASSERT_EQ("hello", ref.str());
+    ASSERT_THROW(neo4j::value(1ll).ref().to_string_ref(), neo4j::exception);
+
+    neo4j::packstream_writer w;
+    w.write_struct_header(3, 0x4E);
+    w.write_int(1);
+    w.write_list_header(2);
+    w.write_string("Person");
+    w.write_string("Admin");
+    w.write_map_header(0);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto node = r.read_value();
+    ASSERT_EQ(2, node.ref().node_label_count());
+    ASSERT_EQ("Admin", node.ref().node_label(1).str());
+    ASSERT_TRUE(node.ref().node_has_label("Person"));
+    ASSERT_FALSE(node.ref().node_has_label("Pers"));
+    ASSERT_THROW(node.ref().node_label(2), neo4j::exception);
+}
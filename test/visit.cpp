@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/visit.h>
+#include <neo4j-cpp/packstream.h>
+#include <string>
+#include <vector>
+
+namespace {
+    // Minimal JSON writer, separators are handled by tracking the first element per level
+    struct json_visitor : neo4j::value_visitor {
+        std::string out;
+        std::vector<bool> first;
+        bool labels_open = false;
+
+        void sep() {
+            if(first.empty()) return;
+            if(!first.back() && out.back() != ':') out += ',';
+            first.back() = false;
+        }
+        void open(char c) { sep(); out += c; first.push_back(true); }
+        void close(char c) { out += c; first.pop_back(); }
+
+        void on_null() { sep(); out += "null"; }
+        void on_bool(bool b) { sep(); out += b ? "true" : "false"; }
+        void on_int(long long i) { sep(); out += std::to_string(i); }
+        void on_string(neo4j::string_ref s) { sep(); out += '"' + s.str() + '"'; }
+        void begin_list(unsigned int) { open('['); }
+        void end_list() { close(']'); }
+        void begin_map(unsigned int) {
+            if(labels_open) out += "],\"properties\":";
+            labels_open = false;
+            open('{');
+        }
+        void on_key(neo4j::string_ref k) { sep(); out += '"' + k.str() + "\":"; }
+        void end_map() { close('}'); }
+        void begin_node(long long id) { open('{'); out += "\"id\":" + std::to_string(id) + ",\"labels\":["; labels_open = true; }
+        void on_label(neo4j::string_ref l) { if(out.back() != '[') out += ','; out += '"' + l.str() + '"'; }
+        void end_node() { close('}'); }
+    };
+}
+
+TEST(Visit, Json) {
+    neo4j::packstream_writer w;
+    w.write_list_header(3);
+    w.write_int(1);
+    w.write_map_header(2);
+    w.write_string("a");
+    w.write_null();
+    w.write_string("b");
+    w.write_list_header(2);
+    w.write_bool(true);
+    w.write_string("x");
+    w.write_struct_header(3, 0x4E);
+    w.write_int(5);
+    w.write_list_header(2);
+    w.write_string("A");
+    w.write_string("B");
+    w.write_map_header(1);
+    w.write_string("p");
+    w.write_int(2);
+    neo4j::packstream_reader r(w.data().data(), w.data().size());
+    auto val = r.read_value();
+
+    json_visitor v;
+    neo4j::visit(val, v);
+    ASSERT_EQ("[1,{\"a\":null,\"b\":[true,\"x\"]},{\"id\":5,\"labels\":[\"A\",\"B\"],\"properties\":{\"p\":2}}]", v.out);
+}
+
+TEST(Visit, Counts) {
+    struct counter : neo4j::value_visitor {
+        int ints = 0, maps = 0, keys = 0;
+        void on_int(long long) { ints++; }
+        void begin_map(unsigned int) { maps++; }
+        void on_key(neo4j::string_ref) { keys++; }
+    } c;
+    neo4j::map_builder m;
+    m.set("x", neo4j::value(1ll));
+    m.set("y", neo4j::value(std::vector<neo4j::value>{ neo4j::value(2ll), neo4j::value(3ll) }));
+    neo4j::visit(m.build(), c);
+    ASSERT_EQ(3, c.ints);
+    ASSERT_EQ(1, c.maps);
+    ASSERT_EQ(2, c.keys);
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include <neo4j-cpp/watchdog.h>
+#include <atomic>
+#include <future>
+
+TEST(Watchdog, Fires) {
+    neo4j::watchdog wd(std::chrono::milliseconds(1), 8);
+    std::promise<void> fired;
+    auto start = neo4j::watchdog::clock::now();
+    wd.schedule(std::chrono::milliseconds(20), [&](){ fired.set_value(); });
+    ASSERT_EQ(std::future_status::ready, fired.get_future().wait_for(std::chrono::seconds(5)));
+    ASSERT_GE(neo4j::watchdog::clock::now() - start, std::chrono::milliseconds(20));
+    ASSERT_EQ(0, wd.pending());
+}
+
+TEST(Watchdog, Cancel) {
+    neo4j::watchdog wd(std::chrono::milliseconds(1), 8);
+    std::atomic<int> count{0};
+    auto id = wd.schedule(std::chrono::milliseconds(30), [&](){ count++; });
+    // Longer than one round of the wheel
+    wd.schedule(std::chrono::milliseconds(40), [&](){ count += 10; });
+    ASSERT_TRUE(wd.cancel(id));
+    ASSERT_EQ(1, wd.pending());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(10, count);
+    ASSERT_FALSE(wd.cancel(id));
+}
@@ -0,0 +1 @@
+#include <neo4j-cpp/impl/impl-all.h>
\ No newline at end of file
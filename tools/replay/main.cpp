@@ -0,0 +1,86 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <neo4j-cpp/neo4j-cpp.h>
+
+namespace {
+    struct counting_visitor : neo4j::value_visitor {
+        unsigned long long values = 0;
+        void on_null() { values++; }
+        void on_bool(bool) { values++; }
+        void on_int(long long) { values++; }
+        void on_float(double) { values++; }
+        void on_string(neo4j::string_ref) { values++; }
+        void on_bytes(neo4j::string_ref) { values++; }
+        void on_identity(long long) { values++; }
+    };
+
+    void usage(const char* name) {
+        std::cerr << name << " <capture> [--paced] [--iterations n]\n"
+            << "Replays a capture made with recording_connection_factory and reports decode throughput.\n";
+    }
+}
+
+int main(int argc, const char** argv) {
+    if(argc < 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    auto mode = neo4j::replay_connection_factory::pacing::full_speed;
+    int iterations = 1;
+    for(int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--paced") mode = neo4j::replay_connection_factory::pacing::recorded;
+        else if(arg == "--iterations" && i + 1 < argc) iterations = std::atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    neo4j::client::init();
+    neo4j::replay_connection_factory replay(argv[1], mode);
+    std::vector<std::vector<neo4j::recorded_statement>> statements;
+    for(size_t s = 0; s < replay.sessions(); s++) statements.push_back(replay.statements(s));
+    // Counts what libneo4j allocates while decoding, it does not use operator new
+    neo4j::memory_account account(neo4j::memory_limits(), nullptr);
+    neo4j::config cfg;
+    cfg.set_connection_factory(replay.get());
+    cfg.set_memory_allocator(account.allocator());
+
+    unsigned long long records = 0, values = 0, nstatements = 0;
+    auto alloc_start = account.usage();
+    auto start = std::chrono::steady_clock::now();
+    for(int it = 0; it < iterations; it++) {
+        replay.rewind();
+        for(auto& session : statements) {
+            // The address is not used, the factory serves the capture
+            auto con = neo4j::client::connect("neo4j://replay:7687", cfg, neo4j::connect_flags::insecure);
+            for(auto& stmt : session) {
+                counting_visitor v;
+                records += con->run(stmt.query, stmt.params)->for_each_event(v);
+                values += v.values;
+                nstatements++;
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto alloc_end = account.usage();
+    auto allocs = alloc_end.allocations - alloc_start.allocations;
+    auto alloc_bytes = alloc_end.allocated_bytes - alloc_start.allocated_bytes;
+
+    std::cout << std::fixed << std::setprecision(2)
+        << "sessions    : " << replay.sessions() << " x " << iterations << "\n"
+        << "statements  : " << nstatements << "\n"
+        << "records     : " << records << "\n"
+        << "values      : " << values << "\n"
+        << "bytes       : " << replay.bytes_replayed() << "\n"
+        << "time        : " << elapsed * 1000 << " ms\n"
+        << "throughput  : " << replay.bytes_replayed() / elapsed / (1024 * 1024) << " MiB/s, "
+            << records / elapsed << " records/s\n"
+        << "allocations : " << allocs << " (" << (records == 0 ? 0.0 : double(allocs) / records) << " per record, "
+            << (records == 0 ? 0.0 : double(alloc_bytes) / records) << " bytes per record)\n";
+    neo4j::client::cleanup();
+}